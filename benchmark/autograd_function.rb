@@ -0,0 +1,70 @@
+# Compares a loss composed of the primitive operations with the same loss
+# defined by an Autograd::Function with a hand-written gradient.
+#
+# Usage: ruby -Ilib benchmark/autograd_function.rb [BATCH_SIZE] [NUM_ITERATIONS]
+#
+# The loss is the numerically stable sigmoid cross entropy
+#
+#     max(x, 0) - x * z + log(1 + exp(-|x|))
+#
+# The number of the recorded nodes and the time of the backward
+# computation are reported.
+
+require 'json'
+require 'mxnet'
+
+BATCH_SIZE = Integer(ARGV[0] || 65_536)
+NUM_ITERATIONS = Integer(ARGV[1] || 100)
+
+ND = MXNet::NDArray
+
+def primitive_loss(x, z)
+  ND.relu(x) - x * z + ND.log1p(ND.exp(-ND.abs(x)))
+end
+
+class SigmoidCrossEntropy < MXNet::Autograd::Function
+  def forward(x, z)
+    save_for_backward(x, z)
+    ND.relu(x) - x * z + ND.log1p(ND.exp(-ND.abs(x)))
+  end
+
+  def backward(dy)
+    x, z = saved_tensors
+    [dy * (ND.sigmoid(x) - z), ND.zeros_like(z)]
+  end
+end
+
+def function_loss(x, z)
+  SigmoidCrossEntropy.new.(x, z)
+end
+
+def count_nodes(y)
+  nodes = JSON.parse(MXNet::Autograd.get_symbol(y).to_json)['nodes']
+  nodes.count {|node| node['op'] != 'null' }
+end
+
+def run(x, z, label)
+  y = MXNet::Autograd.record { yield x, z }
+  num_nodes = count_nodes(y)
+
+  backward_time = 0.0
+  NUM_ITERATIONS.times do
+    y = MXNet::Autograd.record { yield x, z }
+    y.wait_to_read
+    t0 = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+    y.backward
+    x.grad.wait_to_read
+    backward_time += Process.clock_gettime(Process::CLOCK_MONOTONIC) - t0
+  end
+
+  puts format('%-12s %6d nodes %10.1f us/backward', label, num_nodes,
+              backward_time / NUM_ITERATIONS * 1e6)
+end
+
+x = ND::Random.normal(shape: [BATCH_SIZE])
+z = ND.round(ND::Random.uniform(shape: [BATCH_SIZE]))
+x.attach_grad
+z.attach_grad
+
+run(x, z, 'primitive') {|a, b| primitive_loss(a, b) }
+run(x, z, 'function') {|a, b| function_loss(a, b) }
@@ -0,0 +1,23 @@
+# Measures the cost of entering and leaving the autograd scopes.
+#
+# Usage: ruby -Ilib benchmark/autograd_record.rb [NUM_ITERATIONS]
+
+require 'mxnet'
+
+NUM_ITERATIONS = Integer(ARGV[0] || 100_000)
+
+def measure(label)
+  t0 = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+  NUM_ITERATIONS.times { yield }
+  elapsed = Process.clock_gettime(Process::CLOCK_MONOTONIC) - t0
+  puts format('%-24s %8.3f us/scope', label, elapsed / NUM_ITERATIONS * 1e6)
+end
+
+recorder = MXNet::Autograd::Recorder.new
+
+measure('Autograd.record') { MXNet::Autograd.record { } }
+measure('Recorder#record') { recorder.record { } }
+MXNet::Autograd.record do
+  measure('nested Autograd.record') { MXNet::Autograd.record { } }
+end
+measure('Autograd.pause') { MXNet::Autograd.pause { } }
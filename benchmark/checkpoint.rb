@@ -0,0 +1,57 @@
+# Measures the jitter of the training step time caused by checkpointing.
+#
+# Usage: ruby -Ilib benchmark/checkpoint.rb [NUM_PARAMS] [PARAM_SIZE]
+#
+# A fake training step (a few matrix products and in-place updates on
+# every parameter) is repeated, and a checkpoint is saved every
+# `SAVE_INTERVAL` steps, either synchronously or asynchronously.
+
+require 'mxnet'
+require 'tmpdir'
+
+NUM_PARAMS = Integer(ARGV[0] || 16)
+PARAM_SIZE = Integer(ARGV[1] || 512)
+NUM_STEPS = 200
+SAVE_INTERVAL = 20
+
+def percentile(sorted, q)
+  sorted[((sorted.length - 1) * q).round]
+end
+
+def run(async, dir)
+  params = {}
+  NUM_PARAMS.times do |i|
+    params["w#{i}"] = MXNet::NDArray::Random.normal(shape: [PARAM_SIZE, PARAM_SIZE])
+  end
+  x = MXNet::NDArray::Random.normal(shape: [PARAM_SIZE, PARAM_SIZE])
+  prefix = File.join(dir, async ? 'async' : 'sync')
+
+  step_times = []
+  NUM_STEPS.times do |step|
+    t0 = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+    params.each_value do |w|
+      g = MXNet::NDArray.dot(x, w)
+      w.inplace - g * 1e-6
+    end
+    params.each_value(&:wait_to_read)
+    if step % SAVE_INTERVAL == SAVE_INTERVAL - 1
+      MXNet::Model.save_checkpoint(prefix, step, nil, params, {}, async: async)
+    end
+    step_times << Process.clock_gettime(Process::CLOCK_MONOTONIC) - t0
+  end
+  MXNet::Model.wait_checkpoints
+
+  step_times.sort!
+  puts '%-5s  p50 %8.3f ms  p99 %8.3f ms  max %8.3f ms' % [
+    async ? 'async' : 'sync',
+    percentile(step_times, 0.5) * 1000,
+    percentile(step_times, 0.99) * 1000,
+    step_times.last * 1000
+  ]
+end
+
+Dir.mktmpdir do |dir|
+  puts "#{NUM_PARAMS} parameters of #{PARAM_SIZE}x#{PARAM_SIZE}, checkpoint every #{SAVE_INTERVAL} steps"
+  run(false, dir)
+  run(true, dir)
+end
@@ -0,0 +1,41 @@
+# Measures the clipping of the gradients by their global norm.
+#
+# Usage: ruby -Ilib benchmark/clip_global_norm.rb [NUM_ITERATIONS]
+#
+# The clipping with a host sync for each array, by `norm` and
+# `as_scalar`, is compared with `MXNet::Gluon::Utils.clip_global_norm`,
+# for a few numbers of arrays of 4096 elements.
+
+require 'mxnet'
+require 'mxnet/gluon'
+
+NUM_ITERATIONS = Integer(ARGV[0] || 100)
+NUM_ARRAYS = [8, 64, 256].freeze
+
+def clip_per_array(arrays, max_norm)
+  total_norm = Math.sqrt(arrays.sum {|array| MXNet::NDArray.norm(array).as_scalar ** 2 })
+  scale = [max_norm / (total_norm + 1e-8), 1.0].min
+  arrays.each {|array| array[0..-1] = array * scale }
+  total_norm
+end
+
+def measure(arrays)
+  run = lambda do
+    yield arrays
+    MXNet::NDArray.waitall
+  end
+
+  5.times(&run)
+  t0 = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+  NUM_ITERATIONS.times(&run)
+  (Process.clock_gettime(Process::CLOCK_MONOTONIC) - t0) / NUM_ITERATIONS
+end
+
+puts format('%-8s %14s %14s %14s', 'arrays', 'per-array[us]', 'global[us]', 'no-check[us]')
+NUM_ARRAYS.each do |n|
+  arrays = Array.new(n) { MXNet::NDArray::Random.normal(shape: [64, 64]) }
+  per_array = measure(arrays) {|a| clip_per_array(a, 1e6) }
+  global = measure(arrays) {|a| MXNet::Gluon::Utils.clip_global_norm(a, 1e6) }
+  no_check = measure(arrays) {|a| MXNet::Gluon::Utils.clip_global_norm(a, 1e6, check_isfinite: false) }
+  puts format('%-8d %14.1f %14.1f %14.1f', n, per_array * 1e6, global * 1e6, no_check * 1e6)
+end
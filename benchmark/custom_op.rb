@@ -0,0 +1,64 @@
+# Measures the overhead of a custom operator implemented in Ruby.
+#
+# Usage: ruby -Ilib benchmark/custom_op.rb [NUM_ITERATIONS]
+#
+# The built-in sigmoid and a custom elementwise sigmoid composed of the
+# NDArray operations are compared, for the forward alone and for the
+# forward and backward with autograd, on arrays of a few sizes.  The
+# difference is the cost of dispatching the calls from the worker threads
+# of libmxnet to Ruby.
+
+require 'mxnet'
+
+NUM_ITERATIONS = Integer(ARGV[0] || 200)
+SIZES = [16, 4096, 1_048_576].freeze
+
+class Sigmoid < MXNet::Operator::CustomOp
+  def forward(is_train, req, in_data, out_data, aux)
+    y = 1.0 / (1.0 + MXNet::NDArray.exp(-in_data[0]))
+    assign(out_data[0], req[0], y)
+  end
+
+  def backward(req, out_grad, in_data, out_data, in_grad, aux)
+    y = out_data[0]
+    assign(in_grad[0], req[0], out_grad[0] * y * (1.0 - y))
+  end
+end
+
+class SigmoidProp < MXNet::Operator::CustomOpProp
+  def create_operator(ctx, in_shapes, in_dtypes)
+    Sigmoid.new
+  end
+end
+
+MXNet::Operator.register(:rb_sigmoid, SigmoidProp)
+
+def measure(x, backward)
+  run = lambda do
+    if backward
+      y = MXNet::Autograd.record { yield x }
+      y.backward
+      x.grad.wait_to_read
+    else
+      yield(x).wait_to_read
+    end
+  end
+
+  5.times(&run)
+  t0 = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+  NUM_ITERATIONS.times(&run)
+  (Process.clock_gettime(Process::CLOCK_MONOTONIC) - t0) / NUM_ITERATIONS
+end
+
+puts format('%-10s %-9s %12s %12s %10s', 'size', 'pass', 'builtin[us]', 'custom[us]', 'overhead')
+SIZES.each do |size|
+  x = MXNet::NDArray::Random.normal(shape: [size])
+  x.attach_grad
+  [false, true].each do |backward|
+    builtin = measure(x, backward) {|a| MXNet::NDArray.sigmoid(a) }
+    custom = measure(x, backward) {|a| MXNet::NDArray.Custom(a, op_type: :rb_sigmoid) }
+    puts format('%-10d %-9s %12.1f %12.1f %9.1fx',
+                size, backward ? 'fwd+bwd' : 'fwd',
+                builtin * 1e6, custom * 1e6, custom / builtin)
+  end
+end
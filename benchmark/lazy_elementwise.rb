@@ -0,0 +1,36 @@
+# Measures a chain of elementwise operations run eagerly and by
+# `NDArray.lazy`, which runs the chain as one cached op.
+#
+# Usage: ruby -Ilib benchmark/lazy_elementwise.rb [NUM_ITERATIONS]
+#
+# The chain is `(x * a + b).relu.clip(0, 6) * c - d` on arrays of a few
+# sizes.  The lazy time includes the composition of the expression in
+# Ruby and the lookup of the cached op.
+
+require 'mxnet'
+
+NUM_ITERATIONS = Integer(ARGV[0] || 200)
+SHAPES = [[64], [256, 256], [1024, 1024]].freeze
+
+def chain(x, a, b, c, d)
+  (x * a + b).relu.clip(0, 6) * c - d
+end
+
+def measure
+  run = lambda do
+    yield.wait_to_read
+  end
+
+  10.times(&run)
+  t0 = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+  NUM_ITERATIONS.times(&run)
+  (Process.clock_gettime(Process::CLOCK_MONOTONIC) - t0) / NUM_ITERATIONS
+end
+
+puts format('%-14s %12s %12s %8s', 'shape', 'eager[us]', 'lazy[us]', 'speedup')
+SHAPES.each do |shape|
+  x, a, b, c, d = Array.new(5) { MXNet::NDArray::Random.uniform(-1, 1, shape: shape) }
+  eager = measure { chain(x, a, b, c, d) }
+  lazy = measure { MXNet::NDArray.lazy { chain(x, a, b, c, d) } }
+  puts format('%-14s %12.1f %12.1f %7.2fx', shape.join('x'), eager * 1e6, lazy * 1e6, eager / lazy)
+end
@@ -0,0 +1,222 @@
+# Measures the training throughput of the MLP of example/mlp_scratch by
+# three ways of running the same model:
+#
+# imperative:: The operators called one by one within `Autograd.record`.
+# symbolic::   The symbol bound to an `Executor` by `Symbol#bind`.
+# cached::     The symbol run by `CachedOp` within `Autograd.record`,
+#              with `static_alloc` and `static_shape`.
+#
+# Usage: ruby -Ilib benchmark/mlp_training.rb [options] [MNIST_DIR]
+#
+# The batches are random data generated with a fixed seed, or the first
+# batches of the MNIST training set if the directory of its idx files is
+# given.  Nothing is downloaded.  The batches are loaded in advance, so
+# the reading of the data is not measured.
+#
+# Each step is synchronized by `NDArray.waitall` to measure its latency,
+# so the samples/sec are those of the synchronous training.  The peak RSS
+# is reset between the modes where the kernel supports
+# /proc/self/clear_refs, and otherwise accumulates over the modes, which
+# is marked with `*`.
+
+require 'mxnet'
+require 'optparse'
+
+options = {
+  batch_size: 256,
+  hidden: [256, 128, 64],
+  steps: 200,
+  warmup: 20,
+  modes: %w[imperative symbolic cached],
+  gpu_id: nil,
+  seed: 42
+}
+OptionParser.new do |opt|
+  opt.banner = "Usage: #{opt.program_name} [options] [MNIST_DIR]"
+
+  opt.on('-b BATCH_SIZE', '--batch-size', Integer, 'Batch size') {|v| options[:batch_size] = v }
+  opt.on('-n STEPS', '--steps', Integer, 'Number of measured steps') {|v| options[:steps] = v }
+  opt.on('-w STEPS', '--warmup', Integer, 'Number of warmup steps') {|v| options[:warmup] = v }
+  opt.on('--hidden UNITS', Array, 'Hidden units, e.g. 256,128,64') {|v| options[:hidden] = v.map {|u| Integer(u) } }
+  opt.on('-m MODES', '--modes', Array, 'Modes to run (imperative,symbolic,cached)') {|v| options[:modes] = v }
+  opt.on('-g [GPU_ID]', '--gpu', Integer, 'GPU device ID') {|v| options[:gpu_id] = v || 0 }
+  opt.on('-s SEED', '--seed', Integer, 'Random seed') {|v| options[:seed] = v }
+  opt.parse!(ARGV)
+end
+
+NUM_INPUTS = 784
+NUM_OUTPUTS = 10
+LEARNING_RATE = 0.1
+
+ctx = options[:gpu_id] ? MXNet.gpu(options[:gpu_id]) : MXNet.cpu
+batch_size = options[:batch_size]
+num_batches = [options[:steps], 50].min
+layer_dims = [NUM_INPUTS, *options[:hidden], NUM_OUTPUTS]
+
+def load_batches(dir, batch_size, num_batches, ctx, seed)
+  if dir
+    iter = Dir.chdir(dir) do
+      MXNet::IO::MNISTIter.new(batch_size: batch_size, flat: true, shuffle: false)
+    end
+    iter.first(num_batches).map do |batch|
+      [batch.data[0].as_in_context(ctx), batch.label[0].as_in_context(ctx)]
+    end
+  else
+    MXNet::Random.seed(seed)
+    rng = Random.new(seed)
+    Array.new(num_batches) do
+      data = MXNet::NDArray::Random.uniform(0, 1, shape: [batch_size, NUM_INPUTS], ctx: ctx)
+      label = MXNet::NDArray.array(Array.new(batch_size) { rng.rand(NUM_OUTPUTS) }, ctx: ctx)
+      [data, label]
+    end
+  end
+end
+
+def init_params(layer_dims, ctx, seed)
+  MXNet::Random.seed(seed)
+  params = {}
+  layer_dims.each_cons(2).with_index do |(num_in, num_out), i|
+    params[:"fc#{i}_weight"] = MXNet::NDArray::Random.normal(0, 0.01, shape: [num_out, num_in], ctx: ctx)
+    params[:"fc#{i}_bias"] = MXNet::NDArray.zeros([num_out], ctx)
+  end
+  params
+end
+
+def mlp_symbol(layer_dims)
+  h = MXNet::Symbol.var(:data)
+  num_layers = layer_dims.length - 1
+  num_layers.times do |i|
+    h = MXNet::Symbol.FullyConnected(data: h, num_hidden: layer_dims[i + 1], name: :"fc#{i}")
+    h = MXNet::Symbol.Activation(data: h, act_type: 'relu', name: :"relu#{i}") if i < num_layers - 1
+  end
+  MXNet::Symbol.SoftmaxOutput(data: h, name: :softmax)
+end
+
+def sgd(params, grads, batch_size)
+  params.each do |name, weight|
+    MXNet::NDArray::Ops.sgd_update(weight, grads[name], lr: LEARNING_RATE,
+                                   rescale_grad: 1.0 / batch_size, out: weight)
+  end
+end
+
+def attach_grads(params)
+  params.each_value(&:attach_grad)
+  params.map {|name, param| [name, param.grad] }.to_h
+end
+
+# Returns the lambda running a step of the mode on a batch.
+def build_step(mode, layer_dims, params, ctx, batch_size)
+  case mode
+  when 'imperative'
+    grads = attach_grads(params)
+    num_layers = layer_dims.length - 1
+    lambda do |data, label|
+      out = MXNet::Autograd.record do
+        h = data
+        num_layers.times do |i|
+          h = MXNet::NDArray::Ops.FullyConnected(h, params[:"fc#{i}_weight"], params[:"fc#{i}_bias"],
+                                                 num_hidden: layer_dims[i + 1])
+          h = MXNet::NDArray::Ops.Activation(h, act_type: 'relu') if i < num_layers - 1
+        end
+        MXNet::NDArray::Ops.SoftmaxOutput(h, label)
+      end
+      out.backward
+      sgd(params, grads, batch_size)
+    end
+  when 'symbolic'
+    sym = mlp_symbol(layer_dims)
+    data_array = MXNet::NDArray.zeros([batch_size, layer_dims[0]], ctx)
+    label_array = MXNet::NDArray.zeros([batch_size], ctx)
+    args = params.merge(data: data_array, softmax_label: label_array)
+    grads = params.map {|name, param| [name, MXNet::NDArray.zeros(param.shape, ctx)] }.to_h
+    exe = sym.bind(ctx, args, args_grad: grads)
+    lambda do |data, label|
+      data.copy_to(data_array)
+      label.copy_to(label_array)
+      exe.forward(is_train: true)
+      exe.backward
+      sgd(params, grads, batch_size)
+    end
+  when 'cached'
+    sym = mlp_symbol(layer_dims)
+    op = MXNet::CachedOp.new(sym, static_alloc: true, static_shape: true)
+    grads = attach_grads(params)
+    names = sym.list_inputs
+    lambda do |data, label|
+      arrays = params.merge(data: data, softmax_label: label)
+      out = MXNet::Autograd.record { op.(*names.map {|name| arrays[name] }) }
+      out.backward
+      sgd(params, grads, batch_size)
+    end
+  else
+    raise ArgumentError, "unknown mode: #{mode}"
+  end
+end
+
+# Resets the peak RSS of the process, and returns whether it is reset.
+def reset_peak_rss
+  File.write('/proc/self/clear_refs', '5')
+  true
+rescue SystemCallError
+  false
+end
+
+# The peak RSS in KiB.
+def peak_rss_kb
+  status = File.read('/proc/self/status')
+  status[/^VmHWM:\s*(\d+)/, 1].to_i
+rescue SystemCallError
+  Integer(`ps -o rss= -p #{Process.pid}`.strip) rescue 0
+end
+
+# The total time of GC in milliseconds.
+def gc_time_ms
+  if GC.stat.key?(:time)
+    GC.stat(:time)
+  else
+    GC::Profiler.total_time * 1000
+  end
+end
+
+def percentile(sorted, p)
+  sorted[[(sorted.length * p).ceil - 1, 0].max]
+end
+
+GC::Profiler.enable unless GC.stat.key?(:time)
+
+batches = load_batches(ARGV[0], batch_size, num_batches, ctx, options[:seed])
+MXNet::NDArray.waitall
+
+puts "ctx: #{ctx}, batch_size: #{batch_size}, layers: #{layer_dims.inspect}, " \
+     "steps: #{options[:steps]}, data: #{ARGV[0] ? 'MNIST' : 'synthetic'}"
+puts format('%-11s %12s %10s %10s %10s %12s %10s %8s',
+            'mode', 'samples/s', 'p50[ms]', 'p90[ms]', 'p99[ms]', 'peak RSS[MB]', 'GC[ms]', 'GC runs')
+
+options[:modes].each do |mode|
+  params = init_params(layer_dims, ctx, options[:seed])
+  step = build_step(mode, layer_dims, params, ctx, batch_size)
+
+  options[:warmup].times {|i| step.(*batches[i % batches.length]) }
+  MXNet::NDArray.waitall
+
+  GC.start
+  rss_reset = reset_peak_rss
+  gc_time0 = gc_time_ms
+  gc_count0 = GC.count
+  latencies = []
+  t0 = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+  options[:steps].times do |i|
+    s0 = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+    step.(*batches[i % batches.length])
+    MXNet::NDArray.waitall
+    latencies << Process.clock_gettime(Process::CLOCK_MONOTONIC) - s0
+  end
+  elapsed = Process.clock_gettime(Process::CLOCK_MONOTONIC) - t0
+
+  sorted = latencies.sort
+  puts format('%-11s %12.1f %10.3f %10.3f %10.3f %11.1f%s %10.1f %8d',
+              mode, options[:steps] * batch_size / elapsed,
+              percentile(sorted, 0.5) * 1e3, percentile(sorted, 0.9) * 1e3, percentile(sorted, 0.99) * 1e3,
+              peak_rss_kb / 1024.0, rss_reset ? ' ' : '*',
+              gc_time_ms - gc_time0, GC.count - gc_count0)
+end
@@ -0,0 +1,24 @@
+# Benchmarks the operators of libmxnet with MXNet::Benchmark::OpPerf.
+#
+# Usage: ruby -Ilib benchmark/op_perf.rb [OUTPUT_PREFIX] [OP...]
+#
+# All the operators in MXNet::NDArray::Ops are benchmarked unless the
+# names are given.  The results are written to OUTPUT_PREFIX.json and
+# OUTPUT_PREFIX.md (op_perf by default), so that the runs with different
+# versions of libmxnet or of this library can be compared.
+
+require 'mxnet'
+require 'mxnet/benchmark/op_perf'
+
+prefix = ARGV.shift || 'op_perf'
+ops = ARGV.empty? ? nil : ARGV.map(&:to_sym)
+
+perf = MXNet::Benchmark::OpPerf.new(ops: ops, shapes: [[1024], [512, 512]])
+perf.run do |r|
+  status = r.ok? ? format('%10.1f us', r.forward * 1e6) : r.error
+  $stderr.puts format('%-32s %-12s %s', r.op, r.shape.inspect, status)
+end
+
+File.write("#{prefix}.json", perf.to_json)
+File.write("#{prefix}.md", perf.to_markdown)
+puts "Wrote #{prefix}.json and #{prefix}.md"
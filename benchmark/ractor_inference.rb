@@ -0,0 +1,65 @@
+# Compares the inference throughput of workers in threads and in Ractors.
+#
+# Usage: ruby -Ilib benchmark/ractor_inference.rb [NUM_WORKERS] [BATCH_SIZE]
+#
+# Each worker binds its own executor of a small MLP and repeats forward
+# computations of tiny batches, so most of the time is spent in the Ruby
+# glue rather than in the kernels.  Threads serialize the glue on the GVL,
+# while Ractors can run it in parallel.
+
+require 'mxnet'
+
+NUM_WORKERS = Integer(ARGV[0] || 4)
+BATCH_SIZE = Integer(ARGV[1] || 1)
+NUM_ITERATIONS = 2000
+
+def build_executor(batch_size)
+  data = MXNet::Symbol.var(:data)
+  fc1 = MXNet::Symbol.FullyConnected(data: data, num_hidden: 64, name: :fc1)
+  act1 = MXNet::Symbol.Activation(data: fc1, act_type: :relu, name: :relu1)
+  fc2 = MXNet::Symbol.FullyConnected(data: act1, num_hidden: 10, name: :fc2)
+  net = MXNet::Symbol.softmax(data: fc2, name: :softmax)
+
+  arg_shapes, _, _ = net.infer_shape(data: [batch_size, 32])
+  args = {}
+  net.list_arguments.zip(arg_shapes) do |name, shape|
+    args[name] = MXNet::NDArray::Random.uniform(shape: shape)
+  end
+  net.bind(MXNet.cpu, args, grad_req: :null)
+end
+
+def work(batch_size, iterations)
+  executor = build_executor(batch_size)
+  iterations.times do
+    executor.forward(is_train: false)[0].wait_to_read
+  end
+  iterations
+end
+
+def measure(label)
+  t0 = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+  count = yield
+  elapsed = Process.clock_gettime(Process::CLOCK_MONOTONIC) - t0
+  puts '%-10s %10.1f batches/s' % [label, count / elapsed]
+end
+
+puts "#{NUM_WORKERS} workers, batch size #{BATCH_SIZE}, #{NUM_ITERATIONS} iterations each"
+
+measure('single') do
+  work(BATCH_SIZE, NUM_ITERATIONS)
+end
+
+measure('threads') do
+  Array.new(NUM_WORKERS) {
+    Thread.new { work(BATCH_SIZE, NUM_ITERATIONS) }
+  }.sum(&:value)
+end
+
+if defined?(Ractor)
+  Warning[:experimental] = false
+  measure('ractors') do
+    Array.new(NUM_WORKERS) {
+      Ractor.new(BATCH_SIZE, NUM_ITERATIONS) {|batch_size, iterations| work(batch_size, iterations) }
+    }.sum(&:take)
+  end
+end
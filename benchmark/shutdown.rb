@@ -0,0 +1,27 @@
+# Measures how long a process takes to exit with many live NDArrays.
+#
+# Usage: ruby -Ilib benchmark/shutdown.rb [NUM_ARRAYS]
+#
+# A child process creates NUM_ARRAYS small arrays, queues a computation
+# on each of them, and exits while they are alive.  The time from the end
+# of the script to the exit of the process is reported, which includes
+# waiting for the engine, MXNotifyShutdown and the finalizers of the
+# arrays.
+
+require 'rbconfig'
+
+NUM_ARRAYS = Integer(ARGV[0] || 100_000)
+
+lib = File.expand_path('../lib', __dir__)
+code = <<~RUBY
+  arrays = Array.new(#{NUM_ARRAYS}) { MXNet::NDArray.ones([4]) * 2 }
+  $stdout.write([Process.clock_gettime(Process::CLOCK_MONOTONIC)].pack('G'))
+  $stdout.flush
+RUBY
+
+IO.popen([RbConfig.ruby, '-I', lib, '-r', 'mxnet', '-e', code], 'rb') do |io|
+  script_end = io.read(8).unpack1('G')
+  io.read
+  exited = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+  puts format('%d live arrays: exit took %.3f s', NUM_ARRAYS, exited - script_end)
+end
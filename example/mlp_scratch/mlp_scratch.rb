@@ -24,7 +24,9 @@ module MLPScratch
         @weights << rnorm(dims)
         @biases << rnorm([dims[1]])
       end
-      [*@weights, *@biases].each(&:attach_grad)
+      params = [*@weights, *@biases]
+      MXNet::Autograd.mark_variables(params, flat: true)
+      params
     end
 
     private def relu(x)
@@ -1,96 +1,311 @@
 #include "mxnet_internal.h"
 
-/* Compute the gradients of heads w.r.t previously marked variables.
- */
 static VALUE
-autograd_s_backward(int argc, VALUE *argv, VALUE mod)
+to_ndarray_array(VALUE obj)
+{
+  if (mxnet_is_ndarray(obj)) {
+    VALUE ary = rb_ary_new_capa(1);
+    rb_ary_push(ary, obj);
+    return ary;
+  }
+
+  obj = rb_convert_type(obj, T_ARRAY, "Array", "to_ary");
+#if SIZEOF_LONG > SIZEOF_INT
+  if (RARRAY_LEN(obj) > UINT_MAX) {
+    rb_raise(rb_eArgError, "too many arrays");
+  }
+#endif
+  return obj;
+}
+
+static NDArrayHandle *
+get_ndarray_handles(VALUE ary, VALUE *tmp_str)
 {
-  VALUE heads, opts, head_grads = Qnil;
-  int retain_graphs = 0, train_mode = 1;
+  NDArrayHandle *handles;
+  long i, len;
 
-  VALUE head_handles_str, head_grad_handles_str;
-  NDArrayHandle *head_handles, *head_grad_handles = NULL;
-  mx_uint i, heads_len;
+  len = RARRAY_LEN(ary);
+  *tmp_str = rb_str_tmp_new(sizeof(NDArrayHandle) * len);
+  handles = (NDArrayHandle *)RSTRING_PTR(*tmp_str);
+  for (i = 0; i < len; ++i) {
+    handles[i] = mxnet_ndarray_get_handle(RARRAY_AREF(ary, i));
+  }
+  return handles;
+}
+
+struct backward_args {
+  VALUE heads;
+  VALUE head_grads;
+  int retain_graph;
+  int create_graph;
+  int train_mode;
+
+  VALUE head_handles_str;
+  VALUE head_grad_handles_str;
+  NDArrayHandle *head_handles;
+  NDArrayHandle *head_grad_handles;
+};
+
+/* Extracts the arguments common to backward and grad.  Only grad takes
+ * create_graph, and defaults retain_graph to it.
+ */
+static void
+extract_backward_args(VALUE heads, VALUE opts, int for_grad,
+                      struct backward_args *args)
+{
+  VALUE retain_graph = Qundef;
+
+  args->head_grads = Qnil;
+  args->retain_graph = 0;
+  args->create_graph = 0;
+  args->train_mode = 1;
 
-  rb_scan_args(argc, argv, "1:", &heads, &opts);
   if (!NIL_P(opts)) {
-    static ID keywords[3];
-    VALUE vals[3];
+    static ID keywords[4];
+    VALUE vals[4];
 
     if (keywords[0] == 0) {
       keywords[0] = rb_intern("head_grads");
       keywords[1] = rb_intern("retain_graph");
       keywords[2] = rb_intern("train_mode");
+      keywords[3] = rb_intern("create_graph");
     }
 
-    rb_get_kwargs(opts, keywords, 0, 3, vals);
+    rb_get_kwargs(opts, keywords, 0, for_grad ? 4 : 3, vals);
 
     if (vals[0] != Qundef) {
-      head_grads = vals[0];
+      args->head_grads = vals[0];
     }
     if (vals[1] != Qundef) {
-      retain_graphs = RTEST(vals[1]);
+      retain_graph = vals[1];
     }
     if (vals[2] != Qundef) {
-      train_mode = RTEST(vals[2]);
+      args->train_mode = RTEST(vals[2]);
+    }
+    if (for_grad && vals[3] != Qundef) {
+      args->create_graph = RTEST(vals[3]);
     }
   }
 
-  if (mxnet_is_ndarray(heads)) {
-    VALUE ary = rb_ary_new_capa(1);
-    rb_ary_push(ary, heads);
-    heads = ary;
-  }
-
-  heads = rb_convert_type(heads, T_ARRAY, "Array", "to_ary");
-#if SIZEOF_LONG > SIZEOF_INT
-  if (RARRAY_LEN(heads) > UINT_MAX) {
-    rb_raise(rb_eArgError, "too many heads");
+  if (retain_graph == Qundef || NIL_P(retain_graph)) {
+    args->retain_graph = for_grad ? args->create_graph : 0;
   }
-#endif
-
-  heads_len = (mx_uint)RARRAY_LEN(heads);
-  head_handles_str = rb_str_tmp_new(sizeof(NDArrayHandle) * heads_len);
-  head_handles = (NDArrayHandle *)RSTRING_PTR(head_handles_str);
-  for (i = 0; i < heads_len; ++i) {
-    head_handles[i] = mxnet_ndarray_get_handle(RARRAY_AREF(heads, i));
+  else {
+    args->retain_graph = RTEST(retain_graph);
   }
 
-  if (!NIL_P(head_grads)) {
-    if (mxnet_is_ndarray(head_grads)) {
-      VALUE ary = rb_ary_new_capa(1);
-      rb_ary_push(ary, head_grads);
-      head_grads = ary;
-    }
+  args->heads = to_ndarray_array(heads);
+  args->head_handles = get_ndarray_handles(args->heads, &args->head_handles_str);
 
-    head_grads = rb_convert_type(head_grads, T_ARRAY, "Array", "to_ary");
-    if (RARRAY_LEN(heads) != RARRAY_LEN(head_grads)) {
+  args->head_grad_handles_str = Qnil;
+  args->head_grad_handles = NULL;
+  if (!NIL_P(args->head_grads)) {
+    args->head_grads = to_ndarray_array(args->head_grads);
+    if (RARRAY_LEN(args->heads) != RARRAY_LEN(args->head_grads)) {
       rb_raise(rb_eArgError, "haeds and head_grads must be arrays of the same length");
     }
-
-    head_grad_handles_str = rb_str_tmp_new(sizeof(NDArrayHandle) * heads_len);
-    head_grad_handles = (NDArrayHandle *)RSTRING_PTR(head_grad_handles_str);
-    for (i = 0; i < heads_len; ++i) {
-      head_grad_handles[i] = mxnet_ndarray_get_handle(RARRAY_AREF(head_grads, i));
-    }
+    args->head_grad_handles = get_ndarray_handles(args->head_grads, &args->head_grad_handles_str);
   }
+}
+
+/* Compute the gradients of heads w.r.t previously marked variables.
+ */
+static VALUE
+autograd_s_backward(int argc, VALUE *argv, VALUE mod)
+{
+  VALUE heads, opts;
+  struct backward_args args;
+
+  rb_scan_args(argc, argv, "1:", &heads, &opts);
+  extract_backward_args(heads, opts, 0, &args);
 
   CHECK_CALL(
     MXNET_API(MXAutogradBackwardEx)(
-      heads_len,
-      head_handles,
-      head_grad_handles,
+      (mx_uint)RARRAY_LEN(args.heads),
+      args.head_handles,
+      args.head_grad_handles,
       0,
       NULL,
-      retain_graphs,
+      args.retain_graph,
       0,
-      train_mode,
+      args.train_mode,
       NULL,
       NULL));
 
+  RB_GC_GUARD(args.head_handles_str);
+  RB_GC_GUARD(args.head_grad_handles_str);
   return Qnil;
 }
 
+/* Compute the gradients of heads w.r.t. the given variables.
+ *
+ * Unlike `backward`, the gradients are returned as new arrays, instead
+ * of being written to the gradient buffers attached to the variables.
+ * The variables must be marked by `attach_grad` or `mark_variables`
+ * before recording, but their gradient buffers are left untouched.
+ *
+ *     x.attach_grad
+ *     y = MXNet::Autograd.record { x * x * x }
+ *     dx = MXNet::Autograd.grad(y, x, create_graph: true)
+ *     # the second derivative
+ *     dx.backward
+ *
+ * @param heads [NDArray, Array<NDArray>]  The output arrays.
+ * @param variables [NDArray, Array<NDArray>]  The arrays to compute the
+ *   gradients for.
+ * @param head_grads [NDArray, Array<NDArray>, nil]  The gradients of the
+ *   heads.  The default is ones.
+ * @param retain_graph [true, false, nil]  Whether to keep the graph to
+ *   compute the gradients again.  The default is the value of
+ *   `create_graph`.
+ * @param create_graph [true, false]  Whether to record the computation of
+ *   the gradients, so that higher order gradients can be computed.
+ * @param train_mode [true, false]  Whether to compute in the training mode.
+ * @return [NDArray, Array<NDArray>] The gradients, an NDArray for an
+ *   NDArray `variables`, or an Array otherwise.
+ */
+static VALUE
+autograd_s_grad(int argc, VALUE *argv, VALUE mod)
+{
+  VALUE heads, variables, opts, vars, var_handles_str, grads;
+  struct backward_args args;
+  NDArrayHandle *var_handles, *grad_handles = NULL;
+  int *grad_stypes = NULL;
+  mx_uint i, num_vars;
+
+  rb_scan_args(argc, argv, "2:", &heads, &variables, &opts);
+  extract_backward_args(heads, opts, 1, &args);
+
+  vars = to_ndarray_array(variables);
+  num_vars = (mx_uint)RARRAY_LEN(vars);
+  var_handles = get_ndarray_handles(vars, &var_handles_str);
+
+  CHECK_CALL(
+    MXNET_API(MXAutogradBackwardEx)(
+      (mx_uint)RARRAY_LEN(args.heads),
+      args.head_handles,
+      args.head_grad_handles,
+      num_vars,
+      var_handles,
+      args.retain_graph,
+      args.create_graph,
+      args.train_mode,
+      &grad_handles,
+      &grad_stypes));
+
+  RB_GC_GUARD(args.head_handles_str);
+  RB_GC_GUARD(args.head_grad_handles_str);
+  RB_GC_GUARD(var_handles_str);
+
+  grads = rb_ary_new_capa(num_vars);
+  for (i = 0; i < num_vars; ++i) {
+    rb_ary_push(grads, mxnet_ndarray_new(grad_handles[i]));
+  }
+
+  if (mxnet_is_ndarray(variables)) {
+    return RARRAY_AREF(grads, 0);
+  }
+  return grads;
+}
+
+static mx_uint
+grad_req_id(VALUE grad_req_map, VALUE grad_req)
+{
+  VALUE req;
+
+  if (RB_TYPE_P(grad_req, T_STRING)) {
+    grad_req = rb_str_intern(grad_req);
+  }
+  req = rb_hash_lookup2(grad_req_map, grad_req, Qundef);
+  if (req == Qundef) {
+    rb_raise(rb_eArgError, "grad_req must be in %"PRIsVALUE, grad_req_map);
+  }
+  return NUM2UINT(req);
+}
+
+/* Mark the arrays as the variables with the given gradient buffers and
+ * requests by one call of MXAutogradMarkVariables.
+ *
+ * @param variables [Array<NDArray>]
+ * @param grads [Array<NDArray>]
+ * @param grad_reqs [Array<Symbol>]  Each of `:write`, `:add` and `:null`.
+ * @return [nil]
+ */
+static VALUE
+autograd_s_mark_variables(VALUE mod, VALUE variables, VALUE grads, VALUE grad_reqs)
+{
+  VALUE var_handles_str, grad_handles_str, reqs_str, grad_req_map;
+  NDArrayHandle *var_handles, *grad_handles;
+  mx_uint *reqs;
+  long i, num_vars;
+
+  variables = to_ndarray_array(variables);
+  grads = to_ndarray_array(grads);
+  grad_reqs = rb_convert_type(grad_reqs, T_ARRAY, "Array", "to_ary");
+  num_vars = RARRAY_LEN(variables);
+  if (RARRAY_LEN(grads) != num_vars || RARRAY_LEN(grad_reqs) != num_vars) {
+    rb_raise(rb_eArgError, "variables, grads and grad_reqs must be arrays of the same length");
+  }
+
+  var_handles = get_ndarray_handles(variables, &var_handles_str);
+  grad_handles = get_ndarray_handles(grads, &grad_handles_str);
+
+  grad_req_map = mxnet_grad_req_map();
+  reqs_str = rb_str_tmp_new(sizeof(mx_uint) * num_vars);
+  reqs = (mx_uint *)RSTRING_PTR(reqs_str);
+  for (i = 0; i < num_vars; ++i) {
+    reqs[i] = grad_req_id(grad_req_map, RARRAY_AREF(grad_reqs, i));
+  }
+
+  CHECK_CALL(MXNET_API(MXAutogradMarkVariables)((mx_uint)num_vars, var_handles, reqs, grad_handles));
+
+  RB_GC_GUARD(var_handles_str);
+  RB_GC_GUARD(grad_handles_str);
+  RB_GC_GUARD(reqs_str);
+  return Qnil;
+}
+
+/* The recording and training states of libmxnet are thread-local.  They
+ * are cached in the thread-local variables of the same native thread, so
+ * that the scopes that do not change the states make no call of libmxnet.
+ * -1 means that the state is unknown.
+ */
+#ifdef HAVE_THREAD_LOCAL_STORAGE
+static __thread int cached_recording = -1;
+static __thread int cached_training = -1;
+# define CACHED_STATE(var) (var)
+# define SET_CACHED_STATE(var, val) ((var) = (val))
+#else
+# define CACHED_STATE(var) (-1)
+# define SET_CACHED_STATE(var, val) ((void)(val))
+#endif
+
+static int
+set_recording(int is_recording)
+{
+  int prev;
+
+  if (CACHED_STATE(cached_recording) == is_recording) {
+    return is_recording;
+  }
+  CHECK_CALL(MXNET_API(MXAutogradSetIsRecording)(is_recording, &prev));
+  SET_CACHED_STATE(cached_recording, is_recording);
+  return prev;
+}
+
+static int
+set_training(int train_mode)
+{
+  int prev;
+
+  if (CACHED_STATE(cached_training) == train_mode) {
+    return train_mode;
+  }
+  CHECK_CALL(MXNET_API(MXAutogradSetIsTraining)(train_mode, &prev));
+  SET_CACHED_STATE(cached_training, train_mode);
+  return prev;
+}
+
 /* Set status to recording/not recording.
  * When recording, graph will be constructed for gradient computation.
  *
@@ -100,9 +315,7 @@ autograd_s_backward(int argc, VALUE *argv, VALUE mod)
 static VALUE
 autograd_s_set_recording(VALUE mod, VALUE is_recording)
 {
-  int prev;
-  CHECK_CALL(MXNET_API(MXAutogradSetIsRecording)(RTEST(is_recording), &prev));
-  return prev ? Qtrue : Qfalse;
+  return set_recording(RTEST(is_recording)) ? Qtrue : Qfalse;
 }
 
 /* Set status to training/predicting.  This affects ctx.is_train in operator
@@ -115,9 +328,7 @@ autograd_s_set_recording(VALUE mod, VALUE is_recording)
 static VALUE
 autograd_s_set_training(VALUE mod, VALUE train_mode)
 {
-  int prev;
-  CHECK_CALL(MXNET_API(MXAutogradSetIsTraining)(RTEST(train_mode), &prev));
-  return prev ? Qtrue : Qfalse;
+  return set_training(RTEST(train_mode)) ? Qtrue : Qfalse;
 }
 
 static VALUE
@@ -125,6 +336,7 @@ autograd_s_recording_p(VALUE mod)
 {
   bool curr;
   CHECK_CALL(MXNET_API(MXAutogradIsRecording)(&curr));
+  SET_CACHED_STATE(cached_recording, curr ? 1 : 0);
   return curr ? Qtrue : Qfalse;
 }
 
@@ -133,18 +345,419 @@ autograd_s_training_p(VALUE mod)
 {
   bool curr;
   CHECK_CALL(MXNET_API(MXAutogradIsTraining)(&curr));
+  SET_CACHED_STATE(cached_training, curr ? 1 : 0);
   return curr ? Qtrue : Qfalse;
 }
 
+/* ==== Scopes ==== */
+
+#define STATE_UNCHANGED (-1)
+
+struct recording_scope {
+  int is_record;
+  int train_mode;
+  int prev_is_record;
+  int prev_train_mode;
+};
+
+static VALUE
+recording_scope_yield(VALUE arg)
+{
+  return rb_yield_values(0);
+}
+
+static VALUE
+recording_scope_restore(VALUE arg)
+{
+  struct recording_scope *scope = (struct recording_scope *)arg;
+
+  if (scope->is_record != STATE_UNCHANGED && scope->prev_is_record != scope->is_record) {
+    set_recording(scope->prev_is_record);
+  }
+  if (scope->train_mode != STATE_UNCHANGED && scope->prev_train_mode != scope->train_mode) {
+    set_training(scope->prev_train_mode);
+  }
+  return Qnil;
+}
+
+static VALUE
+set_training_protected(VALUE train_mode)
+{
+  return set_training(FIX2INT(train_mode)) ? Qtrue : Qfalse;
+}
+
+/* Runs the given block with the given states, and restores the previous
+ * states after the block.  The states of STATE_UNCHANGED are not touched.
+ */
+static VALUE
+with_recording_state(int is_record, int train_mode)
+{
+  struct recording_scope scope;
+
+  rb_need_block();
+
+  scope.is_record = is_record;
+  scope.train_mode = train_mode;
+  scope.prev_is_record = STATE_UNCHANGED;
+  scope.prev_train_mode = STATE_UNCHANGED;
+
+  if (is_record != STATE_UNCHANGED) {
+    scope.prev_is_record = set_recording(is_record);
+  }
+  if (train_mode != STATE_UNCHANGED) {
+    int state = 0;
+    VALUE prev = rb_protect(set_training_protected, INT2FIX(train_mode), &state);
+    if (state) {
+      scope.train_mode = STATE_UNCHANGED;
+      recording_scope_restore((VALUE)&scope);
+      rb_jump_tag(state);
+    }
+    scope.prev_train_mode = RTEST(prev);
+  }
+
+  return rb_ensure(recording_scope_yield, Qnil, recording_scope_restore, (VALUE)&scope);
+}
+
+/* nil leaves the training state unchanged. */
+static int
+scope_train_mode(int argc, VALUE train_mode, int default_value)
+{
+  if (argc == 0) return default_value;
+  if (NIL_P(train_mode)) return STATE_UNCHANGED;
+  return RTEST(train_mode);
+}
+
+/* Make autograd recording scope in the given block.
+ *
+ * The previous states are restored after the block.
+ *
+ *     loss = MXNet::Autograd.record do
+ *       output = net.(data)
+ *       loss_func.(output, label)
+ *     end
+ *
+ * @param train_mode [true, false, nil]  Whether to compute in the training
+ *   mode.  nil leaves the training state unchanged.
+ * @return The value of the block.
+ */
+static VALUE
+autograd_s_record(int argc, VALUE *argv, VALUE mod)
+{
+  VALUE train_mode;
+
+  rb_scan_args(argc, argv, "01", &train_mode);
+  return with_recording_state(1, scope_train_mode(argc, train_mode, 1));
+}
+
+/* Make a scope in the given block where the computation is not recorded.
+ *
+ * @param train_mode [true, false, nil]  Whether to compute in the training
+ *   mode.  nil leaves the training state unchanged.
+ * @return The value of the block.
+ */
+static VALUE
+autograd_s_pause(int argc, VALUE *argv, VALUE mod)
+{
+  VALUE train_mode;
+
+  rb_scan_args(argc, argv, "01", &train_mode);
+  return with_recording_state(0, scope_train_mode(argc, train_mode, 0));
+}
+
+/* Make a scope in the given block where the computation is in the
+ * training mode.  The recording state is not changed.
+ *
+ * @return The value of the block.
+ */
+static VALUE
+autograd_s_train_mode(VALUE mod)
+{
+  return with_recording_state(STATE_UNCHANGED, 1);
+}
+
+/* Make a scope in the given block where the computation is in the
+ * predicting mode.  The recording state is not changed.
+ *
+ * @return The value of the block.
+ */
+static VALUE
+autograd_s_predict_mode(VALUE mod)
+{
+  return with_recording_state(STATE_UNCHANGED, 0);
+}
+
+/* ==== Recorder ==== */
+
+struct recorder {
+  int is_record;
+  int train_mode;
+};
+
+static const rb_data_type_t recorder_data_type = {
+  "MXNet::Autograd::Recorder",
+  {
+    NULL,
+    RUBY_TYPED_DEFAULT_FREE,
+    NULL,
+  },
+  0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE
+recorder_allocate(VALUE klass)
+{
+  struct recorder *rec;
+  VALUE obj = TypedData_Make_Struct(klass, struct recorder, &recorder_data_type, rec);
+  rec->is_record = 1;
+  rec->train_mode = 1;
+  return obj;
+}
+
+/* A recorder runs blocks with the fixed recording and training states.
+ *
+ * The arguments are parsed once when the recorder is created, so that
+ * the loops entering the scope many times pay only for setting the
+ * states.
+ *
+ *     recorder = MXNet::Autograd::Recorder.new(train_mode: true)
+ *     data_iter.each do |batch|
+ *       loss = recorder.record { loss_func.(net.(batch.data[0]), batch.label[0]) }
+ *       loss.backward
+ *     end
+ *
+ * @param recording [true, false]  Whether to record the computation.
+ * @param train_mode [true, false]  Whether to compute in the training mode.
+ */
+static VALUE
+recorder_initialize(int argc, VALUE *argv, VALUE obj)
+{
+  struct recorder *rec;
+  VALUE opts;
+
+  TypedData_Get_Struct(obj, struct recorder, &recorder_data_type, rec);
+
+  rb_scan_args(argc, argv, "0:", &opts);
+  if (!NIL_P(opts)) {
+    static ID keywords[2];
+    VALUE vals[2];
+
+    if (keywords[0] == 0) {
+      keywords[0] = rb_intern("recording");
+      keywords[1] = rb_intern("train_mode");
+    }
+
+    rb_get_kwargs(opts, keywords, 0, 2, vals);
+
+    if (vals[0] != Qundef) {
+      rec->is_record = RTEST(vals[0]);
+    }
+    if (vals[1] != Qundef) {
+      rec->train_mode = RTEST(vals[1]);
+    }
+  }
+
+  return obj;
+}
+
+/* Run the given block in the scope of the recorder.
+ *
+ * @return The value of the block.
+ */
+static VALUE
+recorder_record(VALUE obj)
+{
+  struct recorder *rec;
+
+  TypedData_Get_Struct(obj, struct recorder, &recorder_data_type, rec);
+  return with_recording_state(rec->is_record, rec->train_mode);
+}
+
+static VALUE
+recorder_recording_p(VALUE obj)
+{
+  struct recorder *rec;
+
+  TypedData_Get_Struct(obj, struct recorder, &recorder_data_type, rec);
+  return rec->is_record ? Qtrue : Qfalse;
+}
+
+static VALUE
+recorder_train_mode_p(VALUE obj)
+{
+  struct recorder *rec;
+
+  TypedData_Get_Struct(obj, struct recorder, &recorder_data_type, rec);
+  return rec->train_mode ? Qtrue : Qfalse;
+}
+
+/* Returns the recorded computation history of the array as a symbol.
+ *
+ * @param x [NDArray]  An array computed while recording.
+ * @return [Symbol]
+ */
+static VALUE
+autograd_s_get_symbol(VALUE mod, VALUE x)
+{
+  SymbolHandle handle;
+
+  MXNET_API_CHECK(MXAutogradGetSymbol);
+
+  CHECK_CALL(MXNET_API(MXAutogradGetSymbol)(mxnet_ndarray_get_handle(x), &handle));
+  return mxnet_symbol_new(handle);
+}
+
+/* ==== Function ==== */
+
+enum CustomFunctionCallbacks {
+  kCustomFunctionBackward,
+  kCustomFunctionDelete,
+  NUM_FUNCTION_CALLBACKS
+};
+
+struct custom_function {
+  struct mxnet_live_object live;
+  int (*callbacks[NUM_FUNCTION_CALLBACKS])(void);
+  void *contexts[NUM_FUNCTION_CALLBACKS];
+};
+
+static int
+custom_function_delete(void *state)
+{
+  struct custom_function *func = (struct custom_function *)state;
+
+  mxnet_live_object_unlink(&func->live);
+  free(func);
+  return 1;
+}
+
+struct custom_function_backward_args {
+  struct custom_function *func;
+  int num_ograds;
+  int num_igrads;
+  void **ptrs;
+  int const *reqs;
+};
+
+static VALUE
+custom_function_backward_body(VALUE ptr)
+{
+  struct custom_function_backward_args *args = (struct custom_function_backward_args *)ptr;
+  VALUE output_grads, input_grads, reqs;
+  int i;
+
+  /* The NDArrays given to the callback are owned by the callee. */
+  output_grads = rb_ary_new_capa(args->num_ograds);
+  for (i = 0; i < args->num_ograds; ++i) {
+    rb_ary_push(output_grads, mxnet_ndarray_new(args->ptrs[i]));
+  }
+  input_grads = rb_ary_new_capa(args->num_igrads);
+  reqs = rb_ary_new_capa(args->num_igrads);
+  for (i = 0; i < args->num_igrads; ++i) {
+    rb_ary_push(input_grads, mxnet_ndarray_new(args->ptrs[args->num_ograds + i]));
+    rb_ary_push(reqs, INT2NUM(args->reqs[i]));
+  }
+
+  rb_funcall(args->func->live.obj, rb_intern("_backward_entry"), 3,
+             output_grads, input_grads, reqs);
+  return Qnil;
+}
+
+static int
+custom_function_backward(int num_ograds, int num_igrads, void **ptrs,
+                         int const *reqs, int const is_train, void *state)
+{
+  struct custom_function_backward_args args;
+
+  args.func = (struct custom_function *)state;
+  args.num_ograds = num_ograds;
+  args.num_igrads = num_igrads;
+  args.ptrs = ptrs;
+  args.reqs = reqs;
+  return mxnet_callback_protect(custom_function_backward_body, &args);
+}
+
+/* Record a node of the given function from the inputs to the outputs.
+ *
+ * @param function [Autograd::Function]
+ * @param inputs [Array<NDArray>]
+ * @param outputs [Array<NDArray>]
+ * @return [nil]
+ */
+static VALUE
+autograd_s_record_custom_function(VALUE mod, VALUE function, VALUE inputs, VALUE outputs)
+{
+  VALUE input_handles_str, output_handles_str;
+  NDArrayHandle *input_handles, *output_handles;
+  struct custom_function *func;
+  struct MXCallbackList callbacks;
+  int i, result;
+
+  MXNET_API_CHECK(MXCustomFunctionRecord);
+
+  inputs = to_ndarray_array(inputs);
+  outputs = to_ndarray_array(outputs);
+  input_handles = get_ndarray_handles(inputs, &input_handles_str);
+  output_handles = get_ndarray_handles(outputs, &output_handles_str);
+
+  mxnet_callback_start_server();
+
+  /* freed by the delete callback, which can be called without the GVL */
+  func = (struct custom_function *)malloc(sizeof(struct custom_function));
+  if (func == NULL) {
+    rb_memerror();
+  }
+  func->callbacks[kCustomFunctionBackward] = (int (*)(void))custom_function_backward;
+  func->callbacks[kCustomFunctionDelete] = (int (*)(void))custom_function_delete;
+  for (i = 0; i < NUM_FUNCTION_CALLBACKS; ++i) {
+    func->contexts[i] = func;
+  }
+  mxnet_live_object_link(&func->live, function);
+
+  callbacks.num_callbacks = NUM_FUNCTION_CALLBACKS;
+  callbacks.callbacks = func->callbacks;
+  callbacks.contexts = func->contexts;
+
+  result = MXNET_API(MXCustomFunctionRecord)(
+      (int)RARRAY_LEN(inputs), input_handles,
+      (int)RARRAY_LEN(outputs), output_handles,
+      &callbacks);
+  if (result != 0) {
+    mxnet_live_object_unlink(&func->live);
+    free(func);
+    mxnet_raise_last_error();
+  }
+
+  RB_GC_GUARD(input_handles_str);
+  RB_GC_GUARD(output_handles_str);
+  return Qnil;
+}
+
 void
 mxnet_init_autograd(void)
 {
-  VALUE mAutograd;
+  VALUE mAutograd, cRecorder;
 
   mAutograd = rb_const_get_at(mxnet_mMXNet, rb_intern("Autograd"));
   rb_define_singleton_method(mAutograd, "backward", autograd_s_backward, -1);
+  rb_define_singleton_method(mAutograd, "grad", autograd_s_grad, -1);
+  rb_define_singleton_method(mAutograd, "_mark_variables", autograd_s_mark_variables, 3);
+  rb_funcall(mAutograd, rb_intern("private_class_method"), 1, ID2SYM(rb_intern("_mark_variables")));
+  rb_define_singleton_method(mAutograd, "get_symbol", autograd_s_get_symbol, 1);
+  rb_define_singleton_method(mAutograd, "_record_custom_function", autograd_s_record_custom_function, 3);
+  rb_funcall(mAutograd, rb_intern("private_class_method"), 1, ID2SYM(rb_intern("_record_custom_function")));
   rb_define_singleton_method(mAutograd, "set_recording", autograd_s_set_recording, 1);
   rb_define_singleton_method(mAutograd, "set_training", autograd_s_set_training, 1);
   rb_define_singleton_method(mAutograd, "recording?", autograd_s_recording_p, 0);
   rb_define_singleton_method(mAutograd, "training?", autograd_s_training_p, 0);
+  rb_define_singleton_method(mAutograd, "record", autograd_s_record, -1);
+  rb_define_singleton_method(mAutograd, "pause", autograd_s_pause, -1);
+  rb_define_singleton_method(mAutograd, "train_mode", autograd_s_train_mode, 0);
+  rb_define_singleton_method(mAutograd, "predict_mode", autograd_s_predict_mode, 0);
+
+  cRecorder = rb_define_class_under(mAutograd, "Recorder", rb_cObject);
+  rb_define_alloc_func(cRecorder, recorder_allocate);
+  rb_define_method(cRecorder, "initialize", recorder_initialize, -1);
+  rb_define_method(cRecorder, "record", recorder_record, 0);
+  rb_define_method(cRecorder, "recording?", recorder_recording_p, 0);
+  rb_define_method(cRecorder, "train_mode?", recorder_train_mode_p, 0);
 }
@@ -0,0 +1,190 @@
+#include "mxnet_internal.h"
+
+static void
+cached_op_free(void *ptr)
+{
+  if (ptr != NULL && !mxnet_is_shutdown()) {
+    MXNET_API(MXFreeCachedOp)((CachedOpHandle)ptr);
+  }
+}
+
+static size_t
+cached_op_memsize(void const *ptr)
+{
+  return 0;
+}
+
+static const rb_data_type_t cached_op_data_type = {
+  "MXNet::CachedOp",
+  {
+    NULL,
+    cached_op_free,
+    cached_op_memsize,
+  },
+  0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static CachedOpHandle
+cached_op_get_handle(VALUE obj)
+{
+  CachedOpHandle handle;
+  TypedData_Get_Struct(obj, void, &cached_op_data_type, handle);
+  if (handle == NULL) {
+    rb_raise(mxnet_eError, "uninitialized cached op");
+  }
+  return handle;
+}
+
+static VALUE
+cached_op_allocate(VALUE klass)
+{
+  return TypedData_Wrap_Struct(klass, &cached_op_data_type, NULL);
+}
+
+/* Creates the cached op of the symbol.
+ *
+ * The flags are passed to libmxnet as strings, such as
+ * `static_alloc: true`.  They are ignored by libmxnet older than 1.2,
+ * which has no flags.
+ *
+ * @param sym [Symbol]
+ * @param flags [Hash{Symbol => Object}]
+ */
+static VALUE
+cached_op_initialize(int argc, VALUE *argv, VALUE obj)
+{
+  VALUE sym, flags, keys, vals, keys_str, vals_str;
+  SymbolHandle sym_handle;
+  CachedOpHandle handle;
+  char const **c_keys, **c_vals;
+  long i, num_flags;
+
+  MXNET_API_CHECK(MXCreateCachedOp);
+  MXNET_API_CHECK(MXInvokeCachedOp);
+  MXNET_API_CHECK(MXFreeCachedOp);
+
+  rb_scan_args(argc, argv, "11", &sym, &flags);
+  if (DATA_PTR(obj) != NULL) {
+    rb_raise(rb_eRuntimeError, "cached op is already initialized");
+  }
+
+  mxnet_check_type(sym, mxnet_cSymbol);
+  sym_handle = mxnet_get_handle(sym);
+
+  if (NIL_P(flags) || !MXNET_API_P(MXCreateCachedOpEx)) {
+    CHECK_CALL(MXNET_API(MXCreateCachedOp)(sym_handle, &handle));
+    DATA_PTR(obj) = handle;
+    return obj;
+  }
+
+  flags = rb_convert_type(flags, T_HASH, "Hash", "to_hash");
+  keys = rb_funcall(flags, rb_intern("keys"), 0);
+  vals = rb_funcall(flags, rb_intern("values"), 0);
+  num_flags = RARRAY_LEN(keys);
+
+  keys_str = rb_str_tmp_new(sizeof(char const *) * num_flags);
+  vals_str = rb_str_tmp_new(sizeof(char const *) * num_flags);
+  c_keys = (char const **)RSTRING_PTR(keys_str);
+  c_vals = (char const **)RSTRING_PTR(vals_str);
+  for (i = 0; i < num_flags; ++i) {
+    VALUE key = rb_String(RARRAY_AREF(keys, i));
+    VALUE val = rb_String(RARRAY_AREF(vals, i));
+    rb_ary_store(keys, i, key);
+    rb_ary_store(vals, i, val);
+    c_keys[i] = StringValueCStr(key);
+    c_vals[i] = StringValueCStr(val);
+  }
+
+  CHECK_CALL(MXNET_API(MXCreateCachedOpEx)(sym_handle, (int)num_flags, c_keys, c_vals, &handle));
+  DATA_PTR(obj) = handle;
+
+  RB_GC_GUARD(keys);
+  RB_GC_GUARD(vals);
+  RB_GC_GUARD(keys_str);
+  RB_GC_GUARD(vals_str);
+
+  return obj;
+}
+
+/* Runs the cached op.
+ *
+ * @param inputs [Array<NDArray>]  The inputs in the order of
+ *   `Symbol#list_inputs`.
+ * @param out [NDArray, Array<NDArray>, nil]  The output arrays.
+ * @return [NDArray, Array<NDArray>]
+ */
+static VALUE
+cached_op_invoke(VALUE obj, VALUE inputs, VALUE out)
+{
+  CachedOpHandle handle;
+  NDArrayHandle *input_handles, *output_handles, *out_handles = NULL;
+  VALUE inputs_str, outputs_str = Qnil, res;
+  int i, num_inputs, num_outputs = 0;
+  const int *out_stypes;
+
+  handle = cached_op_get_handle(obj);
+
+  inputs = rb_convert_type(inputs, T_ARRAY, "Array", "to_ary");
+  num_inputs = (int)RARRAY_LEN(inputs);
+  inputs_str = rb_str_tmp_new(sizeof(NDArrayHandle) * num_inputs);
+  input_handles = (NDArrayHandle *)RSTRING_PTR(inputs_str);
+  for (i = 0; i < num_inputs; ++i) {
+    input_handles[i] = mxnet_ndarray_get_handle(RARRAY_AREF(inputs, i));
+  }
+
+  if (!NIL_P(out)) {
+    if (mxnet_is_ndarray(out)) {
+      out = rb_ary_new_from_args(1, out);
+    }
+    else {
+      out = rb_convert_type(out, T_ARRAY, "Array", "to_ary");
+    }
+    num_outputs = (int)RARRAY_LEN(out);
+    outputs_str = rb_str_tmp_new(sizeof(NDArrayHandle) * num_outputs);
+    out_handles = (NDArrayHandle *)RSTRING_PTR(outputs_str);
+    for (i = 0; i < num_outputs; ++i) {
+      out_handles[i] = mxnet_ndarray_get_handle(RARRAY_AREF(out, i));
+    }
+  }
+  output_handles = out_handles;
+
+  if (MXNET_API_P(MXInvokeCachedOpEx)) {
+    CHECK_CALL(MXNET_API(MXInvokeCachedOpEx)(handle, num_inputs, input_handles,
+                                             &num_outputs, &output_handles, &out_stypes));
+  }
+  else {
+    CHECK_CALL(MXNET_API(MXInvokeCachedOp)(handle, num_inputs, input_handles,
+                                           &num_outputs, &output_handles));
+  }
+
+  RB_GC_GUARD(inputs);
+  RB_GC_GUARD(inputs_str);
+  RB_GC_GUARD(outputs_str);
+
+  if (!NIL_P(out)) {
+    return RARRAY_LEN(out) == 1 ? RARRAY_AREF(out, 0) : out;
+  }
+
+  if (num_outputs == 1) {
+    return mxnet_ndarray_new(output_handles[0]);
+  }
+  res = rb_ary_new_capa(num_outputs);
+  for (i = 0; i < num_outputs; ++i) {
+    rb_ary_push(res, mxnet_ndarray_new(output_handles[i]));
+  }
+  return res;
+}
+
+void
+mxnet_init_cached_op(void)
+{
+  VALUE cCachedOp;
+
+  cCachedOp = rb_const_get_at(mxnet_mMXNet, rb_intern("CachedOp"));
+
+  rb_define_alloc_func(cCachedOp, cached_op_allocate);
+
+  rb_define_method(cCachedOp, "initialize", cached_op_initialize, -1);
+
+  rb_define_private_method(cCachedOp, "_invoke", cached_op_invoke, 2);
+}
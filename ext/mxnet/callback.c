@@ -0,0 +1,336 @@
+#include "mxnet_internal.h"
+#include <ruby/thread.h>
+
+#include <pthread.h>
+
+/* Dispatching the callbacks from libmxnet to Ruby.
+ *
+ * libmxnet calls back the functions given by the extension, such as the
+ * custom operators, from the thread that calls its API, or from its own
+ * worker threads.  A callback is run:
+ *
+ *   - directly, on a Ruby thread holding the GVL,
+ *   - by rb_thread_call_with_gvl, on a Ruby thread that released the GVL,
+ *   - by the callback server thread, on a thread unknown to Ruby.
+ *
+ * The callback server is a Ruby thread waiting for the requests from the
+ * other threads.  The calling thread blocks until the request is done.
+ */
+
+/* Without ruby_thread_has_gvl_p, a callback on a Ruby thread could not
+ * tell whether the thread holds the GVL, and neither running it directly
+ * nor dispatching it to the server thread is safe. */
+#ifndef HAVE_RUBY_THREAD_HAS_GVL_P
+# error "ruby_thread_has_gvl_p is required to run the callbacks from libmxnet"
+#endif
+int ruby_thread_has_gvl_p(void);
+
+struct callback_request {
+  mxnet_callback_func_t func;
+  void *data;
+  void *result;
+  int done;
+  pthread_cond_t done_cond;
+  struct callback_request *next;
+};
+
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static struct callback_request *queue_head = NULL;
+static struct callback_request *queue_tail = NULL;
+static int server_interrupted = 0;
+static int server_stopped = 0;
+
+static VALUE server_thread = Qnil;
+
+static void *
+dispatch_to_server(mxnet_callback_func_t func, void *data)
+{
+  struct callback_request req;
+
+  req.func = func;
+  req.data = data;
+  req.result = NULL;
+  req.done = 0;
+  req.next = NULL;
+  pthread_cond_init(&req.done_cond, NULL);
+
+  pthread_mutex_lock(&queue_mutex);
+  if (server_stopped) {
+    pthread_mutex_unlock(&queue_mutex);
+    pthread_cond_destroy(&req.done_cond);
+    return NULL;
+  }
+  if (queue_tail) {
+    queue_tail->next = &req;
+  }
+  else {
+    queue_head = &req;
+  }
+  queue_tail = &req;
+  pthread_cond_signal(&queue_cond);
+
+  while (!req.done) {
+    pthread_cond_wait(&req.done_cond, &queue_mutex);
+  }
+  pthread_mutex_unlock(&queue_mutex);
+
+  pthread_cond_destroy(&req.done_cond);
+  return req.result;
+}
+
+void *
+mxnet_callback_invoke(mxnet_callback_func_t func, void *data)
+{
+  if (ruby_native_thread_p()) {
+    if (!ruby_thread_has_gvl_p()) {
+      return rb_thread_call_with_gvl(func, data);
+    }
+    return (*func)(data);
+  }
+
+  return dispatch_to_server(func, data);
+}
+
+static void *
+wait_for_request(void *ptr)
+{
+  struct callback_request **out = (struct callback_request **)ptr;
+
+  pthread_mutex_lock(&queue_mutex);
+  while (queue_head == NULL && !server_interrupted) {
+    pthread_cond_wait(&queue_cond, &queue_mutex);
+  }
+  if (queue_head) {
+    *out = queue_head;
+    queue_head = queue_head->next;
+    if (queue_head == NULL) {
+      queue_tail = NULL;
+    }
+  }
+  server_interrupted = 0;
+  pthread_mutex_unlock(&queue_mutex);
+
+  return NULL;
+}
+
+static void
+interrupt_server(void *ptr)
+{
+  pthread_mutex_lock(&queue_mutex);
+  server_interrupted = 1;
+  pthread_cond_broadcast(&queue_cond);
+  pthread_mutex_unlock(&queue_mutex);
+}
+
+static VALUE
+callback_server_main(void *unused)
+{
+  for (;;) {
+    struct callback_request *req = NULL;
+
+    rb_thread_call_without_gvl(wait_for_request, &req, interrupt_server, NULL);
+    if (req) {
+      void *result = (*req->func)(req->data);
+
+      pthread_mutex_lock(&queue_mutex);
+      req->result = result;
+      req->done = 1;
+      pthread_cond_signal(&req->done_cond);
+      pthread_mutex_unlock(&queue_mutex);
+    }
+    rb_thread_check_ints();
+  }
+
+  return Qnil;
+}
+
+/* Starts the callback server thread unless it is running.
+ *
+ * This must be called before giving libmxnet a callback that can be
+ * called from its worker threads.
+ */
+void
+mxnet_callback_start_server(void)
+{
+  if (!NIL_P(server_thread) && RTEST(rb_funcall(server_thread, rb_intern("alive?"), 0))) {
+    return;
+  }
+
+  server_thread = rb_thread_create(callback_server_main, NULL);
+  rb_funcall(server_thread, rb_intern("name="), 1, rb_str_new_cstr("mxnet-callback"));
+}
+
+/* Fails the queued and the later requests to the callback server, whose
+ * thread is terminated while the VM is torn down, so that the threads of
+ * libmxnet do not wait for it forever.  The failed callbacks return NULL.
+ */
+void
+mxnet_callback_stop_server(void)
+{
+  struct callback_request *req;
+
+  pthread_mutex_lock(&queue_mutex);
+  server_stopped = 1;
+  while ((req = queue_head) != NULL) {
+    queue_head = req->next;
+    req->result = NULL;
+    req->done = 1;
+    pthread_cond_signal(&req->done_cond);
+  }
+  queue_tail = NULL;
+  pthread_mutex_unlock(&queue_mutex);
+}
+
+/* ==== Live objects ==== */
+
+/* The Ruby objects referenced from libmxnet are kept in a list marked by
+ * a keeper object.  They are unlinked without the GVL, because libmxnet
+ * can delete its callbacks on its worker threads, or while an NDArray is
+ * freed by the GC.
+ */
+static struct mxnet_live_object live_objects = { Qnil, &live_objects, &live_objects };
+static pthread_mutex_t live_objects_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+live_objects_mark(void *ptr)
+{
+  struct mxnet_live_object *o;
+
+  pthread_mutex_lock(&live_objects_mutex);
+  for (o = live_objects.next; o != &live_objects; o = o->next) {
+    rb_gc_mark(o->obj);
+  }
+  pthread_mutex_unlock(&live_objects_mutex);
+}
+
+static const rb_data_type_t live_objects_data_type = {
+  "MXNet::LiveObjects",
+  {
+    live_objects_mark,
+    NULL,
+    NULL,
+  },
+  0, 0, 0
+};
+
+void
+mxnet_live_object_link(struct mxnet_live_object *o, VALUE obj)
+{
+  o->obj = obj;
+  pthread_mutex_lock(&live_objects_mutex);
+  o->prev = live_objects.prev;
+  o->next = &live_objects;
+  live_objects.prev->next = o;
+  live_objects.prev = o;
+  pthread_mutex_unlock(&live_objects_mutex);
+}
+
+void
+mxnet_live_object_unlink(struct mxnet_live_object *o)
+{
+  pthread_mutex_lock(&live_objects_mutex);
+  o->prev->next = o->next;
+  o->next->prev = o->prev;
+  pthread_mutex_unlock(&live_objects_mutex);
+}
+
+/* ==== Protected calls ==== */
+
+struct protected_call {
+  VALUE (*body)(VALUE);
+  void *args;
+  int ok;
+};
+
+static VALUE
+report_error_0(VALUE err)
+{
+  VALUE message;
+
+  message = rb_funcall(err, rb_intern("full_message"), 0);
+  rb_io_write(rb_stderr, rb_str_new_cstr("Error in the callback from libmxnet:\n"));
+  rb_io_write(rb_stderr, message);
+  return Qnil;
+}
+
+static void *
+protected_call_with_gvl(void *ptr)
+{
+  struct protected_call *call = (struct protected_call *)ptr;
+  int state = 0;
+
+  rb_protect(call->body, (VALUE)call->args, &state);
+  call->ok = !state;
+  if (state) {
+    VALUE err = rb_errinfo();
+    rb_set_errinfo(Qnil);
+    if (RTEST(rb_obj_is_kind_of(err, rb_eException))) {
+      rb_protect(report_error_0, err, &state);
+      rb_set_errinfo(Qnil);
+    }
+  }
+
+  return NULL;
+}
+
+/* Runs body with the GVL from any thread, and returns true if it does not
+ * raise.  The error is printed to $stderr, since it cannot be raised
+ * through libmxnet.
+ */
+int
+mxnet_callback_protect(VALUE (*body)(VALUE), void *args)
+{
+  struct protected_call call;
+
+  call.body = body;
+  call.args = args;
+  call.ok = 0;
+  mxnet_callback_invoke(protected_call_with_gvl, &call);
+  return call.ok;
+}
+
+/* ==== Fork ==== */
+
+/* Resets the states of the dispatcher in the child process after fork.
+ *
+ * Only the thread calling fork survives in the child, so the mutexes may
+ * be left locked by the threads of libmxnet, and the requests from them
+ * are never completed.  The server thread, which does not survive
+ * either, is restarted if it was running in the parent.
+ */
+static VALUE
+engine_s_after_fork_child(VALUE mod)
+{
+  int server_started = !NIL_P(server_thread);
+
+  pthread_mutex_init(&queue_mutex, NULL);
+  pthread_cond_init(&queue_cond, NULL);
+  queue_head = NULL;
+  queue_tail = NULL;
+  server_interrupted = 0;
+  server_thread = Qnil;
+
+  pthread_mutex_init(&live_objects_mutex, NULL);
+
+  if (server_started) {
+    mxnet_callback_start_server();
+  }
+
+  return Qnil;
+}
+
+void
+mxnet_init_callback(void)
+{
+  VALUE keeper, mEngine;
+
+  rb_gc_register_address(&server_thread);
+
+  keeper = TypedData_Wrap_Struct(rb_cObject, &live_objects_data_type, NULL);
+  rb_gc_register_mark_object(keeper);
+
+  mEngine = rb_define_module_under(mxnet_mMXNet, "Engine");
+  rb_define_singleton_method(mEngine, "_after_fork_child", engine_s_after_fork_child, 0);
+  rb_funcall(mEngine, rb_intern("private_class_method"), 1, ID2SYM(rb_intern("_after_fork_child")));
+}
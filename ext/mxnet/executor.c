@@ -63,6 +63,24 @@ executor_outputs(VALUE obj)
   return res;
 }
 
+/* Returns the description of the executor printed by libmxnet, with the
+ * operators, their inputs and attributes, and the memory allocated for
+ * the execution plan.
+ *
+ * @return [String]
+ */
+static VALUE
+executor_debug_str(VALUE obj)
+{
+  ExecutorHandle handle;
+  char const *str;
+
+  handle = mxnet_get_handle(obj);
+  CHECK_CALL(MXNET_API(MXExecutorPrint)(handle, &str));
+
+  return rb_str_new_cstr(str);
+}
+
 struct process_kwargs_params {
   VALUE arg_dict;
 };
@@ -201,6 +219,161 @@ executor_backward(int argc, VALUE *argv, VALUE obj)
   return Qnil;
 }
 
+/* ==== Monitor callback ==== */
+
+/* The state of the monitor callback given to libmxnet, which is kept by
+ * the executor in @monitor_callback.
+ *
+ * libmxnet copies every array of the executor for the callback, even if
+ * it is not monitored.  While the callback is disabled, the copies are
+ * freed without the GVL and without creating Ruby objects.
+ */
+struct monitor_callback {
+  VALUE callable;
+  volatile int enabled;
+};
+
+static void
+monitor_callback_mark(void *ptr)
+{
+  struct monitor_callback *mon = (struct monitor_callback *)ptr;
+  rb_gc_mark(mon->callable);
+}
+
+static size_t
+monitor_callback_memsize(void const *ptr)
+{
+  return sizeof(struct monitor_callback);
+}
+
+static const rb_data_type_t monitor_callback_data_type = {
+  "MXNet::Executor::MonitorCallback",
+  {
+    monitor_callback_mark,
+    RUBY_TYPED_DEFAULT_FREE,
+    monitor_callback_memsize,
+  },
+  0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE cMonitorCallback;
+
+static struct monitor_callback *
+executor_get_monitor_callback(VALUE obj)
+{
+  VALUE mon_obj = rb_ivar_get(obj, rb_intern("@monitor_callback"));
+  if (NIL_P(mon_obj)) {
+    return NULL;
+  }
+  return (struct monitor_callback *)rb_check_typeddata(mon_obj, &monitor_callback_data_type);
+}
+
+struct monitor_callback_args {
+  struct monitor_callback *mon;
+  char const *name;
+  NDArrayHandle handle;
+};
+
+static VALUE
+monitor_callback_body(VALUE ptr)
+{
+  struct monitor_callback_args *args = (struct monitor_callback_args *)ptr;
+  VALUE name, array;
+
+  /* The NDArray given to the callback is owned by the callee. */
+  array = mxnet_ndarray_new(args->handle);
+  name = rb_str_new_cstr(args->name);
+  rb_funcall(args->mon->callable, rb_intern("call"), 2, name, array);
+  return Qnil;
+}
+
+static void
+monitor_callback_func(char const *name, NDArrayHandle handle, void *data)
+{
+  struct monitor_callback_args args;
+
+  args.mon = (struct monitor_callback *)data;
+  if (!args.mon->enabled) {
+    MXNET_API(MXNDArrayFree)(handle);
+    return;
+  }
+  args.name = name;
+  args.handle = handle;
+  mxnet_callback_protect(monitor_callback_body, &args);
+}
+
+/* Sets the callback called with the name and the copy of each output of
+ * the operators in the forward and the backward.
+ *
+ * @param callable [#call]  Called with the name and the NDArray.
+ * @param monitor_all [true, false]  Whether to monitor the inputs of the
+ *   operators in addition to the outputs.
+ * @return [nil]
+ */
+static VALUE
+executor_set_monitor_callback(VALUE obj, VALUE callable, VALUE monitor_all)
+{
+  ExecutorHandle handle;
+  struct monitor_callback *mon;
+  VALUE mon_obj;
+
+  if (RTEST(monitor_all)) {
+    MXNET_API_CHECK(MXExecutorSetMonitorCallbackEX);
+  }
+  else if (!MXNET_API_P(MXExecutorSetMonitorCallbackEX)) {
+    MXNET_API_CHECK(MXExecutorSetMonitorCallback);
+  }
+
+  handle = mxnet_get_handle(obj);
+
+  mon_obj = TypedData_Make_Struct(cMonitorCallback, struct monitor_callback,
+                                  &monitor_callback_data_type, mon);
+  mon->callable = callable;
+  mon->enabled = 1;
+
+  mxnet_callback_start_server();
+
+  if (MXNET_API_P(MXExecutorSetMonitorCallbackEX)) {
+    CHECK_CALL(MXNET_API(MXExecutorSetMonitorCallbackEX)(
+          handle, monitor_callback_func, mon, RTEST(monitor_all)));
+  }
+  else {
+    CHECK_CALL(MXNET_API(MXExecutorSetMonitorCallback)(
+          handle, monitor_callback_func, mon));
+  }
+
+  /* The previous callback is no longer called by libmxnet. */
+  rb_ivar_set(obj, rb_intern("@monitor_callback"), mon_obj);
+
+  return Qnil;
+}
+
+/* Whether the monitor callback is called.
+ *
+ * @return [true, false]
+ */
+static VALUE
+executor_is_monitor_enabled(VALUE obj)
+{
+  struct monitor_callback *mon = executor_get_monitor_callback(obj);
+  return (mon != NULL && mon->enabled) ? Qtrue : Qfalse;
+}
+
+/* Enables or disables the monitor callback.
+ *
+ * @param enabled [true, false]
+ */
+static VALUE
+executor_set_monitor_enabled(VALUE obj, VALUE enabled)
+{
+  struct monitor_callback *mon = executor_get_monitor_callback(obj);
+  if (mon == NULL) {
+    rb_raise(mxnet_eError, "monitor callback is not set");
+  }
+  mon->enabled = RTEST(enabled);
+  return enabled;
+}
+
 void
 mxnet_init_executor(void)
 {
@@ -210,8 +383,16 @@ mxnet_init_executor(void)
 
   rb_define_method(cExecutor, "forward", executor_forward, -1);
   rb_define_method(cExecutor, "backward", executor_backward, -1);
+  rb_define_method(cExecutor, "debug_str", executor_debug_str, 0);
+
+  rb_define_method(cExecutor, "monitor_enabled?", executor_is_monitor_enabled, 0);
+  rb_define_method(cExecutor, "monitor_enabled=", executor_set_monitor_enabled, 1);
 
   rb_define_private_method(cExecutor, "get_outputs", executor_outputs, 0);
+  rb_define_private_method(cExecutor, "_set_monitor_callback", executor_set_monitor_callback, 2);
+
+  cMonitorCallback = rb_define_class_under(cExecutor, "MonitorCallback", rb_cObject);
+  rb_undef_alloc_func(cMonitorCallback);
 
   mxnet_cExecutor = cExecutor;
 }
@@ -9,4 +9,14 @@ have_type('int16_t', headers)
 have_type('int32_t', headers)
 have_type('int64_t', headers)
 
+have_func('rb_ext_ractor_safe', 'ruby.h')
+have_header('ruby/ractor.h')
+have_func('rb_ractor_make_shareable', 'ruby.h')
+# not declared in the public headers, but exported by libruby
+have_func('ruby_thread_has_gvl_p')
+
+if try_compile("static __thread int x;\nint main(void) { return x; }")
+  $defs << '-DHAVE_THREAD_LOCAL_STORAGE'
+end
+
 create_makefile('mxnet')
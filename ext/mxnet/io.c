@@ -18,8 +18,9 @@ typedef struct {
 static void
 data_iter_free(void *ptr)
 {
-  if (ptr != NULL) {
-    CHECK_CALL(MXNET_API(MXDataIterFree)((DataIterHandle)ptr));
+  /* A finalizer must not raise, so the error is ignored. */
+  if (ptr != NULL && !mxnet_is_shutdown()) {
+    MXNET_API(MXDataIterFree)((DataIterHandle)ptr);
   }
 }
 
@@ -47,14 +47,27 @@ init_api_table(VALUE handle)
     ((api_table).member_name) = fptr; \
   } while (0)
 #define INIT_API_TABLE_ENTRY(api_name) INIT_API_TABLE_ENTRY2(api_name, api_name)
+/* The APIs only in the newer versions of libmxnet are left NULL when
+ * missing, and checked by MXNET_API_CHECK at their use. */
+#define INIT_OPTIONAL_API_TABLE_ENTRY(api_name) \
+  ((api_table).api_name = LOOKUP_API_ENTRY(api_name))
 
   INIT_API_TABLE_ENTRY(MXGetLastError);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXNotifyShutdown);
   INIT_API_TABLE_ENTRY(MXRandomSeed);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXRandomSeedContext);
+
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXStorageEmptyCache);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXGetGPUCount);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXGetGPUMemoryInformation64);
 
   INIT_API_TABLE_ENTRY(MXExecutorOutputs);
   INIT_API_TABLE_ENTRY(MXExecutorForward);
   INIT_API_TABLE_ENTRY(MXExecutorBackwardEx);
   INIT_API_TABLE_ENTRY(MXExecutorBindEX);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXExecutorSetMonitorCallback);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXExecutorSetMonitorCallbackEX);
+  INIT_API_TABLE_ENTRY(MXExecutorPrint);
 
   INIT_API_TABLE_ENTRY(MXNDArrayCreateEx);
   INIT_API_TABLE_ENTRY(MXNDArrayFree);
@@ -70,7 +83,15 @@ init_api_table(VALUE handle)
   INIT_API_TABLE_ENTRY(MXNDArrayAt);
   INIT_API_TABLE_ENTRY(MXNDArraySlice);
   INIT_API_TABLE_ENTRY(MXNDArrayGetGrad);
+  INIT_API_TABLE_ENTRY(MXNDArrayGetData);
   INIT_API_TABLE_ENTRY(MXNDArrayWaitToRead);
+  INIT_API_TABLE_ENTRY(MXNDArrayWaitToWrite);
+  INIT_API_TABLE_ENTRY(MXNDArrayWaitAll);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXNDArrayFromDLPackEx);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXNDArrayGetSharedMemHandle);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXNDArrayCreateFromSharedMem);
+
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXEnginePushSyncND);
 
   INIT_API_TABLE_ENTRY(MXAutogradSetIsRecording);
   INIT_API_TABLE_ENTRY(MXAutogradSetIsTraining);
@@ -78,6 +99,16 @@ init_api_table(VALUE handle)
   INIT_API_TABLE_ENTRY(MXAutogradIsTraining);
   INIT_API_TABLE_ENTRY(MXAutogradMarkVariables);
   INIT_API_TABLE_ENTRY(MXAutogradBackwardEx);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXAutogradGetSymbol);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXCustomFunctionRecord);
+
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXCreateCachedOp);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXCreateCachedOpEx);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXFreeCachedOp);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXInvokeCachedOp);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXInvokeCachedOpEx);
+
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXCustomOpRegister);
 
   INIT_API_TABLE_ENTRY(MXListAllOpNames);
   INIT_API_TABLE_ENTRY(NNGetOpHandle);
@@ -101,11 +132,15 @@ init_api_table(VALUE handle)
   INIT_API_TABLE_ENTRY(NNSymbolCompose);
   INIT_API_TABLE_ENTRY(MXSymbolCopy);
   INIT_API_TABLE_ENTRY(MXSymbolCreateVariable);
+  INIT_API_TABLE_ENTRY(MXSymbolCreateGroup);
+  INIT_API_TABLE_ENTRY(MXSymbolGetOutput);
+  INIT_API_TABLE_ENTRY(MXSymbolGetInternals);
   INIT_API_TABLE_ENTRY(MXSymbolGetName);
   INIT_API_TABLE_ENTRY(MXSymbolGetAttr);
   INIT_API_TABLE_ENTRY(MXSymbolSetAttr);
   INIT_API_TABLE_ENTRY(MXSymbolListAttr);
   INIT_API_TABLE_ENTRY(MXSymbolListArguments);
+  INIT_OPTIONAL_API_TABLE_ENTRY(NNSymbolListInputNames);
   INIT_API_TABLE_ENTRY(MXSymbolListAuxiliaryStates);
   INIT_API_TABLE_ENTRY(MXSymbolListOutputs);
   INIT_API_TABLE_ENTRY(MXSymbolInferShape);
@@ -113,10 +148,65 @@ init_api_table(VALUE handle)
   INIT_API_TABLE_ENTRY(MXSymbolInferType);
   INIT_API_TABLE_ENTRY(MXSymbolSaveToFile);
   INIT_API_TABLE_ENTRY(MXSymbolSaveToJSON);
+
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXPredCreate);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXPredReshape);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXPredGetOutputShape);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXPredSetInput);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXPredForward);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXPredGetOutput);
+  INIT_OPTIONAL_API_TABLE_ENTRY(MXPredFree);
+}
+
+void
+mxnet_raise_api_not_found(char const *api_name)
+{
+  rb_raise(mxnet_eAPINotFound, "%s is not available in the loaded libmxnet", api_name);
+}
+
+static int
+has_placeholder(VALUE arrays)
+{
+  long i;
+
+  if (NIL_P(arrays)) {
+    return 0;
+  }
+  if (RTEST(rb_obj_is_kind_of(arrays, mxnet_cNDArray))) {
+    return mxnet_ndarray_peek_handle(arrays) == NULL;
+  }
+  for (i = 0; i < RARRAY_LEN(arrays); ++i) {
+    VALUE v = RARRAY_AREF(arrays, i);
+    if (RTEST(rb_obj_is_kind_of(v, mxnet_cNDArray)) && mxnet_ndarray_peek_handle(v) == NULL) {
+      return 1;
+    }
+  }
+  return 0;
 }
 
+/* Records the operation with the placeholder arrays, which have no
+ * handle, by `MXNet::Tracer.record_op` instead of invoking it. */
 static VALUE
-imperative_invoke(VALUE mod, VALUE handle, VALUE ndargs, VALUE keys, VALUE vals, VALUE out)
+record_op(VALUE handle, VALUE ndargs, VALUE keys, VALUE vals, VALUE out)
+{
+  VALUE tracer = rb_const_get_at(mxnet_mMXNet, rb_intern("Tracer"));
+  return rb_funcall(tracer, rb_intern("record_op"), 5, handle, ndargs, keys, vals, out);
+}
+
+/* The number of the active hooks, such as `NDArray.lazy`, which record
+ * all the operations by `MXNet::Tracer.record_op`.  It is counted for each
+ * native thread, so the operations of the other threads and Ractors stay
+ * in the fast path.  The fibers of the thread share the count, and the
+ * hooks check their own fiber-local state.
+ */
+#ifdef HAVE_THREAD_LOCAL_STORAGE
+static __thread long op_hook_count = 0;
+#else
+static long op_hook_count = 0;
+#endif
+
+static VALUE
+invoke_op(VALUE handle, VALUE ndargs, VALUE keys, VALUE vals, VALUE out, int hooked)
 {
   VALUE inputs_str, outputs_str, keys_str, vals_str;
   int i;
@@ -124,6 +214,10 @@ imperative_invoke(VALUE mod, VALUE handle, VALUE ndargs, VALUE keys, VALUE vals,
   void **inputs, **outputs = NULL;
   char const **params_keys, **params_vals;
 
+  if (hooked && op_hook_count > 0) {
+    return record_op(handle, ndargs, keys, vals, out);
+  }
+
   ndargs = rb_convert_type(ndargs, T_ARRAY, "Array", "to_ary");
   keys = rb_convert_type(keys, T_ARRAY, "Array", "to_ary");
   vals = rb_convert_type(vals, T_ARRAY, "Array", "to_ary");
@@ -135,7 +229,17 @@ imperative_invoke(VALUE mod, VALUE handle, VALUE ndargs, VALUE keys, VALUE vals,
   inputs_str = rb_str_tmp_new(sizeof(void *)*num_inputs);
   inputs = (void **)RSTRING_PTR(inputs_str);
   for (i = 0; i < num_inputs; ++i) {
-    inputs[i] = mxnet_ndarray_get_handle(RARRAY_AREF(ndargs, i));
+    if (!hooked) {
+      inputs[i] = mxnet_ndarray_get_handle(RARRAY_AREF(ndargs, i));
+      continue;
+    }
+    inputs[i] = mxnet_ndarray_peek_handle(RARRAY_AREF(ndargs, i));
+    if (inputs[i] == NULL) {
+      return record_op(handle, ndargs, keys, vals, out);
+    }
+  }
+  if (hooked && has_placeholder(out)) {
+    return record_op(handle, ndargs, keys, vals, out);
   }
 
   num_params = (int)RARRAY_LEN(keys);
@@ -198,6 +302,36 @@ imperative_invoke(VALUE mod, VALUE handle, VALUE ndargs, VALUE keys, VALUE vals,
   return out;
 }
 
+static VALUE
+imperative_invoke(VALUE mod, VALUE handle, VALUE ndargs, VALUE keys, VALUE vals, VALUE out)
+{
+  return invoke_op(handle, ndargs, keys, vals, out, 1);
+}
+
+/* Invokes the operation without recording it, after materializing the
+ * placeholder arrays in the arguments. */
+static VALUE
+imperative_invoke_now(VALUE mod, VALUE handle, VALUE ndargs, VALUE keys, VALUE vals, VALUE out)
+{
+  return invoke_op(handle, ndargs, keys, vals, out, 0);
+}
+
+/* Enables or disables a hook recording all the operations.
+ *
+ * @param enable [true, false]
+ */
+static VALUE
+hook_ops(VALUE mod, VALUE enable)
+{
+  if (RTEST(enable)) {
+    ++op_hook_count;
+  }
+  else if (op_hook_count > 0) {
+    --op_hook_count;
+  }
+  return Qnil;
+}
+
 struct collect_sym_args_params {
   int cursor;
   int num_sym_args;
@@ -255,7 +389,7 @@ symbol_creator(VALUE mod, VALUE handle, VALUE args, VALUE kwargs, VALUE keys, VA
         params_vals,
         &sym_handle));
 
-  if (!NIL_P(args) && !NIL_P(kwargs)) {
+  if (!NIL_P(args) && !NIL_P(kwargs) && RHASH_SIZE(kwargs) > 0) {
     rb_raise(rb_eTypeError,
         "Operators with variable length input can only accept input "
         "Symbols either as positional or keyword arguments, not both");
@@ -267,7 +401,7 @@ symbol_creator(VALUE mod, VALUE handle, VALUE args, VALUE kwargs, VALUE keys, VA
     sym_args_str = rb_str_tmp_new(sizeof(void *)*num_sym_args);
     sym_args = (void **)RSTRING_PTR(sym_args_str);
     for (i = 0; i < num_sym_args; ++i) {
-      sym_args[i] = NUM2PTR(RARRAY_AREF(args, i));
+      sym_args[i] = mxnet_get_handle(RARRAY_AREF(args, i));
     }
   }
   else if (!NIL_P(kwargs)) {
@@ -327,6 +461,8 @@ mxnet_init_libmxnet(void)
   mxnet_eAPINotFound = rb_define_class_under(mxnet_mMXNet, "APINotFound", mxnet_eError);
   handle = rb_funcallv(mxnet_mLibMXNet, rb_intern("handle"), 0, 0);
   rb_define_module_function(mxnet_mLibMXNet, "imperative_invoke", imperative_invoke, 5);
+  rb_define_module_function(mxnet_mLibMXNet, "_imperative_invoke_now", imperative_invoke_now, 5);
+  rb_define_module_function(mxnet_mLibMXNet, "_hook_ops", hook_ops, 1);
   rb_define_module_function(mxnet_mLibMXNet, "symbol_creator", symbol_creator, 6);
   rb_define_module_function(mxnet_mLibMXNet, "create_variable", create_variable, 1);
   init_api_table(handle);
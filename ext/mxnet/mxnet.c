@@ -1,4 +1,5 @@
 #include "mxnet_internal.h"
+#include <ruby/thread.h>
 
 VALUE mxnet_mMXNet;
 VALUE mxnet_mUtils;
@@ -101,7 +102,78 @@ init_grad_req_map(void)
   rb_hash_aset(map, ID2SYM(rb_intern("write")), INT2FIX(1));
   rb_hash_aset(map, ID2SYM(rb_intern("add")),   INT2FIX(3));
 
-  rb_ivar_set(mxnet_mMXNet, rb_intern("GRAD_REQ_MAP"), map);
+  /* shareable to be read from the non-main Ractors */
+  rb_ivar_set(mxnet_mMXNet, rb_intern("GRAD_REQ_MAP"), mxnet_make_shareable(map));
+}
+
+/* ==== Shutdown ==== */
+
+static volatile int shutdown_p = 0;
+
+/* Returns true after libmxnet is shut down while the VM is torn down.
+ * The handles must not be freed after that, because the engine is
+ * stopped. */
+int
+mxnet_is_shutdown(void)
+{
+  return shutdown_p;
+}
+
+static void *
+wait_all_without_gvl(void *unused)
+{
+  MXNET_API(MXNDArrayWaitAll)();
+  return NULL;
+}
+
+/* Waits at exit for the pending computations, while the callback server
+ * is still running for the custom operators implemented in Ruby.
+ *
+ * libmxnet is not shut down here, because the end procs registered
+ * before requiring mxnet, such as the one of minitest/autorun, run after
+ * this and can still use it.
+ */
+static void
+mxnet_wait_at_exit(VALUE unused)
+{
+  if (shutdown_p) return;
+  rb_thread_call_without_gvl(wait_all_without_gvl, NULL, NULL, NULL);
+}
+
+/* Shuts down libmxnet while the VM is torn down, after all the end procs
+ * and before the remaining objects are freed.  It is called by the
+ * finalizer of an object that is never collected, because the finalizers
+ * run before the objects are freed at exit.
+ *
+ * The Ruby threads, including the callback server, are terminated by
+ * then, so the callbacks from libmxnet fail instead of waiting for them.
+ * The handles freed after this are left to the exit of the process, so
+ * that the finalizers neither wait for the engine nor call libmxnet for
+ * each object.
+ */
+static VALUE
+mxnet_shutdown(RB_BLOCK_CALL_FUNC_ARGLIST(yielded_arg, callback_arg))
+{
+  if (shutdown_p) return Qnil;
+  mxnet_callback_stop_server();
+  MXNET_API(MXNDArrayWaitAll)();
+  if (MXNET_API_P(MXNotifyShutdown)) {
+    MXNET_API(MXNotifyShutdown)();
+  }
+  shutdown_p = 1;
+  return Qnil;
+}
+
+static void
+init_shutdown(void)
+{
+  VALUE keeper;
+
+  rb_set_end_proc(mxnet_wait_at_exit, Qnil);
+
+  keeper = rb_obj_alloc(rb_cObject);
+  rb_gc_register_mark_object(keeper);
+  rb_define_finalizer(keeper, rb_proc_new(mxnet_shutdown, Qnil));
 }
 
 void
@@ -109,6 +181,10 @@ Init_mxnet(void)
 {
   VALUE mHandleWrapper;
 
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+  rb_ext_ractor_safe(true);
+#endif
+
   mxnet_mMXNet = rb_define_module("MXNet");
   mxnet_mUtils = rb_const_get_at(mxnet_mMXNet, rb_intern("Utils"));
   mxnet_cContext = rb_const_get_at(mxnet_mMXNet, rb_intern("Context"));
@@ -120,9 +196,12 @@ Init_mxnet(void)
 
   init_grad_req_map();
   mxnet_init_libmxnet();
+  mxnet_init_callback();
 
   mxnet_init_autograd();
 
+  mxnet_init_cached_op();
+
   mxnet_init_executor();
 
   mxnet_init_io();
@@ -133,6 +212,13 @@ Init_mxnet(void)
   mxnet_init_symbol();
   mxnet_init_operations(mxnet_cSymbol);
 
+  mxnet_init_operator();
+
+  mxnet_init_predictor();
+
   mxnet_init_random();
+  mxnet_init_storage();
   mxnet_init_utils();
+
+  init_shutdown();
 }
@@ -9,6 +9,9 @@ extern "C" {
 #endif
 
 #include <ruby.h>
+#ifdef HAVE_RUBY_RACTOR_H
+# include <ruby/ractor.h>
+#endif
 
 /* Defined only in ruby 2.4.0+. Redefine here for Ruby 2.x backward compatibility */
 #ifndef RB_INTEGER_TYPE_P
@@ -77,6 +80,63 @@ typedef void *DataIterCreator;
 typedef void *DataIterHandle;
 typedef void *NDArrayHandle;
 typedef void *SymbolHandle;
+typedef void *CachedOpHandle;
+typedef void *PredictorHandle;
+typedef void (*ExecutorMonitorCallback)(const char *, NDArrayHandle, void *);
+typedef void const *ContextHandle;
+typedef void const *EngineFnPropertyHandle;
+typedef void (*EngineSyncFunc)(void *rctx, void *param);
+typedef void (*EngineFuncParamDeleter)(void *param);
+
+/* The callbacks of the custom operators. */
+struct MXCallbackList {
+  int num_callbacks;
+  int (**callbacks)(void);
+  void **contexts;
+};
+
+typedef int (*CustomOpPropCreator)(const char *op_type, const int num_kwargs,
+                                   const char **keys, const char **values,
+                                   struct MXCallbackList *ret);
+
+/* The subset of DLPack (v0.x, as bundled in MXNet 1.x) used to wrap
+ * external memory in NDArrays. */
+typedef enum {
+  kDLCPU = 1
+} DLDeviceType;
+
+typedef enum {
+  kDLInt = 0,
+  kDLUInt = 1,
+  kDLFloat = 2
+} DLDataTypeCode;
+
+typedef struct {
+  int device_type;
+  int device_id;
+} DLContext;
+
+typedef struct {
+  uint8_t code;
+  uint8_t bits;
+  uint16_t lanes;
+} DLDataType;
+
+typedef struct {
+  void *data;
+  DLContext ctx;
+  int ndim;
+  DLDataType dtype;
+  int64_t *shape;
+  int64_t *strides;
+  uint64_t byte_offset;
+} DLTensor;
+
+typedef struct DLManagedTensor {
+  DLTensor dl_tensor;
+  void *manager_ctx;
+  void (*deleter)(struct DLManagedTensor *self);
+} DLManagedTensor;
 
 #define NUM2MXUINT(num) NUM2UINT(num)
 #define MXUINT2NUM(val) UINT2NUM(val)
@@ -94,8 +154,14 @@ enum DTypeID {
 
 struct mxnet_api_table {
   const char * (* MXGetLastError)();
+  int (* MXNotifyShutdown)(void);
 
   int (* MXRandomSeed)(int seed);
+  int (* MXRandomSeedContext)(int seed, int dev_type, int dev_id);
+
+  int (* MXStorageEmptyCache)(int dev_type, int dev_id);
+  int (* MXGetGPUCount)(int *out);
+  int (* MXGetGPUMemoryInformation64)(int dev, uint64_t *free_mem, uint64_t *total_mem);
 
   int (* MXExecutorOutputs)(ExecutorHandle handle,
                             mx_uint *out_size,
@@ -120,6 +186,14 @@ struct mxnet_api_table {
                            NDArrayHandle *aux_states,
                            ExecutorHandle shared_exec,
                            ExecutorHandle *out);
+  int (* MXExecutorSetMonitorCallback)(ExecutorHandle handle,
+                                       ExecutorMonitorCallback callback,
+                                       void *callback_handle);
+  int (* MXExecutorSetMonitorCallbackEX)(ExecutorHandle handle,
+                                         ExecutorMonitorCallback callback,
+                                         void *callback_handle,
+                                         bool monitor_all);
+  int (* MXExecutorPrint)(ExecutorHandle handle, const char **out_str);
 
   int (* MXNDArrayCreateEx)(const mx_uint *shape, mx_uint ndim,
                             int dev_type, int dev_id, int delay_alloc,
@@ -144,7 +218,23 @@ struct mxnet_api_table {
   int (* MXNDArrayAt)(NDArrayHandle handle, mx_uint idx, NDArrayHandle *out);
   int (* MXNDArraySlice)(NDArrayHandle handle, mx_uint start, mx_uint stop, NDArrayHandle *out);
   int (* MXNDArrayGetGrad)(NDArrayHandle handle, NDArrayHandle *out);
+  int (* MXNDArrayGetData)(NDArrayHandle handle, void **out_pdata);
   int (* MXNDArrayWaitToRead)(NDArrayHandle handle);
+  int (* MXNDArrayWaitToWrite)(NDArrayHandle handle);
+  int (* MXNDArrayWaitAll)(void);
+  int (* MXNDArrayFromDLPackEx)(DLManagedTensor *dlpack, bool transient_handle,
+                                NDArrayHandle *out_handle);
+  int (* MXNDArrayGetSharedMemHandle)(NDArrayHandle handle, int *shared_pid, int *shared_id);
+  int (* MXNDArrayCreateFromSharedMem)(int shared_pid, int shared_id, mx_uint const *shape,
+                                       mx_uint ndim, int dtype, NDArrayHandle *out);
+
+  int (* MXEnginePushSyncND)(EngineSyncFunc sync_func, void *func_param,
+                             EngineFuncParamDeleter deleter,
+                             ContextHandle ctx_handle,
+                             NDArrayHandle *const_nds_handle, int num_const_nds,
+                             NDArrayHandle *mutable_nds_handle, int num_mutable_nds,
+                             EngineFnPropertyHandle prop_handle, int priority,
+                             const char *opr_name);
 
   int (* MXAutogradSetIsRecording)(int is_recording, int* prev);
   int (* MXAutogradSetIsTraining)(int is_training, int* prev);
@@ -164,6 +254,23 @@ struct mxnet_api_table {
                                int is_train,
                                NDArrayHandle **grad_handles,
                                int **grad_stypes);
+  int (* MXAutogradGetSymbol)(NDArrayHandle handle, SymbolHandle *out);
+  int (* MXCustomFunctionRecord)(int num_inputs, NDArrayHandle *inputs,
+                                 int num_outputs, NDArrayHandle *outputs,
+                                 struct MXCallbackList *callbacks);
+
+  int (* MXCreateCachedOp)(SymbolHandle handle, CachedOpHandle *out);
+  int (* MXCreateCachedOpEx)(SymbolHandle handle, int num_flags,
+                             const char **keys, const char **vals,
+                             CachedOpHandle *out);
+  int (* MXFreeCachedOp)(CachedOpHandle handle);
+  int (* MXInvokeCachedOp)(CachedOpHandle handle, int num_inputs, NDArrayHandle *inputs,
+                           int *num_outputs, NDArrayHandle **outputs);
+  int (* MXInvokeCachedOpEx)(CachedOpHandle handle, int num_inputs, NDArrayHandle *inputs,
+                             int *num_outputs, NDArrayHandle **outputs,
+                             const int **out_stypes);
+
+  int (* MXCustomOpRegister)(const char *op_type, CustomOpPropCreator creator);
 
   int (* MXListAllOpNames)(mx_uint *out_size, const char ***out_array);
   int (* NNGetOpHandle)(char const *name, void **p_handle);
@@ -223,6 +330,9 @@ struct mxnet_api_table {
                           void **args);
   int (* MXSymbolCopy)(SymbolHandle symbol, SymbolHandle *out);
   int (* MXSymbolCreateVariable)(const char *name, void **out);
+  int (* MXSymbolCreateGroup)(mx_uint num_symbols, SymbolHandle *symbols, SymbolHandle *out);
+  int (* MXSymbolGetOutput)(SymbolHandle symbol, mx_uint index, SymbolHandle *out);
+  int (* MXSymbolGetInternals)(SymbolHandle symbol, SymbolHandle *out);
   int (* MXSymbolGetName)(SymbolHandle symbol,
                           const char** out,
                           int *success);
@@ -245,6 +355,10 @@ struct mxnet_api_table {
   int (* MXSymbolListOutputs)(SymbolHandle symbol,
                               mx_uint *out_size,
                               const char ***out_str_array);
+  int (* NNSymbolListInputNames)(SymbolHandle symbol,
+                                 int option,
+                                 mx_uint *out_size,
+                                 const char ***out_str_array);
   int (* MXSymbolInferShape)(SymbolHandle sym,
                              mx_uint num_args,
                              const char** keys,
@@ -288,10 +402,46 @@ struct mxnet_api_table {
                             int *complete);
   int (* MXSymbolSaveToFile)(SymbolHandle symbol, const char *fname);
   int (* MXSymbolSaveToJSON)(SymbolHandle symbol, const char **out_json);
+
+  int (* MXPredCreate)(const char *symbol_json_str,
+                       const void *param_bytes,
+                       int param_size,
+                       int dev_type, int dev_id,
+                       mx_uint num_input_nodes,
+                       const char **input_keys,
+                       const mx_uint *input_shape_indptr,
+                       const mx_uint *input_shape_data,
+                       PredictorHandle *out);
+  int (* MXPredReshape)(mx_uint num_input_nodes,
+                        const char **input_keys,
+                        const mx_uint *input_shape_indptr,
+                        const mx_uint *input_shape_data,
+                        PredictorHandle handle,
+                        PredictorHandle *out);
+  int (* MXPredGetOutputShape)(PredictorHandle handle,
+                               mx_uint index,
+                               mx_uint **shape_data,
+                               mx_uint *shape_ndim);
+  int (* MXPredSetInput)(PredictorHandle handle,
+                         const char *key,
+                         const mx_float *data,
+                         mx_uint size);
+  int (* MXPredForward)(PredictorHandle handle);
+  int (* MXPredGetOutput)(PredictorHandle handle,
+                          mx_uint index,
+                          mx_float *data,
+                          mx_uint size);
+  int (* MXPredFree)(PredictorHandle handle);
 };
 
 struct mxnet_api_table *mxnet_get_api_table(void);
 #define MXNET_API(name) (mxnet_get_api_table()->name)
+#define MXNET_API_P(name) (MXNET_API(name) != NULL)
+#define MXNET_API_CHECK(name) do { \
+    if (!MXNET_API_P(name)) mxnet_raise_api_not_found(#name); \
+  } while (0)
+
+NORETURN(void mxnet_raise_api_not_found(char const *api_name));
 
 int mxnet_context_get_device_type_id(VALUE ctx);
 int mxnet_context_get_device_id(VALUE ctx);
@@ -305,6 +455,8 @@ VALUE mxnet_dtype_name(VALUE id_or_name);
 
 VALUE mxnet_grad_req_map(void);
 
+int mxnet_is_shutdown(void);
+
 VALUE mxnet_executor_new(ExecutorHandle executor_handle, VALUE symbol, VALUE ctx, VALUE grad_req, VALUE group2ctx);
 void mxnet_executor_set_arg_arrays(VALUE obj, VALUE args);
 void mxnet_executor_set_grad_arrays(VALUE obj, VALUE args_grad);
@@ -312,20 +464,50 @@ void mxnet_executor_set_aux_arrays(VALUE obj, VALUE aux_states);
 
 void mxnet_check_type(VALUE obj, VALUE klass);
 
+/* Calls func with the GVL from any thread, including the threads of
+ * libmxnet.  func must not raise. */
+typedef void *(*mxnet_callback_func_t)(void *data);
+void *mxnet_callback_invoke(mxnet_callback_func_t func, void *data);
+void mxnet_callback_start_server(void);
+void mxnet_callback_stop_server(void);
+int mxnet_callback_protect(VALUE (*body)(VALUE), void *args);
+
+/* A Ruby object referenced from libmxnet, kept alive until unlinked. */
+struct mxnet_live_object {
+  VALUE obj;
+  struct mxnet_live_object *prev;
+  struct mxnet_live_object *next;
+};
+
+void mxnet_live_object_link(struct mxnet_live_object *o, VALUE obj);
+void mxnet_live_object_unlink(struct mxnet_live_object *o);
+
 VALUE mxnet_ndarray_new(NDArrayHandle ndarray_handle);
 NDArrayHandle mxnet_ndarray_get_handle(VALUE obj);
+NDArrayHandle mxnet_ndarray_peek_handle(VALUE obj);
+void mxnet_ndarray_wait_to_read(NDArrayHandle handle);
+void mxnet_ndarray_wait_to_write(NDArrayHandle handle);
 VALUE mxnet_ndarray_get_shape(VALUE obj);
 
+PredictorHandle mxnet_predictor_get_handle(VALUE obj);
+void mxnet_predictor_set_input(VALUE obj, VALUE key, void const *data, size_t size);
+void mxnet_predictor_get_output(VALUE obj, mx_uint index, void *data, size_t size);
+
 VALUE mxnet_symbol_new(SymbolHandle mxsymbol_handle);
 VALUE mxnet_symbol_list_outputs(VALUE obj);
 
 void mxnet_init_libmxnet(void);
 void mxnet_init_autograd(void);
+void mxnet_init_cached_op(void);
+void mxnet_init_callback(void);
 void mxnet_init_executor(void);
 void mxnet_init_io(void);
 void mxnet_init_ndarray(void);
+void mxnet_init_storage(void);
 void mxnet_init_symbol(void);
 void mxnet_init_operations(VALUE klass);
+void mxnet_init_operator(void);
+void mxnet_init_predictor(void);
 void mxnet_init_random(void);
 void mxnet_init_utils(void);
 
@@ -338,12 +520,25 @@ extern VALUE mxnet_cContext;
 extern VALUE mxnet_cExecutor;
 extern VALUE mxnet_cMXDataIter;
 extern VALUE mxnet_cNDArray;
+extern VALUE mxnet_cPredictor;
 extern VALUE mxnet_cSymbol;
 
 extern VALUE mxnet_sOpInfo;
 extern VALUE mxnet_sOpArgInfo;
 
 extern VALUE mxnet_eError;
+extern VALUE mxnet_eAPINotFound;
+
+/* Deeply freezes the object so that it can be shared among Ractors. */
+static inline VALUE
+mxnet_make_shareable(VALUE obj)
+{
+#ifdef HAVE_RB_RACTOR_MAKE_SHAREABLE
+  return rb_ractor_make_shareable(obj);
+#else
+  return rb_obj_freeze(obj);
+#endif
+}
 
 static inline int
 mxnet_is_ndarray(VALUE obj)
@@ -58,6 +58,7 @@ ndarray_to_narray(VALUE obj)
   na_ptr = nary_get_pointer_for_write(nary);
   na_size = RNARRAY_SIZE(nary);
 
+  mxnet_ndarray_wait_to_read(handle);
   CHECK_CALL(MXNET_API(MXNDArraySyncCopyToCPU)(handle, na_ptr, na_size));
 
   return nary;
@@ -82,11 +83,53 @@ m_sync_copyfrom(VALUE mod, VALUE nd_obj, VALUE nary)
   size = NA_SIZE(na);
 
   handle = mxnet_ndarray_get_handle(nd_obj);
+  mxnet_ndarray_wait_to_write(handle);
   CHECK_CALL(MXNET_API(MXNDArraySyncCopyFromCPU)(handle, data, size));
 
   return nd_obj;
 }
 
+static VALUE
+m_predictor_set_input(VALUE mod, VALUE predictor, VALUE key, VALUE nary)
+{
+  narray_t *na;
+
+  mxnet_check_type(predictor, mxnet_cPredictor);
+  if (!RTEST(rb_obj_is_kind_of(nary, numo_cSFloat))) {
+    nary = rb_funcall(numo_cSFloat, rb_intern("cast"), 1, nary);
+  }
+  if (!RTEST(nary_check_contiguous(nary))) {
+    nary = nary_dup(nary);
+  }
+
+  GetNArray(nary, na);
+  mxnet_predictor_set_input(predictor, key, NA_DATA_PTR(na), NA_SIZE(na));
+  RB_GC_GUARD(nary);
+
+  return predictor;
+}
+
+static VALUE
+m_predictor_get_output(VALUE mod, VALUE predictor, VALUE index, VALUE nary)
+{
+  narray_t *na;
+  char *ptr;
+
+  mxnet_check_type(predictor, mxnet_cPredictor);
+  if (!RTEST(rb_obj_is_kind_of(nary, numo_cSFloat))) {
+    rb_raise(rb_eTypeError, "the output buffer must be a Numo::SFloat");
+  }
+  if (!RTEST(nary_check_contiguous(nary))) {
+    rb_raise(rb_eArgError, "the output buffer must be contiguous");
+  }
+
+  ptr = nary_get_pointer_for_write(nary);
+  GetNArray(nary, na);
+  mxnet_predictor_get_output(predictor, NUM2MXUINT(index), ptr, NA_SIZE(na));
+
+  return nary;
+}
+
 void
 Init_narray_helper(void)
 {
@@ -97,4 +140,6 @@ Init_narray_helper(void)
 
   mHelper = rb_define_module_under(mxnet_mMXNet, "NArrayHelper");
   rb_define_module_function(mHelper, "sync_copyfrom", m_sync_copyfrom, 2);
+  rb_define_module_function(mHelper, "predictor_set_input", m_predictor_set_input, 3);
+  rb_define_module_function(mHelper, "predictor_get_output", m_predictor_get_output, 3);
 }
@@ -1,4 +1,11 @@
 #include "mxnet_internal.h"
+#include <ruby/thread.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 VALUE mxnet_cNDArray;
 
@@ -73,11 +80,12 @@ dtype_m_name(VALUE mod, VALUE id_or_name)
   return mxnet_dtype_name(id_or_name);
 }
 
+/* A finalizer must not raise, so the error of MXNDArrayFree is ignored. */
 static void
 ndarray_free(void *ptr)
 {
-  if (ptr != NULL) {
-    CHECK_CALL(MXNET_API(MXNDArrayFree)((NDArrayHandle)ptr));
+  if (ptr != NULL && !mxnet_is_shutdown()) {
+    MXNET_API(MXNDArrayFree)((NDArrayHandle)ptr);
   }
 }
 
@@ -97,14 +105,71 @@ static const rb_data_type_t ndarray_data_type = {
   0, 0, RUBY_TYPED_FREE_IMMEDIATELY
 };
 
+/* Returns the handle of the array, which can be NULL for the placeholders
+ * such as the proxies of `MXNet.trace`. */
 NDArrayHandle
-mxnet_ndarray_get_handle(VALUE obj)
+mxnet_ndarray_peek_handle(VALUE obj)
 {
   NDArrayHandle handle;
   TypedData_Get_Struct(obj, void, &ndarray_data_type, handle);
   return handle;
 }
 
+/* Returns the handle of the array.  A placeholder without the handle is
+ * asked to give itself the data by `__materialize__`, which raises if it
+ * cannot.
+ */
+NDArrayHandle
+mxnet_ndarray_get_handle(VALUE obj)
+{
+  NDArrayHandle handle;
+
+  handle = mxnet_ndarray_peek_handle(obj);
+  if (handle == NULL) {
+    rb_funcall(obj, rb_intern("__materialize__"), 0);
+    handle = mxnet_ndarray_peek_handle(obj);
+    if (handle == NULL) {
+      rb_raise(mxnet_eError, "uninitialized NDArray");
+    }
+  }
+  return handle;
+}
+
+/* Moves the handle of the other array to this array without the handle.
+ * The other array is left without the handle.
+ *
+ * @param other [NDArray]
+ * @return [NDArray] self
+ */
+static VALUE
+ndarray_adopt(VALUE obj, VALUE other)
+{
+  NDArrayHandle handle;
+
+  mxnet_check_ndarray(other);
+  if (mxnet_ndarray_peek_handle(obj) != NULL) {
+    rb_raise(rb_eRuntimeError, "the array already has the handle");
+  }
+  handle = mxnet_ndarray_peek_handle(other);
+  if (handle == NULL) {
+    rb_raise(mxnet_eError, "uninitialized NDArray");
+  }
+  DATA_PTR(other) = NULL;
+  DATA_PTR(obj) = handle;
+
+  return obj;
+}
+
+/* Called when the data of an array without the handle is needed.  A
+ * plain NDArray without the handle is not initialized.
+ */
+static VALUE
+ndarray_materialize(VALUE obj)
+{
+  rb_raise(mxnet_eError, "uninitialized NDArray");
+  return Qnil;
+}
+
 static VALUE
 ndarray_allocate(VALUE klass)
 {
@@ -215,7 +280,27 @@ ndarray_s_save_extract_hash_i(VALUE key, VALUE val, VALUE arg)
   return ST_CONTINUE;
 }
 
+struct ndarray_save_params {
+  char const *fname;
+  mx_uint len;
+  NDArrayHandle *handles;
+  char const **keys;
+  int result;
+};
+
+static void *
+ndarray_s_save_without_gvl(void *ptr)
+{
+  struct ndarray_save_params *params = (struct ndarray_save_params *)ptr;
+  params->result = MXNET_API(MXNDArraySave)(params->fname, params->len, params->handles, params->keys);
+  return NULL;
+}
+
 /* Saves a list of arrays or a dict of str => array to file.
+ *
+ * The GVL is released while the arrays are serialized and written,
+ * so other Ruby threads (e.g. the training loop while a checkpoint is
+ * written by a background thread) can keep running.
  *
  * Examples of filenames:
  *
@@ -227,9 +312,10 @@ static VALUE
 ndarray_s_save(VALUE klass, VALUE fname, VALUE data)
 {
   char const *fname_cstr, **keys = NULL;
-  VALUE handles_str, keys_str;
+  VALUE handles_str, keys_str = Qnil, key_strs = Qnil;
   NDArrayHandle *handles;
   mx_uint len;
+  struct ndarray_save_params params;
 
   fname_cstr = StringValueCStr(fname); /* TODO: support pathname */
 
@@ -256,7 +342,7 @@ ndarray_s_save(VALUE klass, VALUE fname, VALUE data)
 
     memo[0] = (VALUE)handles;
     memo[1] = (VALUE)keys;
-    memo[2] = rb_ary_tmp_new(len);
+    memo[2] = key_strs = rb_ary_tmp_new(len);
     rb_hash_foreach(data, ndarray_s_save_extract_hash_i, (VALUE)memo);
   }
   else if (RB_TYPE_P(data, T_ARRAY)) {
@@ -286,22 +372,63 @@ ndarray_s_save(VALUE klass, VALUE fname, VALUE data)
              "or an Array of NDArrays.");
   }
 
-  CHECK_CALL(MXNET_API(MXNDArraySave)(fname_cstr, len, handles, keys));
+  params.fname = fname_cstr;
+  params.len = len;
+  params.handles = handles;
+  params.keys = keys;
+  rb_thread_call_without_gvl(ndarray_s_save_without_gvl, &params, NULL, NULL);
+
+  RB_GC_GUARD(fname);
+  RB_GC_GUARD(data);
+  RB_GC_GUARD(handles_str);
+  RB_GC_GUARD(keys_str);
+  RB_GC_GUARD(key_strs);
+
+  CHECK_CALL(params.result);
 
   return Qnil;
 }
 
 /* Loads an array from file.
  * See more details in `save`.
+ *
+ * When `mmap` is true, the file is mapped into memory instead of read,
+ * and the loaded arrays are CPU arrays that refer to the mapped pages.
+ * The pages are read on demand, and processes that map the same file
+ * share one physical copy of it through the page cache.  The mapping is
+ * private, so writes to the arrays are never written back to the file.
+ * Only local files with dense arrays can be mapped.  The arrays are
+ * copied from the file instead with the versions of libmxnet without
+ * MXNDArrayFromDLPackEx, which could not release the mapping.
+ *
+ * @param fname [String]  The file name to load.
+ * @param mmap [true, false]  Whether the file is memory-mapped.
+ * @return [Array<NDArray>, Hash{String => NDArray}]
  */
 static VALUE
-ndarray_s_load(VALUE obj, VALUE fname)
+ndarray_s_load(int argc, VALUE *argv, VALUE klass)
 {
+  VALUE fname, opts, mmap_v = Qfalse;
   char const *fname_cstr;
   mx_uint out_size, out_name_size;
   NDArrayHandle *handles;
   char const **names;
 
+  rb_scan_args(argc, argv, "1:", &fname, &opts);
+  if (!NIL_P(opts)) {
+    static ID keywords[1];
+    if (!keywords[0]) {
+      keywords[0] = rb_intern("mmap");
+    }
+    rb_get_kwargs(opts, keywords, 0, 1, &mmap_v);
+    if (mmap_v == Qundef) {
+      mmap_v = Qfalse;
+    }
+  }
+  if (RTEST(mmap_v)) {
+    return rb_funcall(klass, rb_intern("_load_mapped"), 1, fname);
+  }
+
   fname_cstr = StringValueCStr(fname);
   CHECK_CALL(MXNET_API(MXNDArrayLoad)(
     fname_cstr, &out_size, &handles, &out_name_size, &names));
@@ -333,6 +460,219 @@ ndarray_s_load(VALUE obj, VALUE fname)
   }
 }
 
+/* A memory-mapped file shared by the arrays created from it.
+ * The mapping is released when the last array is freed by the engine,
+ * which may happen in a thread without the GVL. */
+struct mapped_file {
+  void *addr;
+  size_t size;
+  long refcount;
+};
+
+struct mapped_tensor {
+  DLManagedTensor managed;
+  struct mapped_file *file;
+  int64_t shape[];
+};
+
+static void
+mapped_file_release(struct mapped_file *file)
+{
+  if (__sync_sub_and_fetch(&file->refcount, 1) == 0) {
+    munmap(file->addr, file->size);
+    free(file);
+  }
+}
+
+static void
+mapped_tensor_deleter(DLManagedTensor *self)
+{
+  struct mapped_tensor *tensor = (struct mapped_tensor *)self->manager_ctx;
+  struct mapped_file *file = tensor->file;
+
+  free(tensor);
+  mapped_file_release(file);
+}
+
+static DLDataType
+dtype_id_to_dl_data_type(int dtype_id)
+{
+  DLDataType dl_dtype;
+
+  switch (dtype_id) {
+    case kFloat32:
+    case kFloat64:
+    case kFloat16:
+      dl_dtype.code = kDLFloat;
+      break;
+    case kUint8:
+      dl_dtype.code = kDLUInt;
+      break;
+    default:
+      dl_dtype.code = kDLInt;
+      break;
+  }
+  dl_dtype.bits = (uint8_t)(dtype_sizes[dtype_id] * 8);
+  dl_dtype.lanes = 1;
+  return dl_dtype;
+}
+
+struct mmap_arrays_params {
+  struct mapped_file *file;
+  VALUE specs;
+};
+
+static VALUE
+mmap_arrays_body(VALUE arg)
+{
+  struct mmap_arrays_params *params = (struct mmap_arrays_params *)arg;
+  struct mapped_file *file = params->file;
+  VALUE specs = params->specs;
+  VALUE result;
+  long i, n;
+
+  n = RARRAY_LEN(specs);
+  result = rb_ary_new_capa(n);
+  for (i = 0; i < n; ++i) {
+    VALUE spec, shape_v;
+    struct mapped_tensor *tensor;
+    DLTensor *dl_tensor;
+    NDArrayHandle handle;
+    size_t offset, nbytes;
+    int dtype_id, ndim, j;
+
+    spec = rb_convert_type(RARRAY_AREF(specs, i), T_ARRAY, "Array", "to_ary");
+    offset = NUM2SIZET(RARRAY_AREF(spec, 0));
+    shape_v = rb_convert_type(RARRAY_AREF(spec, 1), T_ARRAY, "Array", "to_ary");
+    dtype_id = NUM2INT(RARRAY_AREF(spec, 2));
+    if (dtype_id < 0 || NUMBER_OF_DTYPE_IDS <= dtype_id) {
+      rb_raise(rb_eArgError, "invalid dtype id %d", dtype_id);
+    }
+
+    ndim = (int)RARRAY_LEN(shape_v);
+    nbytes = dtype_sizes[dtype_id];
+    for (j = 0; j < ndim; ++j) {
+      nbytes *= NUM2SIZET(RARRAY_AREF(shape_v, j));
+    }
+    if (file->size < offset || file->size - offset < nbytes) {
+      rb_raise(rb_eArgError, "the array at offset %"PRIuSIZE" is out of the file", offset);
+    }
+    /* MXNet requires the data to be aligned to the element size */
+    if (offset % dtype_sizes[dtype_id] != 0) {
+      rb_ary_push(result, Qnil);
+      continue;
+    }
+
+    tensor = malloc(sizeof(struct mapped_tensor) + sizeof(int64_t) * ndim);
+    if (tensor == NULL) {
+      rb_memerror();
+    }
+    for (j = 0; j < ndim; ++j) {
+      tensor->shape[j] = NUM2LL(RARRAY_AREF(shape_v, j));
+    }
+    tensor->file = file;
+    tensor->managed.manager_ctx = tensor;
+    tensor->managed.deleter = mapped_tensor_deleter;
+    dl_tensor = &tensor->managed.dl_tensor;
+    dl_tensor->data = (char *)file->addr + offset;
+    dl_tensor->ctx.device_type = kDLCPU;
+    dl_tensor->ctx.device_id = 0;
+    dl_tensor->ndim = ndim;
+    dl_tensor->dtype = dtype_id_to_dl_data_type(dtype_id);
+    dl_tensor->shape = tensor->shape;
+    dl_tensor->strides = NULL;
+    dl_tensor->byte_offset = 0;
+    __sync_add_and_fetch(&file->refcount, 1);
+
+    if (MXNET_API(MXNDArrayFromDLPackEx)(&tensor->managed, false, &handle) != 0) {
+      mapped_tensor_deleter(&tensor->managed);
+      mxnet_raise_last_error();
+    }
+    rb_ary_push(result, mxnet_ndarray_new(handle));
+  }
+
+  return result;
+}
+
+static VALUE
+mmap_arrays_ensure(VALUE arg)
+{
+  struct mmap_arrays_params *params = (struct mmap_arrays_params *)arg;
+  mapped_file_release(params->file);
+  return Qnil;
+}
+
+/* Maps the given file into memory, and creates the arrays that refer
+ * to the mapped pages.
+ *
+ * Each spec is a triple of the byte offset of the data, the shape, and
+ * the dtype id.  `nil` is returned for the array whose data is not
+ * aligned to its element size, and for all the arrays if libmxnet has no
+ * MXNDArrayFromDLPackEx.  MXNDArrayFromDLPack of the older versions never
+ * calls the deleter, which would keep the file mapped forever.
+ *
+ * @param fname [String]  The file name to map.
+ * @param specs [Array<Array>]  The specs of the arrays.
+ * @return [Array<NDArray, nil>]
+ */
+static VALUE
+ndarray_s_mmap_arrays(VALUE klass, VALUE fname, VALUE specs)
+{
+  struct mmap_arrays_params params;
+  struct mapped_file *file;
+  struct stat st;
+  void *addr;
+  int fd;
+
+  FilePathValue(fname);
+  specs = rb_convert_type(specs, T_ARRAY, "Array", "to_ary");
+  if (!MXNET_API_P(MXNDArrayFromDLPackEx)) {
+    long i, n = RARRAY_LEN(specs);
+    VALUE result = rb_ary_new_capa(n);
+    for (i = 0; i < n; ++i) {
+      rb_ary_push(result, Qnil);
+    }
+    return result;
+  }
+
+  fd = rb_cloexec_open(StringValueCStr(fname), O_RDONLY, 0);
+  if (fd < 0) {
+    rb_sys_fail_str(fname);
+  }
+  rb_update_max_fd(fd);
+  if (fstat(fd, &st) < 0) {
+    int err = errno;
+    close(fd);
+    rb_syserr_fail_str(err, fname);
+  }
+  if (st.st_size == 0) {
+    close(fd);
+    rb_raise(rb_eArgError, "unable to map an empty file");
+  }
+
+  /* A private writable mapping is used so that writing to the arrays
+   * does not crash, but only copies the written pages. */
+  addr = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    rb_sys_fail_str(fname);
+  }
+
+  file = malloc(sizeof(struct mapped_file));
+  if (file == NULL) {
+    munmap(addr, (size_t)st.st_size);
+    rb_memerror();
+  }
+  file->addr = addr;
+  file->size = (size_t)st.st_size;
+  /* The reference of the caller, released in mmap_arrays_ensure */
+  file->refcount = 1;
+
+  params.file = file;
+  params.specs = specs;
+  return rb_ensure(mmap_arrays_body, (VALUE)&params, mmap_arrays_ensure, (VALUE)&params);
+}
+
 /* Returns a **view**  of this array with a new shape without altering any data.
  *
  * @param [Array<Integer>] shape  The new shape should not change the array size.
@@ -382,6 +722,55 @@ ndarray_get_context_params(VALUE obj)
   return rb_assoc_new(INT2NUM(dev_typeid), INT2NUM(dev_id));
 }
 
+/* Returns the handle of the shared memory of an array on cpu_shared.
+ *
+ * @return [Array<Integer>] The pair of shared_pid and shared_id.
+ */
+static VALUE
+ndarray_get_shared_mem_handle(VALUE obj)
+{
+  NDArrayHandle handle;
+  int shared_pid, shared_id;
+
+  MXNET_API_CHECK(MXNDArrayGetSharedMemHandle);
+
+  handle = mxnet_ndarray_get_handle(obj);
+  CHECK_CALL(MXNET_API(MXNDArrayGetSharedMemHandle)(handle, &shared_pid, &shared_id));
+
+  return rb_assoc_new(INT2NUM(shared_pid), INT2NUM(shared_id));
+}
+
+/* Creates an array on cpu_shared referring to the shared memory created
+ * by another process.  The data is not copied.
+ */
+static VALUE
+ndarray_s_from_shared_mem(VALUE klass, VALUE shared_pid_v, VALUE shared_id_v, VALUE shape_v, VALUE dtype_v)
+{
+  VALUE shape_str;
+  mx_uint *shape;
+  mx_uint ndim, i;
+  NDArrayHandle handle;
+  int dtype;
+
+  MXNET_API_CHECK(MXNDArrayCreateFromSharedMem);
+
+  shape_v = rb_convert_type(shape_v, T_ARRAY, "Array", "to_ary");
+  ndim = (mx_uint)RARRAY_LEN(shape_v);
+  shape_str = rb_str_tmp_new(sizeof(mx_uint) * ndim);
+  shape = (mx_uint *)RSTRING_PTR(shape_str);
+  for (i = 0; i < ndim; ++i) {
+    shape[i] = NUM2MXUINT(RARRAY_AREF(shape_v, i));
+  }
+  dtype = mxnet_dtype_name2id(dtype_v);
+
+  CHECK_CALL(MXNET_API(MXNDArrayCreateFromSharedMem)(
+        NUM2INT(shared_pid_v), NUM2INT(shared_id_v),
+        shape, ndim, dtype, &handle));
+  RB_GC_GUARD(shape_str);
+
+  return mxnet_ndarray_new(handle);
+}
+
 static int
 ndarray_get_dtype_id(VALUE obj)
 {
@@ -629,6 +1018,7 @@ ndarray_to_a(VALUE obj)
   length = shape[0];
   elsize = dtype_sizes[dtype_id];
   data_str = rb_str_tmp_new(elsize * length);
+  mxnet_ndarray_wait_to_read(handle);
   CHECK_CALL(MXNET_API(MXNDArraySyncCopyToCPU)(handle, (void *)RSTRING_PTR(data_str), length));
 
   ary = rb_ary_new_capa(length);
@@ -701,17 +1091,327 @@ ndarray_to_a(VALUE obj)
   return ary;
 }
 
+struct wait_params {
+  NDArrayHandle handle;
+  int result;
+};
+
+static void *
+ndarray_wait_to_read_without_gvl(void *ptr)
+{
+  struct wait_params *params = (struct wait_params *)ptr;
+  params->result = MXNET_API(MXNDArrayWaitToRead)(params->handle);
+  return NULL;
+}
+
+static void *
+ndarray_wait_to_write_without_gvl(void *ptr)
+{
+  struct wait_params *params = (struct wait_params *)ptr;
+  params->result = MXNET_API(MXNDArrayWaitToWrite)(params->handle);
+  return NULL;
+}
+
+/* Waits without the GVL until the array can be read.
+ *
+ * The synchronous copies wait for the array while holding the GVL, so
+ * they call this first not to block the custom operators in Ruby that
+ * compute the array.
+ */
+void
+mxnet_ndarray_wait_to_read(NDArrayHandle handle)
+{
+  struct wait_params params;
+
+  params.handle = handle;
+  rb_thread_call_without_gvl(ndarray_wait_to_read_without_gvl, &params, NULL, NULL);
+  CHECK_CALL(params.result);
+}
+
+/* Waits without the GVL until the array can be written. */
+void
+mxnet_ndarray_wait_to_write(NDArrayHandle handle)
+{
+  struct wait_params params;
+
+  params.handle = handle;
+  rb_thread_call_without_gvl(ndarray_wait_to_write_without_gvl, &params, NULL, NULL);
+  CHECK_CALL(params.result);
+}
+
+/* Waits until all the pending writes to this array are finished.
+ *
+ * The GVL is released while waiting.
+ *
+ * @return [nil]
+ */
 static VALUE
 ndarray_wait_to_read(VALUE obj)
 {
-  NDArrayHandle *handle;
+  mxnet_ndarray_wait_to_read(mxnet_ndarray_get_handle(obj));
+  return Qnil;
+}
+
+static void *
+ndarray_s_waitall_without_gvl(void *ptr)
+{
+  struct wait_params *params = (struct wait_params *)ptr;
+  params->result = MXNET_API(MXNDArrayWaitAll)();
+  return NULL;
+}
 
-  handle = mxnet_ndarray_get_handle(obj);
-  CHECK_CALL(MXNET_API(MXNDArrayWaitToRead)(handle));
+/* Waits until all the pending operations of all the arrays are finished.
+ *
+ * The GVL is released while waiting.
+ *
+ * @return [nil]
+ */
+static VALUE
+ndarray_s_waitall(VALUE klass)
+{
+  struct wait_params params;
+
+  params.handle = NULL;
+  rb_thread_call_without_gvl(ndarray_s_waitall_without_gvl, &params, NULL, NULL);
+  CHECK_CALL(params.result);
 
   return Qnil;
 }
 
+/* The parameter of the engine callback that notifies the completion of
+ * the pending writes to an array by writing a byte to a pipe. */
+struct ready_notifier {
+  int fd;
+};
+
+static void
+ready_notifier_notify(void *rctx, void *param)
+{
+  struct ready_notifier *notifier = (struct ready_notifier *)param;
+  char const byte = 1;
+
+  while (write(notifier->fd, &byte, 1) < 0 && errno == EINTR);
+}
+
+static void
+ready_notifier_free(void *param)
+{
+  struct ready_notifier *notifier = (struct ready_notifier *)param;
+
+  close(notifier->fd);
+  free(notifier);
+}
+
+/* Pushes an engine callback that writes a byte to `fd` after all the
+ * pending writes to this array are finished.
+ *
+ * The file descriptor is duplicated, so the caller can close `fd` right
+ * after this call.  `false` is returned when libmxnet does not provide
+ * `MXEnginePushSyncND`.
+ *
+ * @param fd [Integer]  The writing end of a pipe.
+ * @return [true, false]
+ */
+static VALUE
+ndarray_notify_when_ready(VALUE obj, VALUE fd_v)
+{
+  /* mxnet::Context of cpu(0), and FnProperty::kNormal */
+  static int const cpu_context[2] = { 1, 0 };
+  static int const fn_property = 0;
+  struct ready_notifier *notifier;
+  NDArrayHandle handle;
+  int fd;
+
+  if (!MXNET_API_P(MXEnginePushSyncND)) {
+    return Qfalse;
+  }
+
+  handle = mxnet_ndarray_get_handle(obj);
+  fd = rb_cloexec_dup(NUM2INT(fd_v));
+  if (fd < 0) {
+    rb_sys_fail("dup");
+  }
+  rb_update_max_fd(fd);
+
+  notifier = malloc(sizeof(struct ready_notifier));
+  if (notifier == NULL) {
+    close(fd);
+    rb_memerror();
+  }
+  notifier->fd = fd;
+
+  if (MXNET_API(MXEnginePushSyncND)(
+        ready_notifier_notify, notifier, ready_notifier_free,
+        cpu_context, &handle, 1, NULL, 0,
+        &fn_property, 0, "RubyNotifyWhenReady") != 0) {
+    ready_notifier_free(notifier);
+    mxnet_raise_last_error();
+  }
+
+  return Qtrue;
+}
+
+static int
+ndarray_get_data_size(NDArrayHandle handle, size_t *out_length, size_t *out_nbytes)
+{
+  mx_uint ndim, i;
+  mx_uint const *shape;
+  int dtype_id;
+  size_t length;
+
+  CHECK_CALL(MXNET_API(MXNDArrayGetShape)(handle, &ndim, &shape));
+  CHECK_CALL(MXNET_API(MXNDArrayGetDType)(handle, &dtype_id));
+  if (dtype_id < 0 || NUMBER_OF_DTYPE_IDS <= dtype_id) {
+    rb_raise(rb_eRuntimeError, "NDArray has an unexpected dtype %d", dtype_id);
+  }
+
+  length = 1;
+  for (i = 0; i < ndim; ++i) {
+    length *= shape[i];
+  }
+
+  *out_length = length;
+  *out_nbytes = length * dtype_sizes[dtype_id];
+  return dtype_id;
+}
+
+static int
+ndarray_is_on_cpu(NDArrayHandle handle)
+{
+  int dev_type, dev_id;
+  CHECK_CALL(MXNET_API(MXNDArrayGetContext)(handle, &dev_type, &dev_id));
+  /* cpu, cpu_pinned, or cpu_shared */
+  return dev_type == 1 || dev_type == 3 || dev_type == 5;
+}
+
+struct pread_params {
+  int fd;
+  char *buf;
+  size_t nbytes;
+  off_t offset;
+  int err;
+};
+
+static void *
+pread_without_gvl(void *ptr)
+{
+  struct pread_params *params = (struct pread_params *)ptr;
+  size_t done = 0;
+
+  params->err = 0;
+  while (done < params->nbytes) {
+    ssize_t n = pread(params->fd, params->buf + done, params->nbytes - done, params->offset + (off_t)done);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      params->err = errno;
+      break;
+    }
+    if (n == 0) {
+      params->err = -1;
+      break;
+    }
+    done += (size_t)n;
+  }
+
+  return NULL;
+}
+
+static void
+pread_fully(int fd, void *buf, size_t nbytes, off_t offset)
+{
+  struct pread_params params;
+
+  params.fd = fd;
+  params.buf = (char *)buf;
+  params.nbytes = nbytes;
+  params.offset = offset;
+  rb_thread_call_without_gvl(pread_without_gvl, &params, NULL, NULL);
+
+  if (params.err == -1) {
+    rb_raise(rb_eEOFError, "unexpected end of file while reading NDArray data");
+  }
+  else if (params.err != 0) {
+    rb_syserr_fail(params.err, "pread");
+  }
+}
+
+/* Fills this array with the raw data at `offset` in the file `fd`.
+ *
+ * The data is read directly into the memory of the array when it lives
+ * on CPU, so no temporary buffer is allocated.  Otherwise, the data is
+ * read into a host buffer and copied to the device.
+ *
+ * @param fd [Integer]  The file descriptor to read from.
+ * @param offset [Integer]  The byte offset of the data in the file.
+ * @return [NDArray] self
+ */
+static VALUE
+ndarray_copy_from_fd(VALUE obj, VALUE fd_v, VALUE offset_v)
+{
+  NDArrayHandle handle;
+  size_t length, nbytes;
+  int fd;
+  off_t offset;
+
+  handle = mxnet_ndarray_get_handle(obj);
+  fd = NUM2INT(fd_v);
+  offset = (off_t)NUM2LL(offset_v);
+
+  ndarray_get_data_size(handle, &length, &nbytes);
+  if (nbytes == 0) {
+    return obj;
+  }
+
+  if (ndarray_is_on_cpu(handle)) {
+    void *data;
+
+    mxnet_ndarray_wait_to_write(handle);
+    CHECK_CALL(MXNET_API(MXNDArrayGetData)(handle, &data));
+    pread_fully(fd, data, nbytes, offset);
+  }
+  else {
+    VALUE buf_str = rb_str_tmp_new(nbytes);
+    pread_fully(fd, RSTRING_PTR(buf_str), nbytes, offset);
+    mxnet_ndarray_wait_to_write(handle);
+    CHECK_CALL(MXNET_API(MXNDArraySyncCopyFromCPU)(handle, RSTRING_PTR(buf_str), length));
+    rb_str_resize(buf_str, 0);
+  }
+
+  return obj;
+}
+
+/* Fills this array with the raw data at `offset` in the given String.
+ *
+ * @param buffer [String]  The buffer that contains the data.
+ * @param offset [Integer]  The byte offset of the data in the buffer.
+ * @return [NDArray] self
+ */
+static VALUE
+ndarray_copy_from_buffer(VALUE obj, VALUE buffer, VALUE offset_v)
+{
+  NDArrayHandle handle;
+  size_t length, nbytes;
+  long offset;
+
+  handle = mxnet_ndarray_get_handle(obj);
+  StringValue(buffer);
+  offset = NUM2LONG(offset_v);
+
+  ndarray_get_data_size(handle, &length, &nbytes);
+  if (offset < 0 || RSTRING_LEN(buffer) < offset || (size_t)(RSTRING_LEN(buffer) - offset) < nbytes) {
+    rb_raise(rb_eArgError, "the buffer is too short to fill the array");
+  }
+  if (nbytes == 0) {
+    return obj;
+  }
+
+  mxnet_ndarray_wait_to_write(handle);
+  CHECK_CALL(MXNET_API(MXNDArraySyncCopyFromCPU)(handle, RSTRING_PTR(buffer) + offset, length));
+  RB_GC_GUARD(buffer);
+
+  return obj;
+}
+
 void
 mxnet_init_ndarray(void)
 {
@@ -724,7 +1424,8 @@ mxnet_init_ndarray(void)
 
   rb_define_singleton_method(cNDArray, "empty", ndarray_s_empty, -1);
   rb_define_singleton_method(cNDArray, "save", ndarray_s_save, 2);
-  rb_define_singleton_method(cNDArray, "load", ndarray_s_load, 1);
+  rb_define_singleton_method(cNDArray, "load", ndarray_s_load, -1);
+  rb_define_singleton_method(cNDArray, "waitall", ndarray_s_waitall, 0);
   /* TODO: rb_define_singleton_method(cNDArray, "load_from_buffer", ndarray_s_load_from_buffer, 1); */
 
   rb_define_method(cNDArray, "dtype", ndarray_get_dtype, 0);
@@ -736,10 +1437,20 @@ mxnet_init_ndarray(void)
   rb_define_method(cNDArray, "wait_to_read", ndarray_wait_to_read, 0);
 
   rb_define_private_method(cNDArray, "__mxnet_handle__", ndarray_get_mxnet_handle, 0);
+  rb_define_private_method(cNDArray, "__materialize__", ndarray_materialize, 0);
+  rb_define_private_method(cNDArray, "__adopt__", ndarray_adopt, 1);
   rb_define_private_method(cNDArray, "_get_context_params", ndarray_get_context_params, 0);
   rb_define_private_method(cNDArray, "_at", ndarray_at, 1);
   rb_define_private_method(cNDArray, "_slice", ndarray_slice, 2);
   rb_define_private_method(cNDArray, "_attach_grad", ndarray_attach_grad, 2);
+  rb_define_private_method(cNDArray, "_copy_from_fd", ndarray_copy_from_fd, 2);
+  rb_define_private_method(cNDArray, "_copy_from_buffer", ndarray_copy_from_buffer, 2);
+  rb_define_private_method(cNDArray, "_notify_when_ready", ndarray_notify_when_ready, 1);
+  rb_define_singleton_method(cNDArray, "_mmap_arrays", ndarray_s_mmap_arrays, 2);
+  rb_define_private_method(cNDArray, "_shared_mem_handle", ndarray_get_shared_mem_handle, 0);
+  rb_define_singleton_method(cNDArray, "_from_shared_mem", ndarray_s_from_shared_mem, 4);
+  rb_funcall(cNDArray, rb_intern("private_class_method"), 1, ID2SYM(rb_intern("_mmap_arrays")));
+  rb_funcall(cNDArray, rb_intern("private_class_method"), 1, ID2SYM(rb_intern("_from_shared_mem")));
 
   mxnet_cNDArray = cNDArray;
 
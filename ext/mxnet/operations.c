@@ -7,10 +7,10 @@ static ID id_handles;
 static ID id_descriptions;
 
 static VALUE
-lookup_op_info(VALUE klass, VALUE mod, VALUE name)
+lookup_op_table(ID table_id, VALUE mod, VALUE name)
 {
-  VALUE hash, op_info;
-  hash = rb_ivar_get(mod, id_descriptions);
+  VALUE hash, value;
+  hash = rb_ivar_get(mod, table_id);
   if (NIL_P(hash)) {
     rb_raise(rb_eTypeError, "unsupported module");
   }
@@ -18,11 +18,25 @@ lookup_op_info(VALUE klass, VALUE mod, VALUE name)
     StringValue(name);
     name = rb_to_symbol(name);
   }
-  op_info = rb_hash_lookup2(hash, name, Qundef);
-  if (op_info == Qundef) {
+  value = rb_hash_lookup2(hash, name, Qundef);
+  if (value == Qundef) {
     rb_raise(rb_eArgError, "unknown operation name");
   }
-  return op_info;
+  return value;
+}
+
+static VALUE
+lookup_op_info(VALUE klass, VALUE mod, VALUE name)
+{
+  return lookup_op_table(id_descriptions, mod, name);
+}
+
+/* Returns the handle of the operation as an Integer, which is given to
+ * `LibMXNet.imperative_invoke`. */
+static VALUE
+lookup_op_handle(VALUE klass, VALUE mod, VALUE name)
+{
+  return lookup_op_table(id_handles, mod, name);
 }
 
 static void
@@ -31,7 +45,7 @@ register_handle(VALUE mod, char const* name, void *handle)
   VALUE hash = rb_ivar_get(mod, id_handles);
   if (NIL_P(hash)) {
     hash = rb_hash_new();
-    rb_ivar_set(mod, id_handles, rb_hash_new());
+    rb_ivar_set(mod, id_handles, hash);
   }
   rb_hash_aset(hash, ID2SYM(rb_intern(name)), PTR2NUM(handle));
 }
@@ -42,7 +56,7 @@ register_description(VALUE mod, char const *name, VALUE description)
   VALUE hash = rb_ivar_get(mod, id_descriptions);
   if (NIL_P(hash)) {
     hash = rb_hash_new();
-    rb_ivar_set(mod, id_descriptions, rb_hash_new());
+    rb_ivar_set(mod, id_descriptions, hash);
   }
   rb_hash_aset(hash, ID2SYM(rb_intern(name)), description);
 }
@@ -119,6 +133,23 @@ setup_operation(VALUE klass, VALUE name)
   define_operation_delegator(klass, mod, op_handle, op_info);
 }
 
+/* The tables are read-only after the initialization, and they are made
+ * shareable so that the operations can be called in any Ractor. */
+static void
+freeze_op_tables(VALUE mod)
+{
+  VALUE hash;
+
+  hash = rb_ivar_get(mod, id_handles);
+  if (!NIL_P(hash)) {
+    rb_ivar_set(mod, id_handles, mxnet_make_shareable(hash));
+  }
+  hash = rb_ivar_get(mod, id_descriptions);
+  if (!NIL_P(hash)) {
+    rb_ivar_set(mod, id_descriptions, mxnet_make_shareable(hash));
+  }
+}
+
 static VALUE
 list_all_op_names(void)
 {
@@ -152,6 +183,7 @@ mxnet_init_operations(VALUE klass)
   mxnet_sOpArgInfo = rb_const_get_at(mxnet_mMXNet, rb_intern("OpArgInfo"));
 
   rb_define_singleton_method(mxnet_sOpInfo, "lookup", lookup_op_info, 2);
+  rb_define_singleton_method(mxnet_sOpInfo, "lookup_handle", lookup_op_handle, 2);
 
   id_handles = rb_intern("handles");
   id_descriptions = rb_intern("descriptions");
@@ -160,4 +192,10 @@ mxnet_init_operations(VALUE klass)
   for (i = 0; i < RARRAY_LEN(op_names); ++i) {
     setup_operation(klass, RARRAY_AREF(op_names, i));
   }
+
+  freeze_op_tables(mOps);
+  freeze_op_tables(mInternal);
+  freeze_op_tables(mContrib);
+  freeze_op_tables(mLinalg);
+  freeze_op_tables(mSparse);
 }
@@ -0,0 +1,604 @@
+#include "mxnet_internal.h"
+
+#include <string.h>
+
+/* The custom operators implemented in Ruby.
+ *
+ * libmxnet calls the creator registered by MXCustomOpRegister to create
+ * a CustomOpProp, and the callbacks of the prop to create a CustomOp.
+ * The callbacks are dispatched to Ruby by mxnet_callback_invoke, so the
+ * forward and backward computations, which run on the worker threads of
+ * libmxnet, wait for the GVL.
+ */
+
+enum CustomOpCallbacks {
+  kCustomOpDelete,
+  kCustomOpForward,
+  kCustomOpBackward,
+  NUM_OP_CALLBACKS
+};
+
+enum CustomOpPropCallbacks {
+  kCustomOpPropDelete,
+  kCustomOpPropListArguments,
+  kCustomOpPropListOutputs,
+  kCustomOpPropListAuxiliaryStates,
+  kCustomOpPropInferShape,
+  kCustomOpPropDeclareBackwardDependency,
+  kCustomOpPropCreateOperator,
+  kCustomOpPropInferType,
+  NUM_PROP_CALLBACKS
+};
+
+enum CustomOpTensorTags {
+  kTagInData,
+  kTagOutData,
+  kTagInGrad,
+  kTagOutGrad,
+  kTagAux,
+  NUM_TENSOR_TAGS
+};
+
+static VALUE mOperator;
+
+static ID id_list_arguments;
+static ID id_list_outputs;
+static ID id_list_auxiliary_states;
+static ID id_declare_backward_dependency;
+static ID id_create_prop_entry;
+static ID id_infer_shape_entry;
+static ID id_infer_type_entry;
+static ID id_create_operator_entry;
+static ID id_forward_entry;
+static ID id_backward_entry;
+
+static VALUE
+shape_to_array(int ndim, int const *shape)
+{
+  VALUE ary;
+  int i;
+
+  ary = rb_ary_new_capa(ndim > 0 ? ndim : 0);
+  for (i = 0; i < ndim; ++i) {
+    rb_ary_push(ary, INT2NUM(shape[i]));
+  }
+  return ary;
+}
+
+static VALUE
+int_array_to_array(int n, int const *values)
+{
+  return shape_to_array(n, values);
+}
+
+/* ==== CustomOp ==== */
+
+struct custom_op {
+  struct mxnet_live_object live;
+  int (*callbacks[NUM_OP_CALLBACKS])(void);
+  void *contexts[NUM_OP_CALLBACKS];
+};
+
+static int
+custom_op_delete(void *state)
+{
+  struct custom_op *op = (struct custom_op *)state;
+
+  mxnet_live_object_unlink(&op->live);
+  free(op);
+  return 1;
+}
+
+struct custom_op_fb_args {
+  struct custom_op *op;
+  ID method_id;
+  int size;
+  void **ptrs;
+  int *tags;
+  int const *reqs;
+  int req_tag;
+  int is_train;
+};
+
+static VALUE
+custom_op_fb_body(VALUE ptr)
+{
+  struct custom_op_fb_args *args = (struct custom_op_fb_args *)ptr;
+  VALUE tensors, reqs;
+  int i;
+  long num_reqs;
+
+  tensors = rb_ary_new_capa(NUM_TENSOR_TAGS);
+  for (i = 0; i < NUM_TENSOR_TAGS; ++i) {
+    rb_ary_push(tensors, rb_ary_new());
+  }
+  /* The NDArrays given to the callback are owned by the callee, so they
+   * are wrapped without copying and freed by the GC. */
+  for (i = 0; i < args->size; ++i) {
+    int tag = args->tags[i];
+    if (tag < 0 || NUM_TENSOR_TAGS <= tag) {
+      rb_raise(mxnet_eError, "unknown tensor tag %d in the custom operator", tag);
+    }
+    rb_ary_push(RARRAY_AREF(tensors, tag), mxnet_ndarray_new(args->ptrs[i]));
+  }
+
+  num_reqs = RARRAY_LEN(RARRAY_AREF(tensors, args->req_tag));
+  reqs = int_array_to_array((int)num_reqs, args->reqs);
+
+  rb_funcall(args->op->live.obj, args->method_id, 3,
+             args->is_train ? Qtrue : Qfalse, reqs, tensors);
+  return Qnil;
+}
+
+static int
+custom_op_forward(int size, void **ptrs, int *tags, int const *reqs,
+                  int const is_train, void *state)
+{
+  struct custom_op_fb_args args;
+
+  args.op = (struct custom_op *)state;
+  args.method_id = id_forward_entry;
+  args.size = size;
+  args.ptrs = ptrs;
+  args.tags = tags;
+  args.reqs = reqs;
+  args.req_tag = kTagOutData;
+  args.is_train = is_train;
+  return mxnet_callback_protect(custom_op_fb_body, &args);
+}
+
+static int
+custom_op_backward(int size, void **ptrs, int *tags, int const *reqs,
+                   int const is_train, void *state)
+{
+  struct custom_op_fb_args args;
+
+  args.op = (struct custom_op *)state;
+  args.method_id = id_backward_entry;
+  args.size = size;
+  args.ptrs = ptrs;
+  args.tags = tags;
+  args.reqs = reqs;
+  args.req_tag = kTagInGrad;
+  args.is_train = is_train;
+  return mxnet_callback_protect(custom_op_fb_body, &args);
+}
+
+/* ==== CustomOpProp ==== */
+
+struct custom_op_prop {
+  struct mxnet_live_object live;
+  int (*callbacks[NUM_PROP_CALLBACKS])(void);
+  void *contexts[NUM_PROP_CALLBACKS];
+
+  /* The results of the callbacks, kept until the next call */
+  char **lists[3];
+  int *shape_data;
+  int *deps;
+};
+
+static void
+free_string_list(char **list)
+{
+  char **p;
+
+  if (list == NULL) return;
+  for (p = list; *p != NULL; ++p) {
+    free(*p);
+  }
+  free(list);
+}
+
+static void *
+checked_malloc(size_t size)
+{
+  void *ptr = malloc(size > 0 ? size : 1);
+  if (ptr == NULL) {
+    rb_memerror();
+  }
+  return ptr;
+}
+
+static int
+custom_op_prop_delete(void *state)
+{
+  struct custom_op_prop *prop = (struct custom_op_prop *)state;
+  int i;
+
+  mxnet_live_object_unlink(&prop->live);
+  for (i = 0; i < 3; ++i) {
+    free_string_list(prop->lists[i]);
+  }
+  free(prop->shape_data);
+  free(prop->deps);
+  free(prop);
+  return 1;
+}
+
+struct custom_op_prop_list_args {
+  struct custom_op_prop *prop;
+  int index;
+  char ***out;
+};
+
+static VALUE
+custom_op_prop_list_body(VALUE ptr)
+{
+  static ID const *const list_ids[3] = {
+    &id_list_arguments,
+    &id_list_outputs,
+    &id_list_auxiliary_states
+  };
+  struct custom_op_prop_list_args *args = (struct custom_op_prop_list_args *)ptr;
+  VALUE names;
+  char **list;
+  long i, n;
+
+  names = rb_funcall(args->prop->live.obj, *list_ids[args->index], 0);
+  names = rb_convert_type(names, T_ARRAY, "Array", "to_ary");
+  n = RARRAY_LEN(names);
+  for (i = 0; i < n; ++i) {
+    VALUE name = rb_obj_as_string(RARRAY_AREF(names, i));
+    StringValueCStr(name);
+    rb_ary_store(names, i, name);
+  }
+
+  list = (char **)checked_malloc(sizeof(char *) * (n + 1));
+  for (i = 0; i < n; ++i) {
+    VALUE name = RARRAY_AREF(names, i);
+    list[i] = (char *)checked_malloc(RSTRING_LEN(name) + 1);
+    memcpy(list[i], RSTRING_PTR(name), RSTRING_LEN(name) + 1);
+  }
+  list[n] = NULL;
+
+  free_string_list(args->prop->lists[args->index]);
+  args->prop->lists[args->index] = list;
+  *args->out = list;
+  return Qnil;
+}
+
+static int
+custom_op_prop_list(int index, char ***out, void *state)
+{
+  struct custom_op_prop_list_args args;
+
+  args.prop = (struct custom_op_prop *)state;
+  args.index = index;
+  args.out = out;
+  return mxnet_callback_protect(custom_op_prop_list_body, &args);
+}
+
+static int
+custom_op_prop_list_arguments(char ***out, void *state)
+{
+  return custom_op_prop_list(0, out, state);
+}
+
+static int
+custom_op_prop_list_outputs(char ***out, void *state)
+{
+  return custom_op_prop_list(1, out, state);
+}
+
+static int
+custom_op_prop_list_auxiliary_states(char ***out, void *state)
+{
+  return custom_op_prop_list(2, out, state);
+}
+
+struct custom_op_prop_infer_shape_args {
+  struct custom_op_prop *prop;
+  int num_tensor;
+  int *ndims;
+  int **shapes;
+};
+
+static VALUE
+custom_op_prop_infer_shape_body(VALUE ptr)
+{
+  struct custom_op_prop_infer_shape_args *args = (struct custom_op_prop_infer_shape_args *)ptr;
+  VALUE in_shapes, shapes;
+  int i, j, total_dims;
+  int *data;
+
+  in_shapes = rb_ary_new_capa(args->num_tensor);
+  for (i = 0; i < args->num_tensor; ++i) {
+    rb_ary_push(in_shapes, shape_to_array(args->ndims[i], args->shapes[i]));
+  }
+
+  shapes = rb_funcall(args->prop->live.obj, id_infer_shape_entry, 1, in_shapes);
+  shapes = rb_convert_type(shapes, T_ARRAY, "Array", "to_ary");
+  if (RARRAY_LEN(shapes) != args->num_tensor) {
+    rb_raise(mxnet_eError, "infer_shape returns %ld shapes, but %d are expected",
+             RARRAY_LEN(shapes), args->num_tensor);
+  }
+
+  total_dims = 0;
+  for (i = 0; i < args->num_tensor; ++i) {
+    VALUE shape = rb_convert_type(RARRAY_AREF(shapes, i), T_ARRAY, "Array", "to_ary");
+    rb_ary_store(shapes, i, shape);
+    total_dims += (int)RARRAY_LEN(shape);
+  }
+
+  data = (int *)checked_malloc(sizeof(int) * total_dims);
+  free(args->prop->shape_data);
+  args->prop->shape_data = data;
+
+  for (i = 0; i < args->num_tensor; ++i) {
+    VALUE shape = RARRAY_AREF(shapes, i);
+    int ndim = (int)RARRAY_LEN(shape);
+    for (j = 0; j < ndim; ++j) {
+      data[j] = NUM2INT(RARRAY_AREF(shape, j));
+    }
+    args->ndims[i] = ndim;
+    args->shapes[i] = data;
+    data += ndim;
+  }
+
+  return Qnil;
+}
+
+static int
+custom_op_prop_infer_shape(int num_tensor, int *ndims, int **shapes, void *state)
+{
+  struct custom_op_prop_infer_shape_args args;
+
+  args.prop = (struct custom_op_prop *)state;
+  args.num_tensor = num_tensor;
+  args.ndims = ndims;
+  args.shapes = shapes;
+  return mxnet_callback_protect(custom_op_prop_infer_shape_body, &args);
+}
+
+struct custom_op_prop_infer_type_args {
+  struct custom_op_prop *prop;
+  int num_tensor;
+  int *types;
+};
+
+static VALUE
+custom_op_prop_infer_type_body(VALUE ptr)
+{
+  struct custom_op_prop_infer_type_args *args = (struct custom_op_prop_infer_type_args *)ptr;
+  VALUE types;
+  int i;
+
+  types = int_array_to_array(args->num_tensor, args->types);
+  types = rb_funcall(args->prop->live.obj, id_infer_type_entry, 1, types);
+  types = rb_convert_type(types, T_ARRAY, "Array", "to_ary");
+  if (RARRAY_LEN(types) != args->num_tensor) {
+    rb_raise(mxnet_eError, "infer_type returns %ld types, but %d are expected",
+             RARRAY_LEN(types), args->num_tensor);
+  }
+  for (i = 0; i < args->num_tensor; ++i) {
+    args->types[i] = NUM2INT(RARRAY_AREF(types, i));
+  }
+
+  return Qnil;
+}
+
+static int
+custom_op_prop_infer_type(int num_tensor, int *types, void *state)
+{
+  struct custom_op_prop_infer_type_args args;
+
+  args.prop = (struct custom_op_prop *)state;
+  args.num_tensor = num_tensor;
+  args.types = types;
+  return mxnet_callback_protect(custom_op_prop_infer_type_body, &args);
+}
+
+struct custom_op_prop_bwd_dep_args {
+  struct custom_op_prop *prop;
+  int const *out_grad;
+  int const *in_data;
+  int const *out_data;
+  int *num_deps;
+  int **rdeps;
+};
+
+static VALUE
+custom_op_prop_bwd_dep_body(VALUE ptr)
+{
+  struct custom_op_prop_bwd_dep_args *args = (struct custom_op_prop_bwd_dep_args *)ptr;
+  VALUE obj, arguments, outputs, deps;
+  int i, num_in, num_out, num_deps;
+  int *data;
+
+  obj = args->prop->live.obj;
+  arguments = rb_convert_type(rb_funcall(obj, id_list_arguments, 0), T_ARRAY, "Array", "to_ary");
+  outputs = rb_convert_type(rb_funcall(obj, id_list_outputs, 0), T_ARRAY, "Array", "to_ary");
+  num_in = (int)RARRAY_LEN(arguments);
+  num_out = (int)RARRAY_LEN(outputs);
+
+  deps = rb_funcall(obj, id_declare_backward_dependency, 3,
+                    int_array_to_array(num_out, args->out_grad),
+                    int_array_to_array(num_in, args->in_data),
+                    int_array_to_array(num_out, args->out_data));
+  deps = rb_convert_type(deps, T_ARRAY, "Array", "to_ary");
+  num_deps = (int)RARRAY_LEN(deps);
+
+  data = (int *)checked_malloc(sizeof(int) * num_deps);
+  free(args->prop->deps);
+  args->prop->deps = data;
+  for (i = 0; i < num_deps; ++i) {
+    data[i] = NUM2INT(RARRAY_AREF(deps, i));
+  }
+
+  *args->num_deps = num_deps;
+  *args->rdeps = data;
+  return Qnil;
+}
+
+static int
+custom_op_prop_declare_backward_dependency(int const *out_grad, int const *in_data,
+                                           int const *out_data, int *num_deps,
+                                           int **rdeps, void *state)
+{
+  struct custom_op_prop_bwd_dep_args args;
+
+  args.prop = (struct custom_op_prop *)state;
+  args.out_grad = out_grad;
+  args.in_data = in_data;
+  args.out_data = out_data;
+  args.num_deps = num_deps;
+  args.rdeps = rdeps;
+  return mxnet_callback_protect(custom_op_prop_bwd_dep_body, &args);
+}
+
+struct custom_op_prop_create_operator_args {
+  struct custom_op_prop *prop;
+  char const *ctx;
+  int num_inputs;
+  int **shapes;
+  int const *ndims;
+  int const *dtypes;
+  struct MXCallbackList *ret;
+};
+
+static VALUE
+custom_op_prop_create_operator_body(VALUE ptr)
+{
+  struct custom_op_prop_create_operator_args *args = (struct custom_op_prop_create_operator_args *)ptr;
+  VALUE shapes, op_obj;
+  struct custom_op *op;
+  int i;
+
+  shapes = rb_ary_new_capa(args->num_inputs);
+  for (i = 0; i < args->num_inputs; ++i) {
+    rb_ary_push(shapes, shape_to_array(args->ndims[i], args->shapes[i]));
+  }
+
+  op_obj = rb_funcall(args->prop->live.obj, id_create_operator_entry, 3,
+                      rb_str_new_cstr(args->ctx), shapes,
+                      int_array_to_array(args->num_inputs, args->dtypes));
+
+  op = (struct custom_op *)checked_malloc(sizeof(struct custom_op));
+  op->callbacks[kCustomOpDelete] = (int (*)(void))custom_op_delete;
+  op->callbacks[kCustomOpForward] = (int (*)(void))custom_op_forward;
+  op->callbacks[kCustomOpBackward] = (int (*)(void))custom_op_backward;
+  for (i = 0; i < NUM_OP_CALLBACKS; ++i) {
+    op->contexts[i] = op;
+  }
+  mxnet_live_object_link(&op->live, op_obj);
+
+  args->ret->num_callbacks = NUM_OP_CALLBACKS;
+  args->ret->callbacks = op->callbacks;
+  args->ret->contexts = op->contexts;
+  return Qnil;
+}
+
+static int
+custom_op_prop_create_operator(char const *ctx, int num_inputs, int **shapes,
+                               int const *ndims, int const *dtypes,
+                               struct MXCallbackList *ret, void *state)
+{
+  struct custom_op_prop_create_operator_args args;
+
+  args.prop = (struct custom_op_prop *)state;
+  args.ctx = ctx;
+  args.num_inputs = num_inputs;
+  args.shapes = shapes;
+  args.ndims = ndims;
+  args.dtypes = dtypes;
+  args.ret = ret;
+  return mxnet_callback_protect(custom_op_prop_create_operator_body, &args);
+}
+
+/* ==== Creator ==== */
+
+struct custom_op_prop_creator_args {
+  char const *op_type;
+  int num_kwargs;
+  char const **keys;
+  char const **values;
+  struct MXCallbackList *ret;
+};
+
+static VALUE
+custom_op_prop_creator_body(VALUE ptr)
+{
+  struct custom_op_prop_creator_args *args = (struct custom_op_prop_creator_args *)ptr;
+  VALUE kwargs, prop_obj;
+  struct custom_op_prop *prop;
+  int i;
+
+  kwargs = rb_hash_new();
+  for (i = 0; i < args->num_kwargs; ++i) {
+    rb_hash_aset(kwargs, ID2SYM(rb_intern(args->keys[i])), rb_str_new_cstr(args->values[i]));
+  }
+
+  prop_obj = rb_funcall(mOperator, id_create_prop_entry, 2,
+                        rb_str_new_cstr(args->op_type), kwargs);
+
+  prop = (struct custom_op_prop *)checked_malloc(sizeof(struct custom_op_prop));
+  memset(prop, 0, sizeof(struct custom_op_prop));
+  prop->callbacks[kCustomOpPropDelete] = (int (*)(void))custom_op_prop_delete;
+  prop->callbacks[kCustomOpPropListArguments] = (int (*)(void))custom_op_prop_list_arguments;
+  prop->callbacks[kCustomOpPropListOutputs] = (int (*)(void))custom_op_prop_list_outputs;
+  prop->callbacks[kCustomOpPropListAuxiliaryStates] = (int (*)(void))custom_op_prop_list_auxiliary_states;
+  prop->callbacks[kCustomOpPropInferShape] = (int (*)(void))custom_op_prop_infer_shape;
+  prop->callbacks[kCustomOpPropDeclareBackwardDependency] = (int (*)(void))custom_op_prop_declare_backward_dependency;
+  prop->callbacks[kCustomOpPropCreateOperator] = (int (*)(void))custom_op_prop_create_operator;
+  prop->callbacks[kCustomOpPropInferType] = (int (*)(void))custom_op_prop_infer_type;
+  for (i = 0; i < NUM_PROP_CALLBACKS; ++i) {
+    prop->contexts[i] = prop;
+  }
+  mxnet_live_object_link(&prop->live, prop_obj);
+
+  args->ret->num_callbacks = NUM_PROP_CALLBACKS;
+  args->ret->callbacks = prop->callbacks;
+  args->ret->contexts = prop->contexts;
+  return Qnil;
+}
+
+static int
+custom_op_prop_creator(char const *op_type, int const num_kwargs,
+                       char const **keys, char const **values,
+                       struct MXCallbackList *ret)
+{
+  struct custom_op_prop_creator_args args;
+
+  args.op_type = op_type;
+  args.num_kwargs = num_kwargs;
+  args.keys = keys;
+  args.values = values;
+  args.ret = ret;
+  return mxnet_callback_protect(custom_op_prop_creator_body, &args);
+}
+
+/* Register the creator of the custom operator of the given type to libmxnet.
+ *
+ * @param op_type [String]
+ * @return [nil]
+ */
+static VALUE
+operator_s_register_custom_op(VALUE mod, VALUE op_type)
+{
+  MXNET_API_CHECK(MXCustomOpRegister);
+
+  mxnet_callback_start_server();
+  CHECK_CALL(MXNET_API(MXCustomOpRegister)(StringValueCStr(op_type), custom_op_prop_creator));
+
+  return Qnil;
+}
+
+void
+mxnet_init_operator(void)
+{
+  mOperator = rb_const_get_at(mxnet_mMXNet, rb_intern("Operator"));
+
+  rb_define_singleton_method(mOperator, "_register_custom_op", operator_s_register_custom_op, 1);
+  rb_funcall(mOperator, rb_intern("private_class_method"), 1, ID2SYM(rb_intern("_register_custom_op")));
+
+  id_list_arguments = rb_intern("list_arguments");
+  id_list_outputs = rb_intern("list_outputs");
+  id_list_auxiliary_states = rb_intern("list_auxiliary_states");
+  id_declare_backward_dependency = rb_intern("declare_backward_dependency");
+  id_create_prop_entry = rb_intern("_create_prop_entry");
+  id_infer_shape_entry = rb_intern("_infer_shape_entry");
+  id_infer_type_entry = rb_intern("_infer_type_entry");
+  id_create_operator_entry = rb_intern("_create_operator_entry");
+  id_forward_entry = rb_intern("_forward_entry");
+  id_backward_entry = rb_intern("_backward_entry");
+}
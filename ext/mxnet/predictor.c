@@ -0,0 +1,384 @@
+#include "mxnet_internal.h"
+#include <ruby/thread.h>
+
+VALUE mxnet_cPredictor;
+
+static void
+predictor_free(void *ptr)
+{
+  if (ptr != NULL && !mxnet_is_shutdown()) {
+    MXNET_API(MXPredFree)((PredictorHandle)ptr);
+  }
+}
+
+static size_t
+predictor_memsize(void const *ptr)
+{
+  return 0;
+}
+
+static const rb_data_type_t predictor_data_type = {
+  "MXNet::Predictor",
+  {
+    NULL,
+    predictor_free,
+    predictor_memsize,
+  },
+  0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+PredictorHandle
+mxnet_predictor_get_handle(VALUE obj)
+{
+  PredictorHandle handle;
+  TypedData_Get_Struct(obj, void, &predictor_data_type, handle);
+  if (handle == NULL) {
+    rb_raise(mxnet_eError, "uninitialized predictor");
+  }
+  return handle;
+}
+
+static VALUE
+predictor_allocate(VALUE klass)
+{
+  return TypedData_Wrap_Struct(klass, &predictor_data_type, NULL);
+}
+
+/* The input shapes in the form of the predict API. */
+struct input_shapes {
+  mx_uint num_inputs;
+  char const **keys;
+  mx_uint *indptr;
+  mx_uint *data;
+};
+
+static void
+extract_input_shapes(VALUE keys, VALUE shapes, struct input_shapes *out, VALUE *tmp_strs)
+{
+  mx_uint i, j, num_inputs, num_dims;
+  VALUE keys_str, indptr_str, data_str;
+
+  keys = rb_convert_type(keys, T_ARRAY, "Array", "to_ary");
+  shapes = rb_convert_type(shapes, T_ARRAY, "Array", "to_ary");
+  if (RARRAY_LEN(keys) != RARRAY_LEN(shapes)) {
+    rb_raise(rb_eArgError, "the numbers of the input keys and shapes are different");
+  }
+
+  num_inputs = (mx_uint)RARRAY_LEN(keys);
+  num_dims = 0;
+  for (i = 0; i < num_inputs; ++i) {
+    VALUE shape = rb_convert_type(RARRAY_AREF(shapes, i), T_ARRAY, "Array", "to_ary");
+    num_dims += (mx_uint)RARRAY_LEN(shape);
+  }
+
+  keys_str = rb_str_tmp_new(sizeof(char const *) * num_inputs);
+  indptr_str = rb_str_tmp_new(sizeof(mx_uint) * (num_inputs + 1));
+  data_str = rb_str_tmp_new(sizeof(mx_uint) * num_dims);
+  out->num_inputs = num_inputs;
+  out->keys = (char const **)RSTRING_PTR(keys_str);
+  out->indptr = (mx_uint *)RSTRING_PTR(indptr_str);
+  out->data = (mx_uint *)RSTRING_PTR(data_str);
+
+  out->indptr[0] = 0;
+  for (i = 0; i < num_inputs; ++i) {
+    VALUE key = RARRAY_AREF(keys, i);
+    VALUE shape = RARRAY_AREF(shapes, i);
+    mx_uint k = out->indptr[i];
+
+    out->keys[i] = StringValueCStr(key);
+    for (j = 0; j < (mx_uint)RARRAY_LEN(shape); ++j) {
+      out->data[k + j] = NUM2MXUINT(RARRAY_AREF(shape, j));
+    }
+    out->indptr[i + 1] = k + j;
+  }
+
+  tmp_strs[0] = keys_str;
+  tmp_strs[1] = indptr_str;
+  tmp_strs[2] = data_str;
+}
+
+static void
+check_predict_api(void)
+{
+  MXNET_API_CHECK(MXPredCreate);
+  MXNET_API_CHECK(MXPredReshape);
+  MXNET_API_CHECK(MXPredGetOutputShape);
+  MXNET_API_CHECK(MXPredSetInput);
+  MXNET_API_CHECK(MXPredForward);
+  MXNET_API_CHECK(MXPredGetOutput);
+  MXNET_API_CHECK(MXPredFree);
+}
+
+/* Creates the predictor from the JSON of the symbol and the content of
+ * the params file.
+ *
+ * @param symbol_json [String]
+ * @param params [String]
+ * @param dev_type [Integer]
+ * @param dev_id [Integer]
+ * @param keys [Array<String>]  The names of the inputs.
+ * @param shapes [Array<Array<Integer>>]  The shapes of the inputs.
+ */
+static VALUE
+predictor_create(VALUE obj, VALUE symbol_json, VALUE params, VALUE dev_type, VALUE dev_id, VALUE keys, VALUE shapes)
+{
+  struct input_shapes inputs;
+  VALUE tmp_strs[3];
+  PredictorHandle handle;
+
+  check_predict_api();
+  if (DATA_PTR(obj) != NULL) {
+    rb_raise(rb_eRuntimeError, "predictor is already initialized");
+  }
+
+  StringValueCStr(symbol_json);
+  StringValue(params);
+  if (RSTRING_LEN(params) > INT_MAX) {
+    rb_raise(rb_eArgError, "params is too large (%ld bytes)", RSTRING_LEN(params));
+  }
+  extract_input_shapes(keys, shapes, &inputs, tmp_strs);
+
+  CHECK_CALL(MXNET_API(MXPredCreate)(
+        RSTRING_PTR(symbol_json),
+        RSTRING_PTR(params), (int)RSTRING_LEN(params),
+        NUM2INT(dev_type), NUM2INT(dev_id),
+        inputs.num_inputs, inputs.keys, inputs.indptr, inputs.data,
+        &handle));
+  DATA_PTR(obj) = handle;
+
+  RB_GC_GUARD(symbol_json);
+  RB_GC_GUARD(params);
+  RB_GC_GUARD(tmp_strs[0]);
+  RB_GC_GUARD(tmp_strs[1]);
+  RB_GC_GUARD(tmp_strs[2]);
+
+  return obj;
+}
+
+/* Creates a new predictor for the new input shapes that shares the
+ * parameters with this predictor.
+ *
+ * @param keys [Array<String>]  The names of the inputs.
+ * @param shapes [Array<Array<Integer>>]  The new shapes of the inputs.
+ * @return [Predictor]
+ */
+static VALUE
+predictor_reshape(VALUE obj, VALUE keys, VALUE shapes)
+{
+  struct input_shapes inputs;
+  VALUE tmp_strs[3], other;
+  PredictorHandle handle, new_handle;
+
+  handle = mxnet_predictor_get_handle(obj);
+  extract_input_shapes(keys, shapes, &inputs, tmp_strs);
+
+  other = predictor_allocate(CLASS_OF(obj));
+  CHECK_CALL(MXNET_API(MXPredReshape)(
+        inputs.num_inputs, inputs.keys, inputs.indptr, inputs.data,
+        handle, &new_handle));
+  DATA_PTR(other) = new_handle;
+
+  RB_GC_GUARD(tmp_strs[0]);
+  RB_GC_GUARD(tmp_strs[1]);
+  RB_GC_GUARD(tmp_strs[2]);
+
+  return other;
+}
+
+/* Returns the shape of the output at `index`.
+ *
+ * @param index [Integer]
+ * @return [Array<Integer>]
+ */
+static VALUE
+predictor_output_shape(VALUE obj, VALUE index)
+{
+  PredictorHandle handle;
+  mx_uint *shape, ndim, i;
+  VALUE res;
+
+  handle = mxnet_predictor_get_handle(obj);
+  CHECK_CALL(MXNET_API(MXPredGetOutputShape)(handle, NUM2MXUINT(index), &shape, &ndim));
+
+  res = rb_ary_new_capa(ndim);
+  for (i = 0; i < ndim; ++i) {
+    rb_ary_push(res, MXUINT2NUM(shape[i]));
+  }
+  return res;
+}
+
+static size_t
+predictor_output_size(PredictorHandle handle, mx_uint index)
+{
+  mx_uint *shape, ndim, i;
+  size_t size = 1;
+
+  CHECK_CALL(MXNET_API(MXPredGetOutputShape)(handle, index, &shape, &ndim));
+  for (i = 0; i < ndim; ++i) {
+    size *= shape[i];
+  }
+  return size;
+}
+
+/* Copies `size` float32 values at `data` to the input named `key`. */
+void
+mxnet_predictor_set_input(VALUE obj, VALUE key, void const *data, size_t size)
+{
+  PredictorHandle handle;
+
+  handle = mxnet_predictor_get_handle(obj);
+  if (RB_TYPE_P(key, T_SYMBOL)) {
+    key = rb_sym_to_s(key);
+  }
+  if (size > UINT_MAX) {
+    rb_raise(rb_eArgError, "input is too large (%"PRIuSIZE" elements)", size);
+  }
+  CHECK_CALL(MXNET_API(MXPredSetInput)(
+        handle, StringValueCStr(key), (mx_float const *)data, (mx_uint)size));
+  RB_GC_GUARD(key);
+}
+
+struct get_output_params {
+  PredictorHandle handle;
+  mx_uint index;
+  void *data;
+  mx_uint size;
+  int result;
+};
+
+static void *
+predictor_get_output_without_gvl(void *ptr)
+{
+  struct get_output_params *params = (struct get_output_params *)ptr;
+  params->result = MXNET_API(MXPredGetOutput)(
+      params->handle, params->index, (mx_float *)params->data, params->size);
+  return NULL;
+}
+
+static int
+predictor_get_output_0(PredictorHandle handle, mx_uint index, void *data, size_t size)
+{
+  struct get_output_params params;
+
+  params.handle = handle;
+  params.index = index;
+  params.data = data;
+  params.size = (mx_uint)size;
+  rb_thread_call_without_gvl(predictor_get_output_without_gvl, &params, NULL, NULL);
+  return params.result;
+}
+
+/* Waits for the output at `index`, and copies it to `data` that can
+ * hold `size` float32 values.
+ *
+ * The GVL is released while waiting, so `data` must not be a memory
+ * that can be moved by GC. */
+void
+mxnet_predictor_get_output(VALUE obj, mx_uint index, void *data, size_t size)
+{
+  PredictorHandle handle;
+
+  handle = mxnet_predictor_get_handle(obj);
+  if (predictor_output_size(handle, index) != size) {
+    rb_raise(rb_eArgError, "the size of the buffer does not match the output");
+  }
+  CHECK_CALL(predictor_get_output_0(handle, index, data, size));
+}
+
+/* Sets the input named `key` from a String holding raw float32 values.
+ *
+ * @param key [String, Symbol]
+ * @param data [String]
+ */
+static VALUE
+predictor_set_input(VALUE obj, VALUE key, VALUE data)
+{
+  StringValue(data);
+  if (RSTRING_LEN(data) % sizeof(mx_float) != 0) {
+    rb_raise(rb_eArgError, "the length of the data is not a multiple of %d", (int)sizeof(mx_float));
+  }
+  mxnet_predictor_set_input(obj, key, RSTRING_PTR(data), RSTRING_LEN(data) / sizeof(mx_float));
+  RB_GC_GUARD(data);
+  return obj;
+}
+
+/* Copies the output at `index` into the String `out` as raw float32
+ * values.  `out` is resized to fit the output.
+ *
+ * @param index [Integer]
+ * @param out [String]
+ * @return [String] out
+ */
+static VALUE
+predictor_get_output(VALUE obj, VALUE index_v, VALUE out)
+{
+  PredictorHandle handle;
+  mx_uint index;
+  size_t size;
+  int result;
+
+  handle = mxnet_predictor_get_handle(obj);
+  index = NUM2MXUINT(index_v);
+  size = predictor_output_size(handle, index);
+
+  StringValue(out);
+  rb_str_modify(out);
+  rb_str_resize(out, (long)(size * sizeof(mx_float)));
+  rb_str_locktmp(out);
+  result = predictor_get_output_0(handle, index, RSTRING_PTR(out), size);
+  rb_str_unlocktmp(out);
+  CHECK_CALL(result);
+
+  return out;
+}
+
+struct forward_params {
+  PredictorHandle handle;
+  int result;
+};
+
+static void *
+predictor_forward_without_gvl(void *ptr)
+{
+  struct forward_params *params = (struct forward_params *)ptr;
+  params->result = MXNET_API(MXPredForward)(params->handle);
+  return NULL;
+}
+
+/* Runs the forward computation.
+ *
+ * The GVL is released during the computation.
+ *
+ * @return [Predictor] self
+ */
+static VALUE
+predictor_forward(VALUE obj)
+{
+  struct forward_params params;
+
+  params.handle = mxnet_predictor_get_handle(obj);
+  rb_thread_call_without_gvl(predictor_forward_without_gvl, &params, NULL, NULL);
+  CHECK_CALL(params.result);
+
+  return obj;
+}
+
+void
+mxnet_init_predictor(void)
+{
+  VALUE cPredictor;
+
+  cPredictor = rb_const_get_at(mxnet_mMXNet, rb_intern("Predictor"));
+
+  rb_define_alloc_func(cPredictor, predictor_allocate);
+
+  rb_define_method(cPredictor, "output_shape", predictor_output_shape, 1);
+
+  rb_define_private_method(cPredictor, "_create", predictor_create, 6);
+  rb_define_private_method(cPredictor, "_reshape", predictor_reshape, 2);
+  rb_define_private_method(cPredictor, "_set_input", predictor_set_input, 2);
+  rb_define_private_method(cPredictor, "_get_output", predictor_get_output, 2);
+  rb_define_private_method(cPredictor, "_forward", predictor_forward, 0);
+
+  mxnet_cPredictor = cPredictor;
+}
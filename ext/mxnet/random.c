@@ -1,10 +1,49 @@
 #include "mxnet_internal.h"
 
+/* Seeds the random number generators.
+ *
+ * @param seed_state [Integer]  The seed.
+ * @param ctx [Context, :all]  The context whose generators are seeded.
+ *   All the generators of all the contexts are seeded by default.
+ */
 static VALUE
-random_m_set_seed(VALUE mod, VALUE seed_state)
+random_m_set_seed(int argc, VALUE *argv, VALUE mod)
 {
+  VALUE seed_state, opts, ctx_v = Qnil;
+  int seed;
+
+  rb_scan_args(argc, argv, "1:", &seed_state, &opts);
+  if (!NIL_P(opts)) {
+    static ID keywords[1];
+    VALUE vals[1];
+
+    if (keywords[0] == 0) {
+      keywords[0] = rb_intern("ctx");
+    }
+
+    rb_get_kwargs(opts, keywords, 0, 1, vals);
+    if (vals[0] != Qundef) {
+      ctx_v = vals[0];
+    }
+  }
+
   seed_state = rb_check_to_int(seed_state);
-  CHECK_CALL(MXNET_API(MXRandomSeed)(NUM2INT(seed_state)));
+  seed = NUM2INT(seed_state);
+
+  if (NIL_P(ctx_v) || (SYMBOL_P(ctx_v) && SYM2ID(ctx_v) == rb_intern("all"))) {
+    CHECK_CALL(MXNET_API(MXRandomSeed)(seed));
+  }
+  else {
+    if (!RTEST(rb_obj_is_kind_of(ctx_v, mxnet_cContext))) {
+      rb_raise(rb_eTypeError, "ctx must be a MXNet::Context or :all");
+    }
+    MXNET_API_CHECK(MXRandomSeedContext);
+    CHECK_CALL(MXNET_API(MXRandomSeedContext)(
+          seed,
+          mxnet_context_get_device_type_id(ctx_v),
+          mxnet_context_get_device_id(ctx_v)));
+  }
+
   return Qnil;
 }
 
@@ -14,5 +53,5 @@ mxnet_init_random(void)
   VALUE mRandom;
 
   mRandom = rb_define_module_under(mxnet_mMXNet, "Random");
-  rb_define_module_function(mRandom, "seed", random_m_set_seed, 1);
+  rb_define_module_function(mRandom, "seed", random_m_set_seed, -1);
 }
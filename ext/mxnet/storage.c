@@ -0,0 +1,65 @@
+#include "mxnet_internal.h"
+
+/* Releases the memory cached by the storage pool of the context.
+ *
+ * The memory of the freed arrays is kept by the pool of libmxnet for the
+ * later allocations, and is returned to the system by this method.
+ *
+ * @param ctx [Context]
+ * @return [nil]
+ */
+static VALUE
+storage_m_empty_cache(VALUE mod, VALUE ctx)
+{
+  MXNET_API_CHECK(MXStorageEmptyCache);
+
+  mxnet_check_type(ctx, mxnet_cContext);
+  CHECK_CALL(MXNET_API(MXStorageEmptyCache)(
+        mxnet_context_get_device_type_id(ctx),
+        mxnet_context_get_device_id(ctx)));
+
+  return Qnil;
+}
+
+/* Returns the number of the GPUs, or 0 if libmxnet is built without CUDA.
+ *
+ * @return [Integer]
+ */
+static VALUE
+storage_m_gpu_count(VALUE mod)
+{
+  int count;
+
+  MXNET_API_CHECK(MXGetGPUCount);
+  CHECK_CALL(MXNET_API(MXGetGPUCount)(&count));
+
+  return INT2NUM(count);
+}
+
+/* Returns the free and the total memory of the GPU in bytes.
+ *
+ * @param dev_id [Integer]
+ * @return [Array(Integer, Integer)]
+ */
+static VALUE
+storage_m_gpu_memory_info(VALUE mod, VALUE dev_id)
+{
+  uint64_t free_mem, total_mem;
+
+  MXNET_API_CHECK(MXGetGPUMemoryInformation64);
+  CHECK_CALL(MXNET_API(MXGetGPUMemoryInformation64)(NUM2INT(dev_id), &free_mem, &total_mem));
+
+  return rb_assoc_new(ULL2NUM(free_mem), ULL2NUM(total_mem));
+}
+
+void
+mxnet_init_storage(void)
+{
+  VALUE mStorage;
+
+  mStorage = rb_const_get_at(mxnet_mMXNet, rb_intern("Storage"));
+
+  rb_define_module_function(mStorage, "empty_cache", storage_m_empty_cache, 1);
+  rb_define_module_function(mStorage, "gpu_count", storage_m_gpu_count, 0);
+  rb_define_module_function(mStorage, "gpu_memory_info", storage_m_gpu_memory_info, 1);
+}
@@ -100,6 +100,32 @@ symbol_list_arguments(VALUE obj)
   return res;
 }
 
+/* Lists all the inputs in the symbol, the arguments and the auxiliary
+ * states, in the order of the inputs of `CachedOp`.
+ *
+ * @return [Array<Symbol>]
+ */
+static VALUE
+symbol_list_inputs(VALUE obj)
+{
+  void *handle;
+  mx_uint i, size;
+  char const **inputs;
+  VALUE res;
+
+  MXNET_API_CHECK(NNSymbolListInputNames);
+
+  handle = mxnet_get_handle(obj);
+  CHECK_CALL(MXNET_API(NNSymbolListInputNames)(handle, 0, &size, &inputs));
+
+  res = rb_ary_new_capa(size);
+  for (i = 0; i < size; ++i) {
+    rb_ary_push(res, ID2SYM(rb_intern(inputs[i])));
+  }
+
+  return res;
+}
+
 /* List all the auxiliary states in the symbol.
  *
  * Example:
@@ -726,6 +752,99 @@ symbol_bind(int argc, VALUE *argv, VALUE obj)
   return executor;
 }
 
+/* Groups the symbols into a symbol with all of their outputs.
+ *
+ * @param symbols [Array<Symbol>]
+ * @return [Symbol]
+ */
+static VALUE
+symbol_s_group(VALUE klass, VALUE symbols)
+{
+  SymbolHandle *handles, out;
+  VALUE handles_str;
+  long i, num_symbols;
+
+  symbols = rb_convert_type(symbols, T_ARRAY, "Array", "to_ary");
+  num_symbols = RARRAY_LEN(symbols);
+  handles_str = rb_str_tmp_new(sizeof(SymbolHandle) * num_symbols);
+  handles = (SymbolHandle *)RSTRING_PTR(handles_str);
+  for (i = 0; i < num_symbols; ++i) {
+    VALUE sym = RARRAY_AREF(symbols, i);
+    mxnet_check_type(sym, mxnet_cSymbol);
+    handles[i] = mxnet_get_handle(sym);
+  }
+
+  CHECK_CALL(MXNET_API(MXSymbolCreateGroup)((mx_uint)num_symbols, handles, &out));
+
+  RB_GC_GUARD(symbols);
+  RB_GC_GUARD(handles_str);
+
+  return mxnet_symbol_new(out);
+}
+
+/* Returns the symbol of an output.
+ *
+ * @param index [Integer, String, Symbol]  The index or the name of the
+ *   output.
+ * @return [Symbol]
+ */
+static VALUE
+symbol_aref(VALUE obj, VALUE index)
+{
+  SymbolHandle handle, out;
+  VALUE outputs;
+  long i, num_outputs;
+
+  handle = mxnet_get_handle(obj);
+  outputs = mxnet_symbol_list_outputs(obj);
+  num_outputs = RARRAY_LEN(outputs);
+
+  if (RB_TYPE_P(index, T_STRING) || RB_TYPE_P(index, T_SYMBOL)) {
+    VALUE name = rb_to_symbol(index);
+    for (i = 0; i < num_outputs; ++i) {
+      if (RARRAY_AREF(outputs, i) == name) {
+        break;
+      }
+    }
+    if (i == num_outputs) {
+      rb_raise(rb_eArgError, "no output named %"PRIsVALUE, index);
+    }
+  }
+  else {
+    i = NUM2LONG(index);
+    if (i < 0) {
+      i += num_outputs;
+    }
+    if (i < 0 || i >= num_outputs) {
+      rb_raise(rb_eIndexError, "index %ld is out of the outputs (%ld)", NUM2LONG(index), num_outputs);
+    }
+  }
+
+  CHECK_CALL(MXNET_API(MXSymbolGetOutput)(handle, (mx_uint)i, &out));
+
+  return mxnet_symbol_new(out);
+}
+
+/* Returns the symbol whose outputs are all the internal outputs of this
+ * symbol, including the variables, in the topological order.
+ *
+ *     > fc = MXNet::Symbol.FullyConnected(data: MXNet.var(:data), num_hidden: 2, name: :fc)
+ *     > fc.get_internals.list_outputs
+ *     [:data, :fc_weight, :fc_bias, :fc_output]
+ *
+ * @return [Symbol]
+ */
+static VALUE
+symbol_get_internals(VALUE obj)
+{
+  SymbolHandle handle, out;
+
+  handle = mxnet_get_handle(obj);
+  CHECK_CALL(MXNET_API(MXSymbolGetInternals)(handle, &out));
+
+  return mxnet_symbol_new(out);
+}
+
 static VALUE
 symbol_dup(VALUE obj)
 {
@@ -933,11 +1052,13 @@ mxnet_init_symbol(void)
 
   rb_define_singleton_method(cSymbol, "load", symbol_s_load, 1);
   rb_define_singleton_method(cSymbol, "load_json", symbol_s_load_json, 1);
+  rb_define_singleton_method(cSymbol, "group", symbol_s_group, 1);
 
   rb_define_method(cSymbol, "initialize", symbol_initialize, 1);
   rb_define_method(cSymbol, "name", symbol_get_name, 0);
   rb_define_method(cSymbol, "list_arguments", symbol_list_arguments, 0);
   rb_define_method(cSymbol, "list_auxiliary_states", symbol_list_auxiliary_states, 0);
+  rb_define_method(cSymbol, "list_inputs", symbol_list_inputs, 0);
   rb_define_method(cSymbol, "list_outputs", mxnet_symbol_list_outputs, 0);
   rb_define_method(cSymbol, "attributes", symbol_attributes, 0);
   rb_define_method(cSymbol, "attr", symbol_attr, 1);
@@ -946,6 +1067,8 @@ mxnet_init_symbol(void)
   rb_define_method(cSymbol, "to_json", symbol_to_json, 0);
   rb_define_method(cSymbol, "bind", symbol_bind, -1);
   rb_define_method(cSymbol, "dup", symbol_dup, 0);
+  rb_define_method(cSymbol, "[]", symbol_aref, 1);
+  rb_define_method(cSymbol, "get_internals", symbol_get_internals, 0);
 
   rb_define_private_method(cSymbol, "set_attributes", symbol_set_attributes, -1);
   rb_define_private_method(cSymbol, "infer_shape_impl", symbol_infer_shape_impl, -1);
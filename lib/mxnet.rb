@@ -11,24 +11,41 @@ module MXNet
   def None.inspect
     'None'
   end
+  None.freeze
 
   require 'mxnet/libmxnet'
   require 'mxnet/attribute'
   require 'mxnet/autograd'
+  require 'mxnet/autograd/function'
+  require 'mxnet/autograd/gradient_accumulator'
+  require 'mxnet/cached_op'
   require 'mxnet/context'
   require 'mxnet/name/name_manager'
+  require 'mxnet/engine'
   require 'mxnet/executor'
+  require 'mxnet/executor/memory_report'
+  require 'mxnet/future'
   require 'mxnet/io'
   require 'mxnet/metric'
+  require 'mxnet/model'
+  require 'mxnet/monitor'
   require 'mxnet/ndarray'
   require 'mxnet/ndarray/operation_delegator'
+  require 'mxnet/ndarray/params_reader'
+  require 'mxnet/operator'
+  require 'mxnet/predictor'
+  require 'mxnet/serving/latency_stats'
+  require 'mxnet/serving/batcher'
   require 'mxnet/symbol'
   require 'mxnet/symbol/operation_delegator'
   require 'mxnet/random'
+  require 'mxnet/storage'
   require 'mxnet/utils'
   require 'mxnet/op_info'
   require 'mxnet.so'
   require 'mxnet/ndarray/operations'
   require 'mxnet/symbol/operations'
+  require 'mxnet/tracer'
+  require 'mxnet/ndarray/lazy'
   require 'mxnet/lr_scheduler'
 end
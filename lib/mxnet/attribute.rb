@@ -1,13 +1,18 @@
 module MXNet
   class AttrScope
+    # The key of the stack of the entered scopes in the fiber-local storage.
+    STACK_KEY = :__mxnet_attr_scope_stack__
+
     @current = nil
 
+    # Returns the scope entered last in the current fiber, or the default
+    # empty scope.
     def self.current
-      @current
+      stack = Thread.current[STACK_KEY]
+      (stack && stack.last) || @current
     end
 
     def initialize(**kwargs)
-      @old_scope = nil
       kwargs.each_value do |v|
         raise ArgumentError, "attributes need to be string" unless v.kind_of?(String) or v.kind_of?(Symbol)
       end
@@ -27,6 +32,35 @@ module MXNet
       end
     end
 
-    @current = self.new
+    # Make this scope current.  The attributes of the outer scope are
+    # inherited unless they are overridden by this scope.
+    #
+    # When a block is given, the scope is exited after the block.
+    def enter
+      unless block_given?
+        outer = AttrScope.current
+        @attr = outer.get(@attr) if outer
+        (Thread.current[STACK_KEY] ||= []).push(self)
+        return self
+      end
+      begin
+        enter
+        yield
+      ensure
+        exit
+      end
+    end
+
+    def exit
+      stack = Thread.current[STACK_KEY]
+      unless stack && stack.last.equal?(self)
+        raise "#{self.class} is not the current scope"
+      end
+      stack.pop
+    end
+
+    # The default scope has no attribute and is never modified, so it is
+    # shared among Ractors.
+    @current = defined?(::Ractor) ? ::Ractor.make_shareable(self.new) : self.new.freeze
   end
 end
@@ -1,39 +1,79 @@
 module MXNet
   module Autograd
-    def self.with_recording_state(is_record, train_mode)
-      unless is_record.nil?
-        prev_is_record = self.set_recording(is_record)
-      end
-      unless train_mode.nil?
-        prev_train_mode = self.set_training(train_mode)
+    # Mark the arrays as the variables to compute the gradients for, like
+    # `NDArray#attach_grad` for each array, with a single call of libmxnet.
+    #
+    #     grads = MXNet::Autograd.mark_variables(params, flat: true)
+    #
+    # @param arrays [Array<NDArray>]  The variables.
+    # @param grads [Array<NDArray>, nil]  The gradient buffers.  When nil,
+    #   zero-filled buffers are allocated.
+    # @param grad_reqs [Symbol, Array<Symbol>]  How the gradients are
+    #   accumulated, `:write`, `:add` or `:null`, for all or each of the
+    #   variables.
+    # @param flat [true, false]  Whether to allocate the gradient buffers
+    #   as the views of a single flat array.  The flat array is one
+    #   allocation, and can be updated or cleared as a whole.  The
+    #   variables must be on the same context and of the same dtype.
+    # @return [Array<NDArray>] The gradient buffers.
+    def self.mark_variables(arrays, grads: nil, grad_reqs: :write, flat: false)
+      arrays = arrays.to_a
+      grad_reqs = [grad_reqs] * arrays.length unless grad_reqs.is_a?(Array)
+      if grads.nil?
+        grads = flat ? allocate_flat_grads(arrays) : arrays.map {|a| NDArray.zeros_like(a) }
       end
+      _mark_variables(arrays, grads, grad_reqs)
+      grads
+    end
 
-      yield
-    ensure
-      if !is_record.nil? && prev_is_record != is_record
-        self.set_recording(prev_is_record)
+    def self.allocate_flat_grads(arrays)
+      return [] if arrays.empty?
+      ctx = arrays[0].context
+      dtype = arrays[0].dtype
+      arrays.each do |a|
+        unless a.context == ctx && a.dtype == dtype
+          raise ArgumentError, "flat gradients need the variables on the same context and of the same dtype"
+        end
       end
-      if !train_mode.nil? && prev_train_mode != train_mode
-        self.set_training(prev_train_mode)
-      end
-    end
-    private_class_method :with_recording_state
 
-    # Make autograd recording scope in the given block.
-    def self.record(train_mode=true, &block)
-      with_recording_state(true, train_mode, &block)
+      sizes = arrays.map {|a| a.shape.inject(1, :*) }
+      buffer = NDArray.zeros([sizes.sum], ctx, dtype)
+      offset = 0
+      arrays.zip(sizes).map do |a, size|
+        grad = buffer[offset...(offset + size)].reshape(a.shape)
+        offset += size
+        grad
+      end
     end
+    private_class_method :allocate_flat_grads
 
-    def self.pause(train_mode=false, &block)
-      with_recording_state(false, train_mode, &block)
-    end
+    # Reset the gradients of the arrays to zeros.
+    #
+    # The gradients on each context are reset by one invocation of the
+    # `reset_arrays` operator.  With a libmxnet without the operator, each
+    # gradient is filled by one operation.
+    #
+    # @param arrays [Array<NDArray>]  The variables whose gradients are reset.
+    #   The arrays without gradient buffers are ignored.
+    # @return [nil]
+    def self.zero_grad(arrays)
+      grads = arrays.map(&:grad).compact
+      return if grads.empty?
 
-    def self.train_mode(&block)
-      with_recording_state(nil, true, &block)
+      if NDArray::Ops.respond_to?(:reset_arrays)
+        grads.group_by(&:context).each_value do |same_ctx_grads|
+          NDArray::Ops.reset_arrays(*same_ctx_grads, num_arrays: same_ctx_grads.length)
+        end
+      else
+        grads.each {|grad| grad[0..-1] = 0 }
+      end
+      nil
     end
 
-    def self.predict_mode(&block)
-      with_recording_state(nil, false, &block)
-    end
+    # NATIVE: self.record
+    # NATIVE: self.pause
+    # NATIVE: self.train_mode
+    # NATIVE: self.predict_mode
+    # NATIVE: Recorder
   end
 end
@@ -0,0 +1,99 @@
+module MXNet
+  module Autograd
+    # Function is a computation with a hand-written gradient.
+    #
+    # The computation of `forward` is not recorded.  Instead, a single
+    # node calling `backward` is recorded from the inputs to the outputs,
+    # so the gradient is the one given by `backward`, and none of the
+    # operations in `forward` is kept in the graph.
+    #
+    #     class Sigmoid < MXNet::Autograd::Function
+    #       def forward(x)
+    #         y = 1.0 / (1.0 + MXNet::NDArray.exp(-x))
+    #         save_for_backward(y)
+    #         y
+    #       end
+    #
+    #       def backward(dy)
+    #         y, = saved_tensors
+    #         dy * y * (1.0 - y)
+    #       end
+    #     end
+    #
+    #     x.attach_grad
+    #     y = MXNet::Autograd.record { Sigmoid.new.(x) }
+    #     y.backward
+    #
+    # A function object can be called only once.  `backward` is called
+    # from the worker threads of libmxnet, as the custom operators in
+    # `MXNet::Operator` are.
+    class Function
+      def initialize
+        @used = false
+        @saved_tensors = []
+      end
+
+      # The arrays saved by `save_for_backward`.
+      attr_reader :saved_tensors
+
+      # Save the arrays used by `backward`.
+      def save_for_backward(*arrays)
+        @saved_tensors = arrays
+      end
+
+      # Compute the outputs from the inputs.
+      #
+      # @param inputs [Array<NDArray>]
+      # @return [NDArray, Array<NDArray>]
+      def forward(*inputs)
+        raise NotImplementedError
+      end
+
+      # Compute the gradients of the inputs from the gradients of the outputs.
+      #
+      # @param output_grads [Array<NDArray>]
+      # @return [NDArray, Array<NDArray>] The gradients of the inputs.
+      def backward(*output_grads)
+        raise NotImplementedError
+      end
+
+      # Run `forward`, and record the node of this function while recording.
+      #
+      # @param inputs [Array<NDArray>]
+      # @return [NDArray, Array<NDArray>] The outputs of `forward`.
+      def call(*inputs)
+        raise ArgumentError, "Each Function instance can only be called once" if @used
+        @used = true
+
+        recording = Autograd.recording?
+        outputs = recording ? Autograd.pause(nil) { forward(*inputs) } : forward(*inputs)
+        return outputs unless recording
+
+        Autograd.send(:_record_custom_function, self, inputs,
+                      outputs.is_a?(NDArray) ? [outputs] : outputs)
+        outputs
+      end
+
+      private
+
+      def _backward_entry(output_grads, input_grads, reqs)
+        rets = backward(*output_grads)
+        rets = [rets] if rets.is_a?(NDArray)
+        unless rets.length == input_grads.length
+          raise ArgumentError,
+            "#{self.class}#backward must return #{input_grads.length} gradients, but #{rets.length}"
+        end
+        input_grads.zip(rets, reqs) do |igrad, ret, req|
+          case req
+          when 0 # null
+            next
+          when 1, 2 # write, inplace
+            igrad[0..-1] = ret
+          when 3 # add
+            igrad.inplace + ret
+          end
+        end
+      end
+    end
+  end
+end
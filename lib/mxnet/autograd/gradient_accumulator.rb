@@ -0,0 +1,78 @@
+module MXNet
+  module Autograd
+    # GradientAccumulator accumulates the gradients of several micro-batches
+    # and updates the parameters once per `steps` micro-batches.
+    #
+    # The effective batch size becomes `steps` times the micro-batch size,
+    # while the memory for the activations is that of a micro-batch.
+    #
+    #     accumulator = MXNet::Autograd::GradientAccumulator.new(params, steps: 8) do |params, grads|
+    #       params.zip(grads) {|w, g| w.inplace - g * lr }
+    #     end
+    #     data_iter.each do |batch|
+    #       accumulator.step { loss_func.(net.(batch.data[0]), batch.label[0]) }
+    #     end
+    #     accumulator.flush
+    #
+    class GradientAccumulator
+      # @param params [Array<NDArray>]  The parameters.  They are marked as the
+      #   variables with the gradient request `:add`.
+      # @param steps [Integer]  The number of micro-batches per update.
+      # @param average [true, false]  Whether to average the gradients of the
+      #   micro-batches instead of summing them.
+      # @param flat [true, false]  Whether to allocate the gradient buffers
+      #   as the views of a single flat array.  See `Autograd.mark_variables`.
+      # @yieldparam params [Array<NDArray>]  The parameters.
+      # @yieldparam grads [Array<NDArray>]  The accumulated gradients.
+      def initialize(params, steps:, average: true, flat: false, &update)
+        raise ArgumentError, "steps must be positive" unless steps > 0
+        raise ArgumentError, "no block given for the update" unless update
+
+        @params = params.to_a
+        @steps = steps
+        @scale = average ? 1.0 / steps : nil
+        @update = update
+        @grads = Autograd.mark_variables(@params, grad_reqs: :add, flat: flat)
+        @count = 0
+      end
+
+      attr_reader :params, :grads, :steps
+
+      # The number of the micro-batches accumulated since the last update.
+      attr_reader :count
+
+      # Run the forward computation of a micro-batch given by the block
+      # while recording, and accumulate its gradients.  The parameters are
+      # updated when `steps` micro-batches are accumulated.
+      #
+      # @return [NDArray] The loss returned by the block.
+      def step
+        loss = Autograd.record { yield }
+        if @scale
+          Autograd.backward(loss, head_grads: NDArray.full(loss.shape, @scale, ctx: loss.context, dtype: loss.dtype))
+        else
+          Autograd.backward(loss)
+        end
+        @count += 1
+        flush if @count == @steps
+        loss
+      end
+
+      # Update the parameters with the gradients accumulated so far, and
+      # reset the gradients.  Nothing is done when no micro-batch is
+      # accumulated.  With `average: true`, the gradients are averaged over
+      # the micro-batches accumulated, even if they are fewer than `steps`.
+      def flush
+        return self if @count == 0
+        if @scale && @count != @steps
+          factor = @steps.fdiv(@count)
+          @grads.each {|grad| grad.inplace * factor }
+        end
+        @update.call(@params, @grads)
+        Autograd.zero_grad(@params)
+        @count = 0
+        self
+      end
+    end
+  end
+end
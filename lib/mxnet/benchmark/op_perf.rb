@@ -0,0 +1,284 @@
+require 'json'
+require 'time'
+require 'mxnet'
+
+module MXNet
+  module Benchmark
+    # Benchmarks the operators registered in libmxnet through the NDArray
+    # API.
+    #
+    # The inputs of each operator are generated from its `OpInfo`: every
+    # NDArray argument is given a random array of the benchmarked shape and
+    # dtype (two arrays for a variable number of inputs), and the required
+    # parameters are given the simplest value of their types.  The
+    # operators whose required parameters cannot be generated are reported
+    # as skipped, unless their parameters or inputs are given.
+    #
+    #     perf = MXNet::Benchmark::OpPerf.new(ops: [:relu, :sum], shapes: [[1024, 1024]])
+    #     perf.run
+    #     File.write('op_perf.json', perf.to_json)
+    #     puts perf.to_markdown
+    #
+    # The times of each operator are measured in seconds as:
+    #
+    # forward::      A call and the wait for its outputs.
+    # dispatch::     A call without waiting.  libmxnet runs the kernels
+    #                asynchronously, so this is the cost of the call from
+    #                Ruby.
+    # raw_dispatch:: A call of `LibMXNet.imperative_invoke` with the
+    #                arguments converted in advance, which is the cost of
+    #                the C API.
+    # backward::     The backward of the recorded forward, or nil if the
+    #                operator is not differentiable.
+    #
+    # The binding overhead is `dispatch - raw_dispatch`, the time spent in
+    # the operation delegator, and the kernel time is approximated by
+    # `forward - dispatch`, which includes the scheduling of the engine.
+    class OpPerf
+      Result = Struct.new(:op, :shape, :dtype, :forward, :dispatch, :raw_dispatch, :backward, :error) do
+        # The time spent in the Ruby side of the call.
+        def binding_overhead
+          dispatch - raw_dispatch if dispatch && raw_dispatch
+        end
+
+        # The time from the return of the call to the completion of the
+        # outputs.
+        def kernel
+          [forward - dispatch, 0.0].max if forward && dispatch
+        end
+
+        def ok?
+          error.nil?
+        end
+
+        # Returns the result with the times in microseconds.
+        def to_h
+          {
+            op: op.to_s,
+            shape: shape,
+            dtype: dtype.to_s,
+            forward_us: us(forward),
+            kernel_us: us(kernel),
+            dispatch_us: us(dispatch),
+            raw_dispatch_us: us(raw_dispatch),
+            binding_overhead_us: us(binding_overhead),
+            backward_us: us(backward),
+            error: error
+          }
+        end
+
+        private
+
+        def us(seconds)
+          seconds && (seconds * 1e6).round(3)
+        end
+      end
+
+      DEFAULT_SHAPES = [[1024], [256, 256]].freeze
+      DEFAULT_DTYPES = [:float32].freeze
+
+      # The operators that cannot run with the generated inputs.
+      SKIPPED_OPS = [:Custom].freeze
+
+      # @param ops [Array<Symbol>, nil]  The names of the operators in
+      #   `NDArray::Ops`.  All the operators by default.
+      # @param shapes [Array<Array<Integer>>]  The shapes of the inputs.
+      # @param dtypes [Array<Symbol>]  The dtypes of the inputs.
+      # @param ctx [Context]  The context of the inputs.
+      # @param warmup [Integer]  The number of the calls before measuring.
+      # @param runs [Integer]  The number of the measured calls.
+      # @param backward [true, false]  Whether to measure the backward.
+      # @param params [Hash{Symbol => Hash}]  The parameters of the
+      #   operators, which override the generated ones.
+      # @param inputs [Hash{Symbol => #call}]  The generators of the inputs
+      #   of the operators, called with the shape and the dtype, and
+      #   returning an Array of NDArrays.
+      def initialize(ops: nil, shapes: DEFAULT_SHAPES, dtypes: DEFAULT_DTYPES, ctx: nil,
+                     warmup: 5, runs: 50, backward: true, params: {}, inputs: {})
+        @ops = (ops || NDArray::Ops.methods(false).sort - SKIPPED_OPS).map(&:to_sym)
+        @shapes = shapes
+        @dtypes = dtypes
+        @ctx = ctx || Context.default
+        @warmup = warmup
+        @runs = runs
+        @backward = backward
+        @params = params
+        @inputs = inputs
+        @results = []
+      end
+
+      attr_reader :results
+
+      # Run the benchmarks.
+      #
+      # @yield [result]  Called with each result.
+      # @return [Array<Result>]
+      def run
+        @results = []
+        @ops.each do |op|
+          info = OpInfo.lookup(NDArray::Ops, op)
+          @dtypes.each do |dtype|
+            @shapes.each do |shape|
+              result = benchmark_op(info, shape, dtype)
+              @results << result
+              yield result if block_given?
+            end
+          end
+        end
+        @results
+      end
+
+      def to_json(*)
+        JSON.pretty_generate({
+          metadata: {
+            mxnet_rb_version: MXNet::VERSION,
+            ruby_version: RUBY_VERSION,
+            ctx: @ctx.to_s,
+            warmup: @warmup,
+            runs: @runs,
+            time: Time.now.iso8601
+          },
+          results: @results.map(&:to_h)
+        })
+      end
+
+      def to_markdown
+        lines = []
+        lines << '| op | shape | dtype | forward [us] | kernel [us] | dispatch [us] | binding [us] | backward [us] | note |'
+        lines << '|---|---|---|---:|---:|---:|---:|---:|---|'
+        @results.each do |r|
+          h = r.to_h
+          cells = [h[:op], r.shape.inspect, h[:dtype]]
+          cells.concat(%i[forward_us kernel_us dispatch_us binding_overhead_us backward_us].map {|k| format_us(h[k]) })
+          cells << (r.error ? r.error.gsub('|', '\|').lines.first.to_s.chomp : '')
+          lines << "| #{cells.join(' | ')} |"
+        end
+        lines.join("\n") + "\n"
+      end
+
+      private
+
+      def benchmark_op(info, shape, dtype)
+        arrays = generate_inputs(info, shape, dtype)
+        params = generate_params(info, shape, arrays)
+        return Result.new(info.func_name, shape, dtype, nil, nil, nil, nil, params) if params.is_a?(String)
+
+        call = -> { NDArray::Ops.send(info.func_name, *arrays, **delegator_params(params)) }
+        handle = OpInfo.lookup_handle(NDArray::Ops, info.func_name)
+        keys = params.keys.map(&:to_s)
+        vals = params.map {|k, v| k == :dtype ? DType.name(v) : v }
+        raw_call = -> { LibMXNet.imperative_invoke(handle, arrays, keys, vals, nil) }
+
+        @warmup.times { wait(call.()) }
+        forward = measure { wait(call.()) }
+        dispatch = measure_async(&call)
+        raw_dispatch = measure_async(&raw_call)
+        backward = @backward ? measure_backward(arrays, call) : nil
+        Result.new(info.func_name, shape, dtype, forward, dispatch, raw_dispatch, backward, nil)
+      rescue MXNet::Error, ArgumentError, TypeError, NotImplementedError => error
+        NDArray.waitall rescue nil
+        Result.new(info.func_name, shape, dtype, nil, nil, nil, nil, "#{error.class}: #{error.message}")
+      end
+
+      def nd_arg?(arg)
+        arg.type_info.start_with?('NDArray')
+      end
+
+      def generate_inputs(info, shape, dtype)
+        generator = @inputs[info.func_name]
+        return generator.(shape, dtype) if generator
+        info.args.select {|arg| nd_arg?(arg) }.flat_map do |arg|
+          count = arg.type_info.end_with?('[]') ? 2 : 1
+          Array.new(count) { random_array(shape, dtype) }
+        end
+      end
+
+      def random_array(shape, dtype)
+        # Positive values, so that log, sqrt and the like are defined.
+        NDArray::Random.uniform(0.1, 1.0, shape: shape, ctx: @ctx).as_type(dtype)
+      end
+
+      # Returns the parameters of the operator with their real names, or
+      # the reason of skipping it.
+      def generate_params(info, shape, arrays)
+        user_params = @params.fetch(info.func_name, {})
+        params = {}
+        num_nd_args = info.args.count {|arg| nd_arg?(arg) }
+        info.args.each do |arg|
+          next if nd_arg?(arg) || user_params.key?(arg.name)
+          if arg.name == info.key_var_num_args
+            params[arg.name] = arrays.length
+          elsif arg.name == :shape && num_nd_args == 0
+            params[arg.name] = shape
+          elsif arg.type_info.include?('required')
+            value = default_value(arg.type_info)
+            return "skipped: no default for the required parameter #{arg.name} (#{arg.type_info})" if value.nil?
+            params[arg.name] = value
+          end
+        end
+        params.merge(user_params)
+      end
+
+      def default_value(type_info)
+        case type_info
+        when /\A\{\s*'([^']*)'/
+          $1
+        when /\A(?:float|double|real_t)/
+          1.0
+        when /\A(?:int|long|index_t)/
+          1
+        when /\Aboolean/
+          false
+        end
+      end
+
+      # The delegators rename the parameters that cannot be Ruby keywords.
+      def delegator_params(params)
+        params.map {|k, v|
+          name = k.to_s
+          [(name == 'begin' || name == 'end' || name =~ /\A[A-Z]/) ? :"_#{name}" : k, v]
+        }.to_h
+      end
+
+      def measure_backward(arrays, call)
+        arrays.each(&:attach_grad)
+        heads = to_list(Autograd.record { call.() })
+        run = -> {
+          Autograd.backward(heads, retain_graph: true)
+          arrays.each {|a| a.grad.wait_to_read }
+        }
+        @warmup.times(&run)
+        measure(&run)
+      rescue MXNet::Error
+        NDArray.waitall rescue nil
+        nil
+      end
+
+      def measure
+        t0 = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+        @runs.times { yield }
+        (Process.clock_gettime(Process::CLOCK_MONOTONIC) - t0) / @runs
+      end
+
+      def measure_async(&block)
+        NDArray.waitall
+        t = measure(&block)
+        NDArray.waitall
+        t
+      end
+
+      def wait(outputs)
+        to_list(outputs).each(&:wait_to_read)
+      end
+
+      # NDArray is Enumerable, so Kernel#Array cannot be used.
+      def to_list(outputs)
+        outputs.is_a?(Array) ? outputs : [outputs]
+      end
+
+      def format_us(value)
+        value ? format('%.1f', value) : '-'
+      end
+    end
+  end
+end
@@ -0,0 +1,36 @@
+module MXNet
+  # CachedOp runs a symbol on NDArrays imperatively, like an operator.
+  #
+  # The graph of the symbol is planned once, and reused by the following
+  # calls, so a call of the whole graph costs one dispatch instead of one
+  # for each operator.  Within `Autograd.record`, the call is recorded as
+  # a single node, and its backward runs the gradient graph cached as
+  # well.
+  #
+  #     data = MXNet::Symbol.var(:data)
+  #     net = MXNet::Symbol.FullyConnected(data: data, num_hidden: 10, name: :fc)
+  #     op = MXNet::CachedOp.new(net, static_alloc: true)
+  #     net.list_inputs  # => [:data, :fc_weight, :fc_bias]
+  #     out = op.(x, weight, bias)
+  #
+  class CachedOp
+    # NATIVE: initialize(sym, flags={})
+    #
+    # @param sym [Symbol]  The graph to run.
+    # @param flags [Hash{Symbol => Object}]  The flags of the cached op,
+    #   such as `static_alloc: true` and `static_shape: true`, which let
+    #   libmxnet allocate the memory of the graph only once while the
+    #   shapes of the inputs are unchanged.
+
+    # Run the graph.
+    #
+    # @param args [Array<NDArray>]  The inputs in the order of
+    #   `Symbol#list_inputs` of the symbol.
+    # @param out [NDArray, Array<NDArray>]  The arrays to store the outputs.
+    # @return [NDArray, Array<NDArray>]  The output, or the outputs if the
+    #   symbol has multiple outputs.
+    def call(*args, out: nil)
+      _invoke(args, out)
+    end
+  end
+end
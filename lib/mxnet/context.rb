@@ -1,8 +1,8 @@
 module MXNet
   class Context
-    DEVICE_TYPE_NAME_FROM_ID = { 1 => :cpu, 2 => :gpu, 3 => :cpu_pinned }.freeze
+    DEVICE_TYPE_NAME_FROM_ID = { 1 => :cpu, 2 => :gpu, 3 => :cpu_pinned, 5 => :cpu_shared }.freeze
 
-    DEVICE_TYPE_ID_FROM_NAME = { cpu: 1, gpu: 2, cpu_pinned: 3 }.freeze
+    DEVICE_TYPE_ID_FROM_NAME = { cpu: 1, gpu: 2, cpu_pinned: 3, cpu_shared: 5 }.freeze
 
     def self.device_type_id_from_name(device_name)
       device_name = device_name.to_sym if device_name.kind_of? String
@@ -25,6 +25,7 @@ module MXNet
           "for MXNet::Context, String, Symbol, or Integer"
       end
       @device_id = device_id
+      freeze
     end
 
     attr_reader :device_type_id
@@ -50,23 +51,40 @@ module MXNet
       "#{device_type}(#{device_id})"
     end
 
+    # The key of the stack of the contexts entered by `Context.with`
+    # in the fiber-local storage.
+    STACK_KEY = :__mxnet_context_stack__
+
+    # Returns the current default context.
+    #
+    # The context given to the innermost `Context.with` in the current
+    # fiber is returned, or `cpu(0)` outside of `Context.with`.
     def self.default
-      @default ||= Context.new(:cpu, 0)
+      stack = Thread.current[STACK_KEY]
+      (stack && stack.last) || @default
     end
 
     class << self
       alias current default
     end
 
+    # Make `ctx` the default context while the given block runs.
+    #
+    # The default context is fiber-local, so it does not affect the other
+    # threads and fibers.  `Context.with` can be nested.
     def self.with(ctx)
       return unless block_given?
+      stack = (Thread.current[STACK_KEY] ||= [])
+      stack.push(ctx)
       begin
-        old_context, @default = @default, ctx
         yield
       ensure
-        @default = @old_context
+        stack.pop
       end
     end
+
+    # Contexts are immutable, so the default can be read from any Ractor.
+    @default = Context.new(:cpu, 0)
   end
 
   def self.cpu(device_id=0)
@@ -77,6 +95,11 @@ module MXNet
     Context.new(:gpu, device_id)
   end
 
+  # Returns the context of the CPU memory shared between processes.
+  def self.cpu_shared(device_id=0)
+    Context.new(:cpu_shared, device_id)
+  end
+
   def self.current_context
     Context.default
   end
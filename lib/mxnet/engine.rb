@@ -0,0 +1,84 @@
+module MXNet
+  # The execution engine of libmxnet.
+  #
+  # == Fork
+  #
+  # The threads of the engine do not survive `fork`.  libmxnet (1.3 or
+  # later) stops its engine before `fork`, and starts it again in both
+  # the parent and the child.  Stopping the engine waits for the pending
+  # computations, which can need the GVL for the custom operators, so
+  # `Process.fork` is hooked to wait for them first by `NDArray.waitall`,
+  # which releases the GVL.  In the child, the dispatcher of the callbacks
+  # from libmxnet to Ruby is reset and restarted.
+  #
+  # The arrays created before `fork`, such as the parameters loaded in the
+  # master process of a preforking server, stay shared copy-on-write with
+  # the children as long as they are not written.
+  #
+  #     model = load_model
+  #     MXNet::Engine.at_fork(:child) { reopen_logs }
+  #     4.times { fork { serve(model) } }
+  #
+  # The hooks are installed by `Process._fork`, which is available since
+  # Ruby 3.1.  With older Ruby, call `Engine.prepare_fork` before `fork`,
+  # and `Engine.after_fork_child` in the child.
+  module Engine
+    FORK_EVENTS = [:prepare, :parent, :child].freeze
+
+    @fork_hooks = FORK_EVENTS.map {|event| [event, []] }.to_h
+
+    # Register a block called around `fork`.
+    #
+    # The blocks for `:prepare` are called in the reverse order of the
+    # registrations, and the others in the order of the registrations,
+    # like `pthread_atfork`.
+    #
+    # @param event [:prepare, :parent, :child]  When the block is called.
+    #   `:prepare` is before `fork`, and `:parent` and `:child` are after
+    #   `fork` in the parent and the child.
+    # @return [Proc] The block.
+    def self.at_fork(event, &block)
+      unless FORK_EVENTS.include?(event)
+        raise ArgumentError, "event must be one of #{FORK_EVENTS.inspect}, but got #{event.inspect}"
+      end
+      raise ArgumentError, "no block given" unless block
+      @fork_hooks[event] << block
+      block
+    end
+
+    # Quiesce the engine before `fork`.
+    def self.prepare_fork
+      @fork_hooks[:prepare].reverse_each(&:call)
+      NDArray.waitall
+    end
+
+    # Called in the parent after `fork`.
+    def self.after_fork_parent
+      @fork_hooks[:parent].each(&:call)
+    end
+
+    # Reset the states shared with the threads of libmxnet in the child
+    # after `fork`.
+    def self.after_fork_child
+      _after_fork_child
+      @fork_hooks[:child].each(&:call)
+    end
+
+    # NATIVE: self._after_fork_child
+
+    module ForkHooks # :nodoc:
+      def _fork
+        Engine.prepare_fork
+        pid = super
+        if pid == 0
+          Engine.after_fork_child
+        else
+          Engine.after_fork_parent
+        end
+        pid
+      end
+    end
+
+    Process.singleton_class.prepend(ForkHooks) if Process.respond_to?(:_fork)
+  end
+end
@@ -19,6 +19,52 @@ module MXNet
       @group2ctx = group2ctx.dup
     end
 
-    attr_reader :outputs
+    attr_reader :outputs, :symbol, :arg_arrays, :grad_arrays, :aux_arrays
+
+    # NATIVE: debug_str
+
+    # Returns the memory used by the executor, parsed from `debug_str`.
+    #
+    # @return [MemoryReport]
+    def memory_report
+      MemoryReport.new(self)
+    end
+
+    # The names of the arguments, in the order of `arg_arrays`.
+    def arg_names
+      @symbol.list_arguments
+    end
+
+    # The names of the auxiliary states, in the order of `aux_arrays`.
+    def aux_names
+      @symbol.list_auxiliary_states
+    end
+
+    # Install a callback called with the name and a copy of the output of
+    # each operator while running the forward and the backward.
+    #
+    #     maxima = []
+    #     exe.set_monitor_callback do |name, array|
+    #       maxima << [name, array.abs.max]
+    #     end
+    #
+    # The callback is called from libmxnet in the middle of the execution,
+    # so it should only enqueue operations on the array, and not wait for
+    # their results.  The errors raised in the callback are printed to
+    # `$stderr`.  Use `monitor_enabled=` to skip the callback without
+    # removing it.
+    #
+    # @param callback [#call, nil]  The callback, or the block.
+    # @param monitor_all [true, false]  Whether to call the callback with
+    #   the inputs of the operators too.
+    # @return [nil]
+    def set_monitor_callback(callback=nil, monitor_all: false, &block)
+      callback ||= block
+      raise ArgumentError, "no callback given" unless callback
+      _set_monitor_callback(callback, monitor_all)
+    end
+
+    # NATIVE: monitor_enabled?
+    # NATIVE: monitor_enabled=(enabled)
   end
 end
@@ -0,0 +1,193 @@
+module MXNet
+  class Executor
+    # The memory used by an executor, from `Executor#debug_str` and the
+    # shapes of its arrays.
+    #
+    #     report = exe.memory_report
+    #     report.allocated_bytes  # the memory plan of libmxnet
+    #     report.output_bytes     # the outputs of all the operators
+    #     report.shared_bytes     # saved by sharing and in-place reuse, at least
+    #     puts report
+    #
+    # libmxnet plans the memory of the outputs of the operators, so that an
+    # output reuses the storage of another one that is no longer needed,
+    # or is written in place of an input.  The plan reports only its total,
+    # `allocated_bytes`, rounded down to MB, so the saving is measured
+    # against `output_bytes`, the sum of the outputs of the operators
+    # allocated separately, as its lower bound.  It is unknown for the
+    # outputs smaller than 1 MB.  The operators whose outputs are larger
+    # than the others are the first candidates to shrink.
+    #
+    # The arguments, the gradients and the auxiliary states are the arrays
+    # given to `Symbol#bind`, which are not in the plan.
+    class MemoryReport
+      # An operator in the graph.
+      #
+      # `inputs` are the names of the input nodes with the indices of their
+      # outputs, e.g. `"fc1(0)"`.  `output_bytes` is nil if the shapes of
+      # its outputs are unknown.
+      Node = Struct.new(:op, :name, :inputs, :attrs, :output_bytes)
+
+      DTYPE_SIZES = {
+        float32: 4, float64: 8, float16: 2, uint8: 1, int32: 4, int8: 1, int64: 8
+      }.freeze
+
+      # Parses the string printed by `MXExecutorPrint`.
+      #
+      # @param debug_str [String]
+      # @return [Array(Array<Node>, Integer, Integer)]  The operators, the
+      #   bytes allocated by the plan rounded down to its unit, and the
+      #   bytes of the unit.  The bytes are nil if they are not printed.
+      def self.parse(debug_str)
+        nodes = []
+        allocated_bytes = nil
+        unit_bytes = nil
+        section = nil
+        debug_str.each_line do |line|
+          line = line.chomp
+          case line
+          when /\AOp:(.+?), Name=(.*)\z/
+            nodes << Node.new($1, $2, [], {}, nil)
+            section = nil
+          when /\AVariable:/, /\A-+\z/, /\ASymbol Outputs:/
+            section = nil
+          when /\A(Inputs|Attrs):\z/
+            section = $1 if nodes.last
+          when /\ATotal (\d+) ([KMG]?B) allocated/
+            unit_bytes = { 'B' => 1, 'KB' => 1 << 10, 'MB' => 1 << 20, 'GB' => 1 << 30 }[$2]
+            allocated_bytes = Integer($1) * unit_bytes
+          when /\A\s+arg\[\d+\]=(\S+)/
+            nodes.last.inputs << $1 if section == 'Inputs'
+          when /\A\s+([^=\s]+)=(.*)\z/
+            nodes.last.attrs[$1] = $2 if section == 'Attrs'
+          end
+        end
+        [nodes, allocated_bytes, unit_bytes]
+      end
+
+      # @param exe [Executor]
+      def initialize(exe)
+        @debug_str = exe.debug_str
+        @nodes, @allocated_bytes, @unit_bytes = self.class.parse(@debug_str)
+        @arg_bytes = array_bytes(exe.arg_arrays)
+        @grad_bytes = array_bytes(exe.grad_arrays.compact)
+        @aux_bytes = array_bytes(exe.aux_arrays)
+        assign_output_bytes(exe)
+      end
+
+      # The operators in the topological order.
+      attr_reader :nodes
+
+      # The bytes allocated for the outputs of the operators by the memory
+      # plan of libmxnet, or nil if unknown.  It is rounded down to MB.
+      attr_reader :allocated_bytes
+
+      # The range of the bytes allocated by the memory plan, from
+      # `allocated_bytes` up to the unit printed by libmxnet (1 MB), or nil
+      # if unknown.
+      def allocated_range
+        @allocated_bytes && (@allocated_bytes...(@allocated_bytes + @unit_bytes))
+      end
+
+      # The bytes of the arguments, the gradients and the auxiliary states.
+      attr_reader :arg_bytes, :grad_bytes, :aux_bytes
+
+      # The string printed by libmxnet.
+      attr_reader :debug_str
+
+      # The bytes of the outputs of all the operators, when each of them is
+      # allocated separately.
+      def output_bytes
+        @nodes.sum {|node| node.output_bytes || 0 }
+      end
+
+      # The bytes saved by the memory plan at least, against the upper
+      # bound of `allocated_range`, or nil if unknown or if `output_bytes`
+      # is below the resolution of the plan.
+      def shared_bytes
+        return nil unless @allocated_bytes && output_bytes >= @unit_bytes
+        [output_bytes - allocated_range.end, 0].max
+      end
+
+      # The ratio of `shared_bytes` to `output_bytes`, or nil if unknown.
+      def reuse_ratio
+        shared = shared_bytes
+        shared && shared.fdiv(output_bytes)
+      end
+
+      # The total bytes of the executor, with `allocated_bytes` rounded down.
+      def total_bytes
+        (@allocated_bytes || output_bytes) + @arg_bytes + @grad_bytes + @aux_bytes
+      end
+
+      def to_h
+        {
+          allocated_bytes: @allocated_bytes,
+          allocated_range: allocated_range,
+          output_bytes: output_bytes,
+          shared_bytes: shared_bytes,
+          reuse_ratio: reuse_ratio,
+          arg_bytes: @arg_bytes,
+          grad_bytes: @grad_bytes,
+          aux_bytes: @aux_bytes,
+          total_bytes: total_bytes,
+          nodes: @nodes.map(&:to_h)
+        }
+      end
+
+      # The summary and the operators sorted by the bytes of their outputs.
+      #
+      # The allocated bytes are printed as the range of the rounded value,
+      # and the shared bytes and the reuse ratio as their lower bounds,
+      # e.g. `allocated: 3.00-4.00 MB, outputs: 5.50 MB, shared: >= 1.50 MB (>= 27.3%)`.
+      def to_s
+        lines = []
+        range = allocated_range
+        allocated = range ? format('%.2f-%.2f MB', range.begin.fdiv(1 << 20), range.end.fdiv(1 << 20)) : '-'
+        lines << format('allocated: %s, outputs: %s, shared: %s (%s)',
+                        allocated, mb(output_bytes),
+                        shared_bytes ? ">= #{mb(shared_bytes)}" : '-',
+                        reuse_ratio ? format('>= %.1f%%', reuse_ratio * 100) : '-')
+        lines << format('arguments: %s, gradients: %s, auxiliary states: %s',
+                        mb(@arg_bytes), mb(@grad_bytes), mb(@aux_bytes))
+        @nodes.sort_by {|node| -(node.output_bytes || 0) }.each do |node|
+          lines << format('  %-30s %-20s %s', node.name, node.op, mb(node.output_bytes))
+        end
+        lines.join("\n") + "\n"
+      end
+
+      private
+
+      def array_bytes(arrays)
+        arrays.sum {|array| array.size * DTYPE_SIZES.fetch(array.dtype, 4) }
+      end
+
+      # The internal outputs are named after their nodes, such as
+      # `fc1_output` and `bn_mean`.
+      def assign_output_bytes(exe)
+        internals = exe.symbol.get_internals
+        arg_shapes = exe.arg_names.zip(exe.arg_arrays.map(&:shape)).to_h
+        arg_types = exe.arg_names.zip(exe.arg_arrays.map(&:dtype)).to_h
+        _, out_shapes, _ = internals.infer_shape_partial(**arg_shapes)
+        _, out_types, _ = internals.infer_type(**arg_types)
+        return unless out_shapes
+
+        by_name = @nodes.map {|node| [node.name, node] }.to_h
+        variables = (exe.arg_names + exe.aux_names).map(&:to_s)
+        internals.list_outputs.each_with_index do |output, i|
+          output = output.to_s
+          next if variables.include?(output)
+          node = by_name[output.sub(/_[^_]*\z/, '')]
+          shape = out_shapes[i]
+          next unless node && shape && !shape.include?(0)
+          dtype = out_types ? out_types[i] : :float32
+          node.output_bytes = (node.output_bytes || 0) + shape.inject(1, :*) * DTYPE_SIZES.fetch(dtype, 4)
+        end
+      end
+
+      def mb(bytes)
+        bytes ? format('%.2f MB', bytes.fdiv(1 << 20)) : '-'
+      end
+    end
+  end
+end
@@ -0,0 +1,112 @@
+require 'io/wait'
+require 'thread'
+
+module MXNet
+  # Future is the result of an asynchronous computation of libmxnet.
+  #
+  # The completion is notified through a pipe, so waiting for a future
+  # goes through `IO#wait_readable`.  When a `Fiber.scheduler` is set,
+  # the waiting fiber yields to the other fibers until the computation
+  # finishes, instead of blocking the thread.
+  #
+  #     future = ndarray.to_narray_async
+  #     # ... do other things ...
+  #     nary = future.value
+  #
+  class Future
+    # Create a future that is completed when `io` becomes readable.
+    #
+    # The value of the future is computed by the given block after the
+    # completion.
+    #
+    # @param io [IO]  The reading end of the pipe for the notification.
+    #   It is closed by the future.
+    def initialize(io, &block)
+      @io = io
+      @block = block
+      @mutex = Mutex.new
+      @completed = false
+      @resolved = false
+      @value = nil
+      @error = nil
+    end
+
+    # Returns true if the computation has finished.
+    def ready?
+      @mutex.synchronize do
+        return true if @completed
+        return false unless @io.wait_readable(0)
+        complete
+        true
+      end
+    end
+
+    # Wait for the computation to finish.
+    #
+    # @param timeout [Numeric, nil]  The maximum seconds to wait.
+    # @return [Future, nil] self, or nil on the timeout.
+    def wait(timeout=nil)
+      @mutex.synchronize do
+        return self if @completed
+        return nil unless @io.wait_readable(timeout)
+        complete
+      end
+      self
+    end
+
+    # Wait for the computation to finish, and returns its value.
+    #
+    # The error raised by computing the value is raised again.
+    def value
+      wait
+      @mutex.synchronize do
+        unless @resolved
+          begin
+            @value = @block ? @block.call : nil
+          rescue Exception => error
+            @error = error
+          end
+          @resolved = true
+        end
+      end
+      raise @error if @error
+      @value
+    end
+
+    # Returns a new future that is completed with this future, and whose
+    # value is computed from the value of this future by the given block.
+    def then
+      parent = self
+      Future.new(CompletionWaiter.new(self)) do
+        yield parent.value
+      end
+    end
+
+    private
+
+    def complete
+      @io.read_nonblock(1, exception: false)
+      @io.close
+      @completed = true
+    end
+
+    # An IO-like object that waits for another future.
+    class CompletionWaiter # :nodoc:
+      def initialize(future)
+        @future = future
+      end
+
+      def wait_readable(timeout=nil)
+        @future.wait(timeout) && self
+      end
+
+      def read_nonblock(*)
+        nil
+      end
+
+      def close
+      end
+    end
+    private_constant :CompletionWaiter
+  end
+end
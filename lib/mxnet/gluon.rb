@@ -6,3 +6,4 @@ module MXNet
 end
 
 require 'mxnet/gluon/data'
+require 'mxnet/gluon/utils'
@@ -6,4 +6,6 @@ module MXNet
 end
 
 require_relative 'data/dataset'
+require_relative 'data/sampler'
+require_relative 'data/dataloader'
 require_relative 'data/vision/mnist'
@@ -0,0 +1,287 @@
+require 'mxnet/gluon/data'
+require 'mxnet/gluon/data/sampler'
+
+module MXNet::Gluon::Data
+  # Loads the mini-batches from a dataset.
+  #
+  #     loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 32,
+  #                                                 shuffle: true, num_workers: 4)
+  #     loader.each do |data, label|
+  #       # ...
+  #     end
+  #
+  # == Worker processes
+  #
+  # With `num_workers` greater than 0, the batches are loaded by forked
+  # worker processes, so that the decoding and the augmentation written
+  # in Ruby run in parallel regardless of the GVL.  A worker writes each
+  # batch into NDArrays on `cpu_shared`, and sends only their shared
+  # memory handles and shapes to the main process through a pipe.  The
+  # main process wraps the shared memory by `NDArray.from_shared_mem`
+  # without copying the data.
+  #
+  # The workers are forked at the start of each iteration, after waiting
+  # for all the pending computations of libmxnet by `NDArray.waitall`, and
+  # exit at its end.  Each worker seeds the random number generators of
+  # libmxnet and Ruby by `MXNet::Random.seed_worker`, so the random
+  # augmentations are reproducible with `seed:`.
+  class DataLoader
+    include Enumerable
+
+    # @param dataset [Dataset]  The source dataset.
+    # @param batch_size [Integer]  The size of the mini-batches.
+    # @param shuffle [true, false]  Whether to shuffle the samples.
+    # @param sampler [Sampler]  The sampler of the indices of the samples.
+    #   Cannot be given with `shuffle`.
+    # @param last_batch [:keep, :discard, :rollover]  How to handle the
+    #   last batch.  See `BatchSampler`.
+    # @param batch_sampler [Sampler]  The sampler of the mini-batches of the
+    #   indices.  Cannot be given with `batch_size`, `shuffle`, `sampler`
+    #   and `last_batch`.
+    # @param batchify_fn [#call]  Merges the samples into a batch.  The
+    #   batch made in the workers must consist of NDArrays on `cpu_shared`.
+    # @param num_workers [Integer]  The number of the worker processes.
+    #   The batches are loaded in the current process with 0.
+    # @param prefetch [Integer]  The number of the batches requested to
+    #   the workers in advance.  `2 * num_workers` by default.
+    # @param seed [Integer]  The base seed of the workers.
+    def initialize(dataset, batch_size: nil, shuffle: false, sampler: nil,
+                   last_batch: nil, batch_sampler: nil, batchify_fn: nil,
+                   num_workers: 0, prefetch: nil, seed: nil)
+      @dataset = dataset
+
+      if batch_sampler.nil?
+        raise ArgumentError, "batch_size must be specified unless batch_sampler is specified" if batch_size.nil?
+        if sampler.nil?
+          sampler = shuffle ? RandomSampler.new(dataset.length) : SequentialSampler.new(dataset.length)
+        elsif shuffle
+          raise ArgumentError, "shuffle must not be specified if sampler is specified"
+        end
+        batch_sampler = BatchSampler.new(sampler, batch_size, last_batch || :keep)
+      elsif batch_size || shuffle || sampler || last_batch
+        raise ArgumentError, "batch_size, shuffle, sampler and last_batch must " +
+          "not be specified if batch_sampler is specified."
+      end
+      @batch_sampler = batch_sampler
+
+      if num_workers > 0 && !Process.respond_to?(:fork)
+        warn "DataLoader: fork is not available, so the batches are loaded without workers"
+        num_workers = 0
+      end
+      @num_workers = num_workers
+      @prefetch = [prefetch || 2 * num_workers, num_workers].max
+      @seed = seed
+      @epoch = 0
+
+      @batchify_fn = batchify_fn ||
+        (num_workers > 0 ? self.class.method(:default_mp_batchify_fn) : self.class.method(:default_batchify_fn))
+    end
+
+    attr_reader :dataset, :batch_sampler, :num_workers
+
+    def length
+      @batch_sampler.length
+    end
+
+    def each
+      return enum_for unless block_given?
+      epoch = @epoch
+      @epoch += 1
+      if @num_workers == 0
+        @batch_sampler.each do |indices|
+          yield @batchify_fn.(indices.map {|i| @dataset[i] })
+        end
+      else
+        seed = @seed ? MXNet::Random.worker_seed(@seed, epoch) : Kernel.rand(2**31)
+        pool = WorkerPool.new(@dataset, @batchify_fn, @num_workers, seed)
+        begin
+          pool.each(@batch_sampler.to_a, @prefetch) {|batch| yield batch }
+        ensure
+          pool.shutdown
+        end
+      end
+      self
+    end
+
+    # Merges the samples into a batch by stacking them.
+    def self.default_batchify_fn(data)
+      case data[0]
+      when MXNet::NDArray
+        MXNet::NDArray.stack(*data, num_args: data.length)
+      when Array
+        data.transpose.map {|field| default_batchify_fn(field) }
+      else
+        MXNet::NDArray.array(data)
+      end
+    end
+
+    # Merges the samples into a batch on `cpu_shared` by stacking them.
+    def self.default_mp_batchify_fn(data)
+      case data[0]
+      when MXNet::NDArray
+        out = MXNet::NDArray.empty([data.length, *data[0].shape], ctx: MXNet.cpu_shared, dtype: data[0].dtype)
+        MXNet::NDArray.stack(*data, num_args: data.length, out: out)
+      when Array
+        data.transpose.map {|field| default_mp_batchify_fn(field) }
+      else
+        MXNet::NDArray.array(data, ctx: MXNet.cpu_shared)
+      end
+    end
+
+    # The handle of an NDArray on `cpu_shared` sent from a worker.
+    SharedArray = Struct.new(:shared_pid, :shared_id, :shape, :dtype) # :nodoc:
+
+    # The forked worker processes.
+    #
+    # The i-th batch is requested to the worker `i % num_workers`, and each
+    # worker returns the results in the order of the requests, so the main
+    # process receives the batches in order without reordering them.  A
+    # worker keeps the arrays of a batch until the main process wraps
+    # them and notifies the release, so that the shared memory is not
+    # freed before that.
+    class WorkerPool
+      Worker = Struct.new(:pid, :task_writer, :result_reader)
+
+      def initialize(dataset, batchify_fn, num_workers, seed)
+        # The engine of libmxnet must be idle while forking.
+        MXNet::NDArray.waitall
+        @workers = []
+        num_workers.times do |worker_id|
+          task_reader, task_writer = IO.pipe
+          result_reader, result_writer = IO.pipe
+          pid = Process.fork do
+            status = 1
+            begin
+              task_writer.close
+              result_reader.close
+              @workers.each do |w|
+                w.task_writer.close
+                w.result_reader.close
+              end
+              MXNet::Random.seed_worker(seed, worker_id)
+              WorkerPool.run_worker(dataset, batchify_fn, task_reader, result_writer)
+              status = 0
+            rescue Exception
+              # The main process notices the exit by the end of the pipe.
+            ensure
+              Process.exit!(status)
+            end
+          end
+          task_reader.close
+          result_writer.close
+          task_writer.sync = true
+          @workers << Worker.new(pid, task_writer, result_reader)
+        end
+      end
+
+      def each(batches, prefetch)
+        num_sent = 0
+        send_task = lambda do
+          worker = @workers[num_sent % @workers.length]
+          Marshal.dump([:batch, num_sent, batches[num_sent]], worker.task_writer)
+          num_sent += 1
+        end
+        send_task.() while num_sent < batches.length && num_sent < prefetch
+
+        batches.length.times do |idx|
+          worker = @workers[idx % @workers.length]
+          batch = receive(worker, idx)
+          send_task.() if num_sent < batches.length
+          yield batch
+        end
+      end
+
+      def shutdown
+        @workers.each do |w|
+          w.task_writer.close unless w.task_writer.closed?
+          w.result_reader.close unless w.result_reader.closed?
+        end
+        @workers.each do |w|
+          Process.wait(w.pid)
+        rescue Errno::ECHILD
+          # already reaped
+        end
+        @workers.clear
+      end
+
+      def self.run_worker(dataset, batchify_fn, task_reader, result_writer)
+        result_writer.sync = true
+        pending = {}
+        loop do
+          begin
+            message = Marshal.load(task_reader)
+          rescue EOFError
+            break
+          end
+          case message[0]
+          when :batch
+            _, idx, indices = message
+            begin
+              batch = batchify_fn.(indices.map {|i| dataset[i] })
+              arrays = []
+              payload = export(batch, arrays)
+              # The main process reads the arrays without the engine of
+              # this process.
+              MXNet::NDArray.waitall
+              pending[idx] = arrays
+              result = [:ok, idx, payload]
+            rescue StandardError => error
+              result = [:error, idx, error.class.name, error.message, error.backtrace]
+            end
+            Marshal.dump(result, result_writer)
+          when :release
+            pending.delete(message[1])
+          end
+        end
+      end
+
+      def self.export(obj, arrays)
+        case obj
+        when MXNet::NDArray
+          obj = obj.as_in_context(MXNet.cpu_shared)
+          arrays << obj
+          SharedArray.new(*obj.to_shared_mem)
+        when Array
+          obj.map {|x| export(x, arrays) }
+        else
+          obj
+        end
+      end
+
+      private
+
+      def receive(worker, idx)
+        begin
+          status, received_idx, *rest = Marshal.load(worker.result_reader)
+        rescue EOFError
+          raise "DataLoader worker (pid=#{worker.pid}) exited unexpectedly"
+        end
+        unless received_idx == idx
+          raise "DataLoader worker (pid=#{worker.pid}) returned the batch #{received_idx} for #{idx}"
+        end
+        if status == :error
+          class_name, message, backtrace = rest
+          error = RuntimeError.new("#{class_name} in DataLoader worker (pid=#{worker.pid}): #{message}")
+          error.set_backtrace(backtrace) if backtrace
+          raise error
+        end
+
+        batch = import(rest[0])
+        Marshal.dump([:release, idx], worker.task_writer)
+        batch
+      end
+
+      def import(obj)
+        case obj
+        when SharedArray
+          MXNet::NDArray.from_shared_mem(obj.shared_pid, obj.shared_id, obj.shape, obj.dtype)
+        when Array
+          obj.map {|x| import(x) }
+        else
+          obj
+        end
+      end
+    end
+    private_constant :WorkerPool
+  end
+end
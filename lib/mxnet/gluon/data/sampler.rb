@@ -0,0 +1,100 @@
+require 'mxnet/gluon/data'
+
+module MXNet::Gluon::Data
+  # The base class of samplers, which yield the indices of the samples
+  # in a dataset.
+  class Sampler
+    include Enumerable
+
+    def length
+      raise NotImplementedError
+    end
+
+    def each
+      raise NotImplementedError
+    end
+  end
+
+  # Samples the elements from [0, length) sequentially.
+  class SequentialSampler < Sampler
+    def initialize(length)
+      @length = length
+    end
+
+    attr_reader :length
+
+    def each
+      return enum_for unless block_given?
+      @length.times {|i| yield i }
+      self
+    end
+  end
+
+  # Samples the elements from [0, length) randomly without replacement.
+  class RandomSampler < Sampler
+    def initialize(length)
+      @length = length
+    end
+
+    attr_reader :length
+
+    def each
+      return enum_for unless block_given?
+      (0...@length).to_a.shuffle.each {|i| yield i }
+      self
+    end
+  end
+
+  # Wraps another sampler to yield the mini-batches of the indices.
+  #
+  # @param sampler [Sampler]  The source sampler.
+  # @param batch_size [Integer]  The size of the mini-batches.
+  # @param last_batch [:keep, :discard, :rollover]  How to handle the last
+  #   batch if `batch_size` does not evenly divide the length of `sampler`.
+  #   `:keep` yields a smaller last batch, `:discard` drops it, and
+  #   `:rollover` prepends its indices to the first batch of the next
+  #   iteration.
+  class BatchSampler < Sampler
+    def initialize(sampler, batch_size, last_batch=:keep)
+      unless [:keep, :discard, :rollover].include?(last_batch)
+        raise ArgumentError, "last_batch must be one of :keep, :discard, or :rollover, but got #{last_batch.inspect}"
+      end
+      @sampler = sampler
+      @batch_size = batch_size
+      @last_batch = last_batch
+      @prev = []
+    end
+
+    def length
+      case @last_batch
+      when :keep
+        (@sampler.length + @batch_size - 1) / @batch_size
+      when :discard
+        @sampler.length / @batch_size
+      when :rollover
+        (@prev.length + @sampler.length) / @batch_size
+      end
+    end
+
+    def each
+      return enum_for unless block_given?
+      batch, @prev = @prev, []
+      @sampler.each do |i|
+        batch << i
+        if batch.length == @batch_size
+          yield batch
+          batch = []
+        end
+      end
+      unless batch.empty?
+        case @last_batch
+        when :keep
+          yield batch
+        when :rollover
+          @prev = batch
+        end
+      end
+      self
+    end
+  end
+end
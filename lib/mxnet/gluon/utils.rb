@@ -0,0 +1,64 @@
+module MXNet
+  module Gluon
+    module Utils
+      # Rescales the arrays so that the 2-norm of their concatenation is
+      # smaller than or equal to `max_norm`.
+      #
+      # The sums of squares of the arrays are computed by one
+      # `multi_sum_sq` operation for each context, and the arrays are
+      # rescaled by the scale computed on the device, so that the host
+      # waits for the computation only once to check the total norm, or
+      # never with `check_isfinite: false`.  With a libmxnet without
+      # `multi_sum_sq`, the sums of squares are computed for each array,
+      # and added by one `add_n` operation.
+      #
+      #     grads = params.map(&:grad)
+      #     MXNet::Gluon::Utils.clip_global_norm(grads, 1.0)
+      #
+      # @param arrays [Array<NDArray>]  The arrays rescaled in place.
+      # @param max_norm [Float]  The maximum 2-norm.
+      # @param check_isfinite [true, false]  Whether to check the total norm
+      #   is finite, and warn if it is not.  It waits for the computation.
+      # @return [Float, NDArray] The total norm, as a Float if
+      #   `check_isfinite` is true, and as an NDArray of shape [1] on the
+      #   context of the first array otherwise.
+      def self.clip_global_norm(arrays, max_norm, check_isfinite: true)
+        raise ArgumentError, "arrays must not be empty" if arrays.empty?
+
+        ctx = arrays[0].context
+        sum_sqs = arrays.group_by(&:context).map do |_, same_ctx_arrays|
+          sum_sq(same_ctx_arrays).as_in_context(ctx)
+        end
+        total_norm = NDArray.sqrt(sum_sqs.length == 1 ? sum_sqs[0] : NDArray::Ops.add_n(*sum_sqs, num_args: sum_sqs.length))
+
+        if check_isfinite
+          total_norm_value = total_norm.as_scalar
+          unless total_norm_value.finite?
+            warn "nan or inf is detected. Clipping results will be undefined."
+          end
+        end
+
+        scale = NDArray.minimum(max_norm / (total_norm + 1e-8), 1.0)
+        scales = {ctx => scale}
+        arrays.each do |array|
+          array_scale = (scales[array.context] ||= scale.as_in_context(array.context))
+          NDArray::Ops.broadcast_mul(array, array_scale, out: array)
+        end
+
+        check_isfinite ? total_norm_value : total_norm
+      end
+
+      # Returns the sum of squares of the arrays on the same context as an
+      # NDArray of shape [1].
+      def self.sum_sq(arrays)
+        if NDArray::Ops.respond_to?(:multi_sum_sq)
+          NDArray.sum(NDArray::Ops.multi_sum_sq(*arrays, num_arrays: arrays.length))
+        else
+          sums = arrays.map {|array| NDArray.sum(NDArray.square(array)) }
+          sums.length == 1 ? sums[0] : NDArray::Ops.add_n(*sums, num_args: sums.length)
+        end
+      end
+      private_class_method :sum_sq
+    end
+  end
+end
@@ -0,0 +1,203 @@
+require 'thread'
+
+module MXNet
+  module Model
+    # The default number of checkpoints that can be in flight in the
+    # background writer before `save_checkpoint` blocks the caller.
+    DEFAULT_MAX_PENDING_CHECKPOINTS = 2
+
+    module_function
+
+    # Checkpoint the model data into file.
+    #
+    # The symbol is saved to `"#{prefix}-symbol.json"` and the parameters
+    # are saved to `"#{prefix}-#{'%04d' % epoch}.params"`.
+    #
+    # When `async` is true, the parameters are snapshotted with
+    # engine-side copies and the serialization, the disk write, and
+    # `fsync` are performed on a background thread.  The arrays in
+    # `arg_params` and `aux_params` can be updated right after this
+    # method returns.  At most `DEFAULT_MAX_PENDING_CHECKPOINTS`
+    # checkpoints are kept in flight; when the limit is reached, this
+    # method blocks until the oldest one is written.
+    #
+    # @param prefix [String]  Prefix of model name.
+    # @param epoch [Integer]  The epoch number of the model.
+    # @param symbol [MXNet::Symbol, nil]  The input symbol.
+    # @param arg_params [Hash{String => MXNet::NDArray}]  Model parameter, hash of name to NDArray of net's weights.
+    # @param aux_params [Hash{String => MXNet::NDArray}]  Model parameter, hash of name to NDArray of net's auxiliary states.
+    # @param async [true, false]  Whether the parameters are written on the background thread.
+    # @return [String]  The file name of the parameters.
+    def save_checkpoint(prefix, epoch, symbol, arg_params, aux_params, async: true)
+      symbol.save("#{prefix}-symbol.json") if symbol
+      save_dict = {}
+      arg_params.each {|k, v| save_dict["arg:#{k}"] = v }
+      aux_params.each {|k, v| save_dict["aux:#{k}"] = v }
+      param_name = '%s-%04d.params' % [prefix, epoch]
+      if async
+        checkpoint_writer.push(param_name, save_dict)
+      else
+        CheckpointWriter.write(param_name, save_dict)
+      end
+      param_name
+    end
+
+    # Load model checkpoint from file.
+    #
+    # Pending asynchronous checkpoints are waited before loading.
+    #
+    # @param prefix [String]  Prefix of model name.
+    # @param epoch [Integer]  Epoch number of model we would like to load.
+    # @return [Array]  A triple of the symbol, `arg_params`, and `aux_params`.
+    def load_checkpoint(prefix, epoch)
+      wait_checkpoints
+      symbol = MXNet::Symbol.load("#{prefix}-symbol.json")
+      save_dict = MXNet::NDArray.load('%s-%04d.params' % [prefix, epoch])
+      arg_params = {}
+      aux_params = {}
+      save_dict.each do |key, value|
+        type, name = key.split(':', 2)
+        case type
+        when 'arg'
+          arg_params[name] = value
+        when 'aux'
+          aux_params[name] = value
+        end
+      end
+      [symbol, arg_params, aux_params]
+    end
+
+    # Block until all the asynchronous checkpoints are written.
+    #
+    # Raises the error occurred in the background writer, if any.
+    def wait_checkpoints
+      @checkpoint_writer.wait if @checkpoint_writer
+      nil
+    end
+
+    def checkpoint_writer
+      @checkpoint_writer ||= CheckpointWriter.new
+    end
+    private_class_method :checkpoint_writer
+
+    # The background writer of `save_checkpoint`.
+    class CheckpointWriter
+      # Write the given parameters to the file.
+      #
+      # The data is first written to a temporary file that is `fsync`ed
+      # and then renamed to `fname`, so a crash never leaves a truncated
+      # checkpoint behind.  Remote URIs like `s3://` are written directly.
+      def self.write(fname, save_dict)
+        if fname =~ %r{\A\w+://}
+          NDArray.save(fname, save_dict)
+          return
+        end
+
+        tmp_fname = "#{fname}.tmp#{Process.pid}"
+        begin
+          NDArray.save(tmp_fname, save_dict)
+          File.open(tmp_fname, 'r+b') {|f| f.fsync }
+          File.rename(tmp_fname, fname)
+        rescue Exception
+          File.unlink(tmp_fname) if File.exist?(tmp_fname)
+          raise
+        end
+        begin
+          File.open(File.dirname(fname)) {|d| d.fsync }
+        rescue SystemCallError
+          # fsync of directories is not supported on this platform
+        end
+      end
+
+      def initialize(max_pending: DEFAULT_MAX_PENDING_CHECKPOINTS)
+        raise ArgumentError, "max_pending must be positive" unless max_pending > 0
+        @max_pending = max_pending
+        @queue = Queue.new
+        @mutex = Mutex.new
+        @cond = ConditionVariable.new
+        @pending = 0
+        @error = nil
+        @thread = nil
+        at_exit { wait }
+      end
+
+      attr_reader :max_pending
+
+      # Snapshot the arrays and enqueue them to the background thread.
+      def push(fname, save_dict)
+        @mutex.synchronize do
+          @cond.wait(@mutex) while @pending >= @max_pending
+          raise_error
+          @pending += 1
+        end
+
+        # The copies are pushed to the engine in the order after all the
+        # pending writes to the source arrays, so the snapshot has the
+        # values at this point even if the sources are updated later.
+        begin
+          snapshot = {}
+          save_dict.each do |key, value|
+            snapshot[key] = value.copy_to(value.context)
+          end
+        rescue Exception
+          @mutex.synchronize do
+            @pending -= 1
+            @cond.broadcast
+          end
+          raise
+        end
+
+        @mutex.synchronize do
+          start_thread
+          @queue.push([fname, snapshot])
+        end
+        self
+      end
+
+      # Block until all the pending checkpoints are written.
+      def wait
+        @mutex.synchronize do
+          @cond.wait(@mutex) while @pending > 0
+          raise_error
+        end
+        self
+      end
+
+      # The number of checkpoints that are not yet written.
+      def pending
+        @mutex.synchronize { @pending }
+      end
+
+      private
+
+      def raise_error
+        if @error
+          error, @error = @error, nil
+          raise error
+        end
+      end
+
+      # Called with @mutex locked.
+      def start_thread
+        return if @thread && @thread.alive?
+        @thread = Thread.new { run }
+      end
+
+      def run
+        while (job = @queue.pop)
+          fname, snapshot = job
+          begin
+            self.class.write(fname, snapshot)
+          rescue Exception => error
+            @mutex.synchronize { @error ||= error }
+          ensure
+            @mutex.synchronize do
+              @pending -= 1
+              @cond.broadcast
+            end
+          end
+        end
+      end
+    end
+  end
+end
@@ -0,0 +1,137 @@
+module MXNet
+  # Monitors the outputs of the operators and the arguments of executors
+  # on every `interval`th batch.
+  #
+  #     mon = MXNet::Monitor.new(100, pattern: /weight|output/)
+  #     mon.install(exe)
+  #     batches.each do |batch|
+  #       mon.tic
+  #       exe.forward(is_train: true)
+  #       exe.backward
+  #       mon.toc_print
+  #     end
+  #
+  # The statistics of an array are computed by operations on its device,
+  # while the executor is running, and are copied to Ruby only by `toc`.
+  # On the other batches, the executors do not call back Ruby at all.
+  #
+  # The default statistics are the L2 norm, the minimum, the maximum and
+  # the number of NaNs of an array.
+  class Monitor
+    # The names of the values computed by `Monitor.default_stat`.
+    DEFAULT_STAT_NAMES = %i[norm min max nan_count].freeze
+
+    # Computes the default statistics of the array on its device.
+    #
+    # @param array [NDArray]
+    # @return [NDArray]  The values of `DEFAULT_STAT_NAMES` in an array of
+    #   shape `[4]`.
+    def self.default_stat(array)
+      x = array.reshape([-1])
+      stats = [
+        NDArray::Ops.norm(x),
+        NDArray::Ops.min(x),
+        NDArray::Ops.max(x),
+        NDArray::Ops.sum(x != x)
+      ]
+      NDArray::Ops.concat(*stats.map {|stat| stat.reshape([1]) }, dim: 0)
+    end
+
+    # @param interval [Integer]  The number of the batches between the
+    #   monitored batches.
+    # @param stat_func [#call, nil]  Computes the statistics of an array,
+    #   returning an NDArray or an Array of NDArrays.
+    #   `Monitor.default_stat` by default.
+    # @param pattern [Regexp, String]  The names of the arrays monitored.
+    # @param sort [true, false]  Whether to sort the statistics by the names.
+    # @param monitor_all [true, false]  Whether to monitor the inputs of the
+    #   operators too.
+    def initialize(interval, stat_func: nil, pattern: /.*/, sort: false, monitor_all: false)
+      raise ArgumentError, "interval must be positive" unless interval > 0
+      @interval = interval
+      @stat_func = stat_func || self.class.method(:default_stat)
+      @stat_names = stat_func ? nil : DEFAULT_STAT_NAMES
+      @pattern = Regexp.new(pattern)
+      @sort = sort
+      @monitor_all = monitor_all
+      @exes = []
+      @queue = []
+      @step = 0
+      @current_step = nil
+      @activated = false
+      @stat_helper = lambda do |name, array|
+        next unless @activated && @pattern.match?(name)
+        @queue << [@current_step, name, @stat_func.(array)]
+      end
+    end
+
+    # The names of the values of the statistics, or nil for a custom
+    # `stat_func`.
+    attr_reader :stat_names
+
+    # The number of the batches started by `tic`.
+    attr_reader :step
+
+    # Install the monitor on the executor.
+    #
+    # @param exe [Executor]
+    def install(exe)
+      exe.set_monitor_callback(@stat_helper, monitor_all: @monitor_all)
+      exe.monitor_enabled = @activated
+      @exes << exe
+      self
+    end
+
+    # Start a batch.  The batch is monitored on every `interval`th call.
+    def tic
+      @current_step = @step
+      if @step % @interval == 0
+        @queue = []
+        @activated = true
+        @exes.each {|exe| exe.monitor_enabled = true }
+      end
+      @step += 1
+      nil
+    end
+
+    # End the batch, and return the statistics if it is monitored.
+    #
+    # The statistics of the arguments of the executors are added to the
+    # ones of the operators.
+    #
+    # @return [Array<Array(Integer, String, Array<Float>)>]  The batch
+    #   number, the name and the values of the statistics.
+    def toc
+      return [] unless @activated
+      @exes.each {|exe| exe.monitor_enabled = false }
+      @activated = false
+
+      @exes.each do |exe|
+        exe.arg_names.zip(exe.arg_arrays) do |name, array|
+          name = name.to_s
+          @queue << [@current_step, name, @stat_func.(array)] if @pattern.match?(name)
+        end
+      end
+
+      queue, @queue = @queue, []
+      queue = queue.sort_by {|_, name, _| name } if @sort
+      queue.map do |step, name, stats|
+        stats = [stats] unless stats.is_a?(Array)
+        [step, name, stats.flat_map {|stat| stat.to_a.flatten }]
+      end
+    end
+
+    # End the batch, and print the statistics if it is monitored.
+    def toc_print
+      toc.each do |step, name, values|
+        values = if @stat_names
+                   @stat_names.zip(values).map {|stat_name, value| "#{stat_name}=#{value}" }
+                 else
+                   values
+                 end
+        puts format('Batch: %7d %-30s %s', step, name, values.join("\t"))
+      end
+      nil
+    end
+  end
+end
@@ -4,15 +4,48 @@ module MXNet
     #
     # Developers can also inherit from this class to change naming behavior.
     class NameManager
+      # The key of the stack of the entered name managers in the
+      # fiber-local storage.
+      STACK_KEY = :__mxnet_name_manager_stack__
+
+      # The key of the default name manager in the Ractor-local storage.
+      DEFAULT_KEY = :__mxnet_default_name_manager__
+
       @current = nil
 
       class << self
-        attr_accessor :current
+        # Returns the name manager entered last in the current fiber,
+        # or the default name manager shared by all the threads.
+        #
+        # Each Ractor other than the main Ractor has its own default
+        # name manager.
+        def current
+          stack = Thread.current[STACK_KEY]
+          return stack.last if stack && !stack.empty?
+          if defined?(::Ractor) && !main_ractor?
+            ::Ractor.current[DEFAULT_KEY] ||= NameManager.new
+          else
+            @current
+          end
+        end
+
+        # Set the default name manager shared by all the threads.
+        def current=(manager)
+          if defined?(::Ractor) && !main_ractor?
+            ::Ractor.current[DEFAULT_KEY] = manager
+          else
+            @current = manager
+          end
+        end
+
+        private def main_ractor?
+          ::Ractor.current == ::Ractor.main
+        end
       end
 
       def initialize
         @counter = {}
-        @old_manager = nil
+        @mutex = Mutex.new
       end
 
       # Get the canonical name for a symbol.
@@ -30,9 +63,11 @@ module MXNet
       # @return [String]  A canonical name for the symbol.
       def get(name, hint)
         return name if name
-        @counter[hint] = 0 unless @counter.include? hint
-        name = "#{hint}#{@counter[hint]}"
-        @counter[hint] += 1
+        @mutex.synchronize do
+          @counter[hint] = 0 unless @counter.include? hint
+          name = "#{hint}#{@counter[hint]}"
+          @counter[hint] += 1
+        end
         return name
       end
 
@@ -47,14 +82,16 @@ module MXNet
       end
 
       private def _enter
-        @old_manager = NameManager.current
-        NameManager.current = self
+        (Thread.current[STACK_KEY] ||= []).push(self)
         self
       end
 
       def exit
-        raise unless @old_manager
-        NameManager.current = @old_manager
+        stack = Thread.current[STACK_KEY]
+        unless stack && stack.last.equal?(self)
+          raise "#{self.class} is not the current name manager"
+        end
+        stack.pop
       end
 
       @current = self.new
@@ -49,6 +49,124 @@ module MXNet
       arr
     end
 
+    # Loads the arrays saved by `save` directly into existing arrays.
+    #
+    # Unlike `load`, this doesn't allocate new arrays.  The data of each
+    # parameter is streamed from the file into the corresponding target
+    # array one by one; for arrays on CPU the data is read directly into
+    # their memory.  This is useful to hot-swap the parameters of a bound
+    # executor, e.g. `NDArray.load_into(fname, executor.arg_dict)`.
+    #
+    # The shapes and dtypes of all the parameters are validated before any
+    # data is copied.
+    #
+    # @param source [String, Pathname, IO]  The file name, an IO, or a String
+    #   holding the content of the file.
+    # @param targets [Hash{String, Symbol => NDArray}, Array<NDArray>]
+    #   The destination arrays.  An Array can be given for a file that
+    #   has no names.
+    # @param allow_missing [true, false]  Whether targets missing from the
+    #   file are allowed.
+    # @param ignore_extra [true, false]  Whether parameters in the file that
+    #   are not in the targets are ignored.
+    # @return [Array<String, Integer>]  The names (or indices) of the loaded parameters.
+    def self.load_into(source, targets, allow_missing: false, ignore_extra: false)
+      ParamsReader.open(source) do |reader|
+        entries = reader.entries.each_with_index.map do |entry, i|
+          [reader.named? ? entry.name : i, entry]
+        end
+
+        case targets
+        when Hash
+          target_map = {}
+          targets.each {|k, v| target_map[k.is_a?(Integer) ? k : k.to_s] = v }
+        when Array
+          target_map = Hash[targets.each_with_index.map {|v, i| [i, v] }]
+        else
+          raise TypeError, "targets must be a Hash or an Array of NDArrays"
+        end
+
+        pairs = []
+        entries.each do |key, entry|
+          target = target_map.delete(key)
+          if target.nil?
+            next if ignore_extra
+            raise ArgumentError, "Parameter #{key} is loaded from the file but not in the targets"
+          end
+          unless target.is_a?(NDArray)
+            raise TypeError, "target #{key} is not an NDArray (#{target.class})"
+          end
+          if entry.shape.nil?
+            raise ArgumentError, "Parameter #{key} is saved without data"
+          end
+          if target.shape != entry.shape
+            raise ArgumentError, "Shape mismatch of parameter #{key}: " +
+              "expected #{target.shape}, but #{entry.shape} in the file"
+          end
+          if target.dtype != entry.dtype
+            raise ArgumentError, "DType mismatch of parameter #{key}: " +
+              "expected #{target.dtype}, but #{entry.dtype} in the file"
+          end
+          pairs << [key, entry, target]
+        end
+        unless allow_missing || target_map.empty?
+          raise ArgumentError, "Parameters #{target_map.keys} are missing in the file"
+        end
+
+        pairs.map do |key, entry, target|
+          reader.copy_to(entry, target)
+          key
+        end
+      end
+    end
+
+    # Load the arrays in a file by mapping it into memory.
+    # This is the implementation of `NDArray.load(fname, mmap: true)`.
+    #
+    # The arrays whose data is not aligned to their element size in the
+    # file cannot refer to the mapped pages, so they are copied into newly
+    # allocated arrays instead.  All the arrays are copied with the versions
+    # of libmxnet without `MXNDArrayFromDLPackEx`, which cannot release the
+    # mapping.
+    def self._load_mapped(fname)
+      fname = fname.to_path if fname.respond_to?(:to_path)
+      if fname =~ %r{\A\w+://}
+        raise ArgumentError, "unable to map a remote file: #{fname}"
+      end
+      ParamsReader.open(fname) do |reader|
+        entries = reader.entries
+        specs = entries.map do |entry|
+          if entry.shape.nil?
+            raise NotImplementedError, "unable to map an NDArray saved without data"
+          end
+          [entry.offset, entry.shape, MXNet::DType.name2id(entry.dtype)]
+        end
+        arrays = _mmap_arrays(fname, specs).each_with_index.map do |array, i|
+          next array if array
+          entry = entries[i]
+          reader.copy_to(entry, NDArray.empty(entry.shape, ctx: MXNet.cpu, dtype: entry.dtype))
+        end
+        if reader.named?
+          Hash[entries.map(&:name).zip(arrays)]
+        else
+          arrays
+        end
+      end
+    end
+    private_class_method :_load_mapped
+
+    # Create an array referring to the shared memory of an array on
+    # `cpu_shared` in another process, without copying the data.
+    #
+    # The arguments are the values returned by `NDArray#to_shared_mem` in
+    # the other process.  The other process must keep its array alive
+    # until this method returns.
+    #
+    # @return [NDArray] The array on `cpu_shared`.
+    def self.from_shared_mem(shared_pid, shared_id, shape, dtype)
+      _from_shared_mem(shared_pid, shared_id, shape, dtype)
+    end
+
     def inspect
       shape_info = shape.join('x')
       ary = to_narray.inspect.lines[1..-1].join
@@ -72,6 +190,18 @@ module MXNet
       copy_to(context)
     end
 
+    # Returns the handle of the shared memory of this array, by which
+    # another process creates an array sharing the data by
+    # `NDArray.from_shared_mem`.
+    #
+    # @return [Array] `[shared_pid, shared_id, shape, dtype]`
+    def to_shared_mem
+      unless context.device_type == :cpu_shared
+        raise ArgumentError, "the array must be on cpu_shared, but on #{context}"
+      end
+      [*_shared_mem_handle, shape, dtype]
+    end
+
     def copy_to(other)
       case other
       when NDArray
@@ -460,6 +590,26 @@ module MXNet
       Ops.square(self, *args, **kwargs)
     end
 
+    def exp(*args, **kwargs)
+      Ops.exp(self, *args, **kwargs)
+    end
+
+    def log(*args, **kwargs)
+      Ops.log(self, *args, **kwargs)
+    end
+
+    def relu(*args, **kwargs)
+      Ops.relu(self, *args, **kwargs)
+    end
+
+    def sigmoid(*args, **kwargs)
+      Ops.sigmoid(self, *args, **kwargs)
+    end
+
+    def tanh(*args, **kwargs)
+      Ops.tanh(self, *args, **kwargs)
+    end
+
     def +(other)
       self.class.add(self, other)
     end
@@ -792,6 +942,46 @@ module MXNet
       raise NotImplementedError
     end
 
+    # Returns a future that is completed when all the pending writes to
+    # this array are finished.
+    #
+    # The completion is notified from an engine callback through a pipe,
+    # so `Future#wait` lets the other fibers run under a `Fiber.scheduler`.
+    # When libmxnet does not provide `MXEnginePushSyncND`, a background
+    # thread waits for the array instead.
+    #
+    # @yield  Computes the value of the future after the completion.
+    # @return [Future]  The future whose value is the value of the block,
+    #   or this array when no block is given.
+    def wait_async(&block)
+      reader, writer = IO.pipe
+      begin
+        unless _notify_when_ready(writer.fileno)
+          notifier = writer
+          writer = nil
+          Thread.new do
+            Thread.current.report_on_exception = false
+            begin
+              wait_to_read
+            ensure
+              notifier.write("\x01")
+              notifier.close
+            end
+          end
+        end
+      ensure
+        writer.close if writer
+      end
+      Future.new(reader, &(block || -> { self }))
+    end
+
+    # Returns a future of `to_narray`.
+    #
+    # @return [Future]  The future whose value is a `Numo::NArray`.
+    def to_narray_async
+      wait_async { to_narray }
+    end
+
     # Returns a Numo::NArray object with value copied from this array.
     def to_narray
       require 'mxnet/narray_helper'
@@ -0,0 +1,300 @@
+module MXNet
+  class NDArray
+    # Evaluate the elementwise operations in the block lazily.
+    #
+    # The elementwise operations called in the block, such as the
+    # arithmetic operators, `relu` and `clip`, return `LazyArray`s which
+    # only hold the expressions.  An expression is evaluated when its
+    # values, shape or handle are needed in the block, such as by `to_a`,
+    # `wait_to_read` and the operations that are not deferred.  When the
+    # block returns, the lazy arrays in its value, including the ones in
+    # `Array`s and `Hash`es, and the lazy arrays not used by the other
+    # ones are evaluated.  The deferred operations are run by a `CachedOp`
+    # of the symbol composed from them at once, instead of one operation
+    # at a time with an intermediate array for each.  The cached ops are
+    # reused for the expressions with the same operations and the same
+    # shapes of the inputs.
+    #
+    #     y = MXNet::NDArray.lazy do
+    #       (x * a + b).relu.clip(0, 6)
+    #     end
+    #     # y is computed by a cached op of 4 operations
+    #
+    # The inputs of the expressions are read when they are evaluated, so
+    # the operations writing into an array by `out:`, including `[]=` and
+    # the optimizers, evaluate the pending expressions reading the array
+    # first in the block.  The other writes, such as the ones into the
+    # views of the array or from the other threads, must not be made to
+    # the inputs in the block.  The intermediate arrays, such as `x * a`
+    # above, are not kept and evaluated again when they are read, so their
+    # inputs must not be written until then.
+    #
+    # The operations are not deferred while `Autograd.record` is recording.
+    #
+    # @return The value of the block.
+    def self.lazy(&block)
+      Lazy.enable(&block)
+    end
+
+    # An array of a deferred expression.  It has no handle of libmxnet until
+    # the expression is evaluated.
+    class LazyArray < NDArray
+      def initialize(op_handle, inputs, keys, vals)
+        @expression = [op_handle, inputs, keys, vals].freeze
+      end
+
+      # The operation and the arguments, or nil after the evaluation.
+      def __expression__
+        @expression
+      end
+
+      # Takes the result of the expression evaluated by `Lazy`.
+      def __evaluated__(array) # :nodoc:
+        __adopt__(array)
+        @expression = nil
+      end
+
+      def inspect
+        return super unless @expression
+        "#<#{self.class} (not evaluated)>"
+      end
+
+      private
+
+      def __materialize__
+        __evaluated__(Lazy.evaluate(self))
+      end
+    end
+
+    module Lazy
+      # The key of the nesting level of `NDArray.lazy` in the fiber-local
+      # storage.
+      DEPTH_KEY = :__mxnet_ndarray_lazy_depth__
+
+      # The key of the lazy arrays created in the outermost `NDArray.lazy`
+      # in the fiber-local storage.
+      PENDING_KEY = :__mxnet_ndarray_lazy_pending__
+
+      # The maximum number of the cached ops kept.
+      CACHE_SIZE = 128
+
+      # The elementwise operations that are deferred.
+      ELEMENTWISE_OPS = {
+        Ops: %i[
+          broadcast_add broadcast_sub broadcast_mul broadcast_div broadcast_mod
+          broadcast_power broadcast_maximum broadcast_minimum
+          broadcast_equal broadcast_not_equal broadcast_greater
+          broadcast_greater_equal broadcast_lesser broadcast_lesser_equal
+          elemwise_add elemwise_sub elemwise_mul elemwise_div
+          Activation relu sigmoid tanh exp expm1 log log1p sqrt rsqrt square
+          abs sign negative reciprocal clip floor ceil round rint fix trunc
+          sin cos
+        ],
+        Internal: %i[
+          _plus_scalar _minus_scalar _rminus_scalar _mul_scalar _div_scalar
+          _rdiv_scalar _mod_scalar _rmod_scalar _power_scalar _rpower_scalar
+          _maximum_scalar _minimum_scalar _equal_scalar _not_equal_scalar
+          _greater_scalar _greater_equal_scalar _lesser_scalar
+          _lesser_equal_scalar _plus _minus _mul _div
+        ]
+      }.freeze
+
+      @cache = {}
+      @mutex = Mutex.new
+
+      class << self
+        def enabled?
+          Thread.current[DEPTH_KEY].to_i > 0
+        end
+
+        def enable
+          raise ArgumentError, "no block given" unless block_given?
+          depth = Thread.current[DEPTH_KEY].to_i
+          LibMXNet._hook_ops(true)
+          begin
+            Thread.current[DEPTH_KEY] = depth + 1
+            result = yield
+          ensure
+            Thread.current[DEPTH_KEY] = depth
+            LibMXNet._hook_ops(false)
+            # The arrays pending on an error are evaluated when they are read.
+            pending = Thread.current[PENDING_KEY] if depth == 0
+            Thread.current[PENDING_KEY] = nil if depth == 0
+          end
+          flush(pending, collect_lazy_arrays(result, [])) if pending
+          result
+        end
+
+        # Defers the operation if possible, or runs it after evaluating the
+        # lazy arrays in the arguments.
+        def record_op(handle, ndargs, keys, vals, out) # :nodoc:
+          if out.nil? && enabled? && elementwise_op?(handle) && !Autograd.recording?
+            array = LazyArray.new(handle, ndargs, keys, vals)
+            (Thread.current[PENDING_KEY] ||= {}.compare_by_identity)[array] = true
+            array
+          else
+            if out && (pending = Thread.current[PENDING_KEY])
+              evaluate_readers(pending, out.is_a?(Array) ? out : [out])
+            end
+            LibMXNet._imperative_invoke_now(handle, ndargs, keys, vals, out)
+          end
+        end
+
+        # Evaluates the expression of the lazy array.
+        #
+        # @return [NDArray] The new array of the result.
+        def evaluate(root) # :nodoc:
+          evaluate_all([root])[0]
+        end
+
+        # Evaluates the expressions of the lazy arrays by one cached op.  The
+        # intermediate arrays of them are no longer pending.
+        #
+        # @return [Array<NDArray>] The new arrays of the results.
+        def evaluate_all(roots) # :nodoc:
+          pending = Thread.current[PENDING_KEY]
+          if roots.length == 1
+            op_handle, inputs, keys, vals = roots[0].__expression__
+            unless inputs.any? {|input| input.is_a?(LazyArray) && input.__expression__ }
+              pending&.delete(roots[0])
+              return [LibMXNet._imperative_invoke_now(op_handle, inputs, keys, vals, nil)]
+            end
+          end
+
+          leaves = []
+          nodes = []
+          leaf_index = {}.compare_by_identity
+          node_index = {}.compare_by_identity
+          outputs = roots.map {|root| flatten(root, leaves, leaf_index, nodes, node_index)[1] }
+          node_index.each_key {|node| pending.delete(node) } if pending
+
+          signature = [
+            nodes.map {|op, refs, op_keys, op_vals| [op, refs, op_keys.map(&:to_s), op_vals.map(&:to_s)] },
+            leaves.map {|leaf| [leaf.shape, leaf.dtype, leaf.context.to_s] },
+            outputs
+          ]
+          cached_op, order = fetch_cached_op(signature) { compile(nodes, leaves.length, outputs) }
+          results = cached_op.(*order.map {|i| leaves[i] })
+          results.is_a?(Array) ? results : [results]
+        end
+
+        # The number of the cached ops.
+        def cache_size
+          @mutex.synchronize { @cache.size }
+        end
+
+        def clear_cache
+          @mutex.synchronize { @cache.clear }
+        end
+
+        private
+
+        def elementwise_op?(handle)
+          @elementwise_handles ||= ELEMENTWISE_OPS.each_with_object({}) do |(mod_name, names), handles|
+            mod = NDArray.const_get(mod_name)
+            names.each do |name|
+              op_handle = OpInfo.lookup_handle(mod, name) rescue next
+              handles[op_handle] = true
+            end
+          end
+          @elementwise_handles.key?(handle)
+        end
+
+        # Lists the operations of the expression in the topological order,
+        # and the arrays given to them.  The inputs of an operation are
+        # referred by `[:leaf, index]` or `[:node, index]`.
+        def flatten(array, leaves, leaf_index, nodes, node_index)
+          expression = array.is_a?(LazyArray) && array.__expression__
+          unless expression
+            index = leaf_index[array] ||= (leaves << array).length - 1
+            return [:leaf, index]
+          end
+          index = node_index[array]
+          return [:node, index] if index
+
+          op_handle, inputs, keys, vals = expression
+          refs = inputs.map {|input| flatten(input, leaves, leaf_index, nodes, node_index) }
+          nodes << [op_handle, refs, keys, vals]
+          node_index[array] = nodes.length - 1
+          [:node, nodes.length - 1]
+        end
+
+        # Evaluates the given lazy arrays and the pending ones not used by
+        # the other pending ones at once.
+        def flush(pending, roots)
+          used = {}.compare_by_identity
+          pending.each_key do |array|
+            expression = array.__expression__
+            expression[1].each {|input| used[input] = true } if expression
+          end
+          outputs = {}.compare_by_identity
+          roots.each {|array| outputs[array] = true }
+          pending.each_key {|array| outputs[array] = true unless used.key?(array) }
+          evaluate_roots(outputs.keys)
+        end
+
+        # Evaluates the pending lazy arrays reading any of the arrays about to
+        # be written, including the intermediate ones.
+        def evaluate_readers(pending, written)
+          written = written.each_with_object({}.compare_by_identity) {|array, h| h[array] = true }
+          memo = {}.compare_by_identity
+          evaluate_roots(pending.keys.select {|array| reads?(array, written, memo) })
+        end
+
+        def reads?(array, written, memo)
+          return true if written.key?(array)
+          expression = array.is_a?(LazyArray) && array.__expression__
+          return false unless expression
+          memo.fetch(array) do
+            memo[array] = expression[1].any? {|input| reads?(input, written, memo) }
+          end
+        end
+
+        def evaluate_roots(roots)
+          roots = roots.select(&:__expression__)
+          return if roots.empty?
+          roots.zip(evaluate_all(roots)) {|root, result| root.__evaluated__(result) }
+        end
+
+        # Lists the lazy arrays not evaluated in the value of the block.
+        def collect_lazy_arrays(value, arrays)
+          case value
+          when LazyArray
+            arrays << value if value.__expression__
+          when Array
+            value.each {|item| collect_lazy_arrays(item, arrays) }
+          when Hash
+            value.each_value {|item| collect_lazy_arrays(item, arrays) }
+          end
+          arrays
+        end
+
+        def fetch_cached_op(signature)
+          @mutex.synchronize do
+            entry = @cache.delete(signature)
+            unless entry
+              entry = yield
+              @cache.shift if @cache.size >= CACHE_SIZE
+            end
+            @cache[signature] = entry
+          end
+        end
+
+        # Returns the cached op of the operations with the outputs of the
+        # given nodes, and the indices of the leaves in the order of its
+        # inputs.
+        def compile(nodes, num_leaves, outputs)
+          vars = Array.new(num_leaves) {|i| MXNet::Symbol.var(:"lazy_input#{i}") }
+          syms = []
+          nodes.each_with_index do |(op_handle, refs, keys, vals), i|
+            args = refs.map {|kind, j| kind == :leaf ? vars[j] : syms[j] }
+            syms << LibMXNet.symbol_creator(op_handle, args, nil, keys, vals, "lazy#{i}")
+          end
+          sym = outputs.length == 1 ? syms[outputs[0]] : MXNet::Symbol.group(outputs.map {|i| syms[i] })
+          order = sym.list_inputs.map {|name| Integer(name.to_s.delete_prefix('lazy_input')) }
+          [CachedOp.new(sym, static_alloc: true, static_shape: true), order]
+        end
+      end
+    end
+  end
+end
@@ -0,0 +1,190 @@
+require 'stringio'
+
+module MXNet
+  class NDArray
+    # Reader of the file format written by `NDArray.save`.
+    #
+    # Only the headers of the arrays are read when the reader is opened.
+    # The data of each array is located by its byte offset, so the arrays
+    # can be copied one by one without loading the whole file.
+    class ParamsReader
+      LIST_MAGIC = 0x112
+      V1_MAGIC = 0xF993fac8
+      V2_MAGIC = 0xF993fac9
+      V3_MAGIC = 0xF993faca
+
+      LIST_MAGIC_BYTES = [LIST_MAGIC].pack('Q<').freeze
+
+      DTYPE_SIZES = {
+        0 => 4, # float32
+        1 => 8, # float64
+        2 => 2, # float16
+        3 => 1, # uint8
+        4 => 4, # int32
+        5 => 1, # int8
+        6 => 8, # int64
+      }.freeze
+
+      # The header of an array in the file.
+      #
+      # `shape` is `nil` for an array saved without data.
+      Entry = Struct.new(:name, :shape, :dtype, :offset, :nbytes)
+
+      # Returns true if the given String is the content of a params file,
+      # not a file name.
+      def self.buffer?(source)
+        source.is_a?(String) && source.byteslice(0, 8) == LIST_MAGIC_BYTES
+      end
+
+      # Open a reader for a file name, a `Pathname`, an `IO`, or a String
+      # that holds the content of a params file.
+      def self.open(source)
+        reader = new(source)
+        return reader unless block_given?
+        begin
+          yield reader
+        ensure
+          reader.close
+        end
+      end
+
+      def initialize(source)
+        @buffer = nil
+        @close_io = false
+        if ParamsReader.buffer?(source)
+          @buffer = source
+          @io = StringIO.new(source)
+        elsif source.respond_to?(:read) && source.respond_to?(:seek)
+          @io = source
+        else
+          source = source.to_path if source.respond_to?(:to_path)
+          @io = File.open(source, 'rb')
+          @close_io = true
+        end
+        begin
+          @entries = read_entries
+        rescue Exception
+          close
+          raise
+        end
+      end
+
+      attr_reader :entries
+
+      # Returns true if the arrays in the file are named.
+      def named?
+        !@entries.empty? && !@entries[0].name.nil?
+      end
+
+      def close
+        @io.close if @close_io
+        @io = nil
+      end
+
+      # Copy the data of the given entry into `ndarray`.
+      #
+      # The shape and the dtype of `ndarray` must match those of the entry.
+      def copy_to(entry, ndarray)
+        return ndarray if entry.nbytes == 0
+        if @buffer
+          ndarray.send(:_copy_from_buffer, @buffer, entry.offset)
+        elsif (fd = io_fd)
+          ndarray.send(:_copy_from_fd, fd, entry.offset)
+        else
+          @io.seek(entry.offset, ::IO::SEEK_SET)
+          ndarray.send(:_copy_from_buffer, @io.read(entry.nbytes), 0)
+        end
+        ndarray
+      end
+
+      private
+
+      # The file descriptor of the IO, or nil for an IO-like object without
+      # one, such as StringIO.
+      def io_fd
+        return nil unless @io.respond_to?(:fileno)
+        fd = @io.fileno
+        fd.is_a?(Integer) ? fd : nil
+      rescue NotImplementedError, IOError
+        nil
+      end
+
+      def read_bytes(n)
+        str = @io.read(n)
+        if str.nil? || str.bytesize != n
+          raise EOFError, "unexpected end of file while reading NDArray header"
+        end
+        str
+      end
+
+      def read_u64
+        read_bytes(8).unpack('Q<')[0]
+      end
+
+      def read_u32
+        read_bytes(4).unpack('L<')[0]
+      end
+
+      def read_i32
+        read_bytes(4).unpack('l<')[0]
+      end
+
+      def read_entries
+        header = read_u64
+        _reserved = read_u64
+        unless header == LIST_MAGIC
+          raise MXNet::Error, "Invalid NDArray file format"
+        end
+
+        entries = Array.new(read_u64) { read_entry }
+
+        num_names = read_u64
+        if num_names > 0
+          unless num_names == entries.length
+            raise MXNet::Error, "the loaded file is broken (out_size != out_name_size)."
+          end
+          entries.each do |entry|
+            entry.name = read_bytes(read_u64).force_encoding(Encoding::UTF_8)
+          end
+        end
+
+        entries
+      end
+
+      def read_entry
+        magic = read_u32
+        case magic
+        when V2_MAGIC, V3_MAGIC
+          stype = read_i32
+          unless stype == 0
+            raise NotImplementedError, "loading sparse NDArray (stype=#{stype}) is not supported"
+          end
+          ndim = read_i32
+          shape = ndim > 0 ? read_bytes(8 * ndim).unpack('q<*') : []
+          none = magic == V3_MAGIC ? ndim < 0 : ndim == 0
+        when V1_MAGIC
+          ndim = read_u32
+          shape = read_bytes(8 * ndim).unpack('q<*')
+          none = ndim == 0
+        else
+          # legacy format, the magic is the number of dimensions
+          ndim = magic
+          shape = read_bytes(4 * ndim).unpack('L<*')
+          none = ndim == 0
+        end
+        return Entry.new(nil, nil, nil, @io.pos, 0) if none
+
+        _dev_type = read_i32
+        _dev_id = read_i32
+        dtype = read_i32
+        elsize = DTYPE_SIZES[dtype]
+        raise MXNet::Error, "unknown dtype #{dtype} in NDArray file" unless elsize
+
+        nbytes = elsize * shape.inject(1, :*)
+        offset = @io.pos
+        @io.seek(nbytes, ::IO::SEEK_CUR)
+        Entry.new(nil, shape, MXNet::DType.id2name(dtype), offset, nbytes)
+      end
+    end
+  end
+end
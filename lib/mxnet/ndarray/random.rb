@@ -49,7 +49,7 @@ module MXNet
       # NOTE: The input distribution must be normalized,
       #       i.e. `data` must sum to 1 along its last dimension.
       def multinomial(data, shape: nil, dtype: nil, get_prob: false, out: nil, **kwargs) 
-        NDArray::Internal._sample_multinomial(data, shape, get_prob, out: out, **kwargs)
+        NDArray::Internal._sample_multinomial(data, shape: shape, get_prob: get_prob, dtype: dtype, out: out, **kwargs)
       end
 
       def _random_helper(random, sampler, params, shape, dtype, ctx, out, kwargs)
@@ -63,18 +63,24 @@ module MXNet
           end
           NDArray::Internal.send(sampler, first_value, *rest_values, shape: shape, dtype: dtype, out: out, **kwargs)
         elsif first_value.is_a? Numeric
-          ctx = Context.current if ctx.nil?
-          shape = 1 if shape.nil? && out.nil?
+          # The samples are written into `out` on its context, without
+          # allocating a new array.
+          if out
+            ctx = nil
+          else
+            ctx = Context.current if ctx.nil?
+            shape = 1 if shape.nil?
+          end
           rest_values.each do |i|
             unless i.is_a? Numeric
               raise ArgumentError, "Distributed parameters must all have the same type, but got " +
                 "both #{first_value.class} and #{i.class}"
             end
           end
-          NDArray::Internal.send(random, **params, shape: shape, dtype: dtype, out: out, **kwargs)
+          NDArray::Internal.send(random, **params, shape: shape, dtype: dtype, ctx: ctx, out: out, **kwargs)
         else
           raise ArgumentError, "Distribution parameters must be either NDArray or Numeric, " +
-            "but got #{params[0].class}."
+            "but got #{first_value.class}."
         end
       end
     end
@@ -0,0 +1,261 @@
+module MXNet
+  # Custom operators implemented in Ruby.
+  #
+  # A custom operator is defined by a subclass of `CustomOpProp`, which
+  # declares the inputs and the outputs and infers their shapes, and a
+  # subclass of `CustomOp`, which computes them.  It is registered with a
+  # name, and used through the `Custom` operator of NDArray and Symbol.
+  # It works in both the symbolic execution and autograd.
+  #
+  #     class Sigmoid < MXNet::Operator::CustomOp
+  #       def forward(is_train, req, in_data, out_data, aux)
+  #         y = 1.0 / (1.0 + MXNet::NDArray.exp(-in_data[0]))
+  #         assign(out_data[0], req[0], y)
+  #       end
+  #
+  #       def backward(req, out_grad, in_data, out_data, in_grad, aux)
+  #         y = out_data[0]
+  #         assign(in_grad[0], req[0], out_grad[0] * y * (1.0 - y))
+  #       end
+  #     end
+  #
+  #     class SigmoidProp < MXNet::Operator::CustomOpProp
+  #       def create_operator(ctx, in_shapes, in_dtypes)
+  #         Sigmoid.new
+  #       end
+  #     end
+  #
+  #     MXNet::Operator.register(:sigmoid, SigmoidProp)
+  #     y = MXNet::NDArray.Custom(x, op_type: :sigmoid)
+  #
+  # == Threading
+  #
+  # libmxnet runs `forward` and `backward` on its worker threads, which
+  # Ruby does not know.  Each call is handed to a Ruby thread that serves
+  # the callbacks, and runs when the thread gets the GVL, so a call costs
+  # two thread switches and waits for the other Ruby threads holding the
+  # GVL.  The calls of all the custom operators are serialized.  Use
+  # custom operators for the layers that have no built-in operator, and
+  # compose them from the NDArray operations, which themselves run on
+  # the worker threads of libmxnet without the GVL.
+  #
+  # The reads of NDArrays, such as `wait_to_read`, `to_a` and
+  # `to_narray`, release the GVL while waiting for the computation, so
+  # that the custom operators computing the array can run.
+  module Operator
+    @registry = {}
+
+    # Register a custom operator.
+    #
+    # @param op_type [String, Symbol]  The name of the operator, given as
+    #   `op_type:` to the `Custom` operator.
+    # @param prop_class [Class]  A subclass of `CustomOpProp`.  It is
+    #   instantiated with the keyword arguments given to the `Custom`
+    #   operator, other than `op_type:`, as Strings.
+    # @return [Class] prop_class
+    def self.register(op_type, prop_class)
+      unless prop_class.is_a?(Class) && prop_class <= CustomOpProp
+        raise TypeError, "prop_class must be a subclass of MXNet::Operator::CustomOpProp"
+      end
+      op_type = op_type.to_s
+      @registry[op_type] = prop_class
+      _register_custom_op(op_type)
+      prop_class
+    end
+
+    # Returns the class registered for the custom operator.
+    #
+    # @param op_type [String, Symbol]
+    # @return [Class, nil]
+    def self.lookup(op_type)
+      @registry[op_type.to_s]
+    end
+
+    def self._create_prop_entry(op_type, kwargs)
+      prop_class = @registry.fetch(op_type) do
+        raise ArgumentError, "unknown custom operator: #{op_type}"
+      end
+      prop_class.new(**kwargs)
+    end
+    private_class_method :_create_prop_entry
+
+    # The base class of the computations of custom operators.
+    class CustomOp
+      REQ_NAMES = [:null, :write, :inplace, :add].freeze
+
+      # Compute the outputs.
+      #
+      # @param is_train [true, false]  Whether the forward is for training.
+      # @param req [Array<Symbol>]  How to assign to each of `out_data`,
+      #   one of `:null`, `:write`, `:inplace` and `:add`.
+      # @param in_data [Array<NDArray>]  The inputs.
+      # @param out_data [Array<NDArray>]  The outputs to be assigned.
+      # @param aux [Array<NDArray>]  The auxiliary states.
+      def forward(is_train, req, in_data, out_data, aux)
+        raise NotImplementedError
+      end
+
+      # Compute the gradients of the inputs.
+      #
+      # @param req [Array<Symbol>]  How to assign to each of `in_grad`.
+      # @param out_grad [Array<NDArray>]  The gradients of the outputs.
+      # @param in_data [Array<NDArray>]  The inputs.
+      # @param out_data [Array<NDArray>]  The outputs.
+      # @param in_grad [Array<NDArray>]  The gradients of the inputs to be assigned.
+      # @param aux [Array<NDArray>]  The auxiliary states.
+      def backward(req, out_grad, in_data, out_data, in_grad, aux)
+        raise NotImplementedError
+      end
+
+      # Assign `src` to `dst` according to `req`.
+      def assign(dst, req, src)
+        case req
+        when :null
+          # do nothing
+        when :write, :inplace
+          dst[0..-1] = src
+        when :add
+          dst.inplace + src
+        else
+          raise ArgumentError, "unknown req: #{req.inspect}"
+        end
+      end
+
+      private
+
+      # The entries are called on a Ruby thread, not on the worker of
+      # libmxnet that has the training state of the operator, so the state
+      # is set for the operations called in `forward` and `backward`.
+      def _forward_entry(is_train, reqs, tensors)
+        in_data, out_data, _, _, aux = tensors
+        Autograd.pause(is_train) do
+          Context.with(out_data[0].context) do
+            forward(is_train, reqs.map {|r| REQ_NAMES[r] }, in_data, out_data, aux)
+          end
+        end
+      end
+
+      def _backward_entry(is_train, reqs, tensors)
+        in_data, out_data, in_grad, out_grad, aux = tensors
+        Autograd.pause(is_train) do
+          Context.with(in_grad[0].context) do
+            backward(reqs.map {|r| REQ_NAMES[r] }, out_grad, in_data, out_data, in_grad, aux)
+          end
+        end
+      end
+    end
+
+    # The base class of the declarations of custom operators.
+    #
+    # By default, the operator has an input `data` and an output `output`
+    # of the same shape and dtype.
+    class CustomOpProp
+      # @param need_top_grad [true, false]  Whether `backward` needs the
+      #   gradients of the outputs.  It is false for loss layers.
+      def initialize(need_top_grad: true)
+        @need_top_grad = need_top_grad
+      end
+
+      attr_reader :need_top_grad
+
+      # The names of the inputs.
+      def list_arguments
+        ['data']
+      end
+
+      # The names of the outputs.
+      def list_outputs
+        ['output']
+      end
+
+      # The names of the auxiliary states.
+      def list_auxiliary_states
+        []
+      end
+
+      # Infer the shapes of the outputs and the auxiliary states from the
+      # shapes of the inputs.
+      #
+      # @param in_shape [Array<Array<Integer>>]  The shapes of the inputs.
+      # @return [Array] The shapes of the inputs, the outputs, and
+      #   optionally the auxiliary states.
+      def infer_shape(in_shape)
+        [in_shape,
+         [in_shape[0]] * list_outputs.length,
+         [in_shape[0]] * list_auxiliary_states.length]
+      end
+
+      # Infer the dtypes of the outputs and the auxiliary states from the
+      # dtypes of the inputs.
+      #
+      # @param in_type [Array<Symbol>]  The dtypes of the inputs.
+      # @return [Array] The dtypes of the inputs, the outputs, and
+      #   optionally the auxiliary states.
+      def infer_type(in_type)
+        [in_type,
+         [in_type[0]] * list_outputs.length,
+         [in_type[0]] * list_auxiliary_states.length]
+      end
+
+      # Declare the data that `backward` uses, so that the others can be
+      # released early.
+      #
+      # @return [Array<Integer>] The ids of the needed data.
+      def declare_backward_dependency(out_grad, in_data, out_data)
+        deps = []
+        deps.concat(out_grad) if @need_top_grad
+        deps.concat(in_data)
+        deps.concat(out_data)
+        deps
+      end
+
+      # Create the computation of the operator.
+      #
+      # @param ctx [Context]  The device context.
+      # @param in_shapes [Array<Array<Integer>>]  The shapes of the inputs.
+      # @param in_dtypes [Array<Symbol>]  The dtypes of the inputs.
+      # @return [CustomOp]
+      def create_operator(ctx, in_shapes, in_dtypes)
+        raise NotImplementedError
+      end
+
+      private
+
+      def _infer_shape_entry(shapes)
+        n_in = list_arguments.length
+        in_shapes, out_shapes, aux_shapes = _check_inferred('infer_shape', infer_shape(shapes[0, n_in]))
+        [*in_shapes, *out_shapes, *aux_shapes].map {|shape| shape.to_a.map(&:to_i) }
+      end
+
+      def _infer_type_entry(type_ids)
+        n_in = list_arguments.length
+        in_types = type_ids[0, n_in].map {|id| DType.id2name(id) }
+        in_types, out_types, aux_types = _check_inferred('infer_type', infer_type(in_types))
+        [*in_types, *out_types, *aux_types].map {|dtype| dtype.nil? ? -1 : DType.name2id(dtype) }
+      end
+
+      def _check_inferred(name, ret)
+        ins, outs, auxs = ret
+        auxs ||= []
+        if ins.length != list_arguments.length ||
+           outs.length != list_outputs.length ||
+           auxs.length != list_auxiliary_states.length
+          raise ArgumentError, "#{self.class}##{name} returns the wrong number of entries"
+        end
+        [ins, outs, auxs]
+      end
+
+      def _create_operator_entry(ctx_str, shapes, dtype_ids)
+        unless /\A(\w+)\((\d+)\)\z/ =~ ctx_str
+          raise ArgumentError, "unknown context: #{ctx_str}"
+        end
+        ctx = Context.new($1, $2.to_i)
+        op = create_operator(ctx, shapes, dtype_ids.map {|id| DType.id2name(id) })
+        unless op.is_a?(CustomOp)
+          raise TypeError, "#{self.class}#create_operator must return a MXNet::Operator::CustomOp"
+        end
+        op
+      end
+    end
+  end
+end
@@ -0,0 +1,133 @@
+module MXNet
+  # Predictor runs the forward computation of a trained model with the
+  # predict API of libmxnet.
+  #
+  # Unlike binding a symbol to an `Executor`, a predictor allocates no
+  # gradient buffers, and its inputs and outputs are exchanged with raw
+  # float32 buffers, i.e. binary Strings or `Numo::SFloat`s, without
+  # creating NDArrays.
+  #
+  #     predictor = MXNet::Predictor.new(File.read('model-symbol.json'),
+  #                                      File.binread('model-0010.params'),
+  #                                      input_shapes: {data: [1, 784]})
+  #     predictor.forward(data: image)
+  #     prob = predictor.output(0, out: prob)
+  #
+  class Predictor
+    # @param symbol_json [String]  The JSON of the symbol.
+    # @param params [String]  The content of the params file saved by
+    #   `Model.save_checkpoint` or `NDArray.save`.  The `arg:` and `aux:`
+    #   prefixes of the names are recognized.
+    # @param input_shapes [Hash{String, Symbol => Array<Integer>}]
+    #   The shapes of the inputs.
+    # @param ctx [Context]  The device context.  The default is `Context.default`.
+    def initialize(symbol_json, params, input_shapes:, ctx: nil)
+      ctx ||= Context.default
+      keys, shapes = normalize_input_shapes(input_shapes)
+      _create(symbol_json, params, ctx.device_type_id, ctx.device_id, keys, shapes)
+      setup(MXNet::Symbol.load_json(symbol_json).list_outputs, ctx, Hash[keys.zip(shapes)])
+    end
+
+    attr_reader :ctx, :input_shapes, :output_names
+
+    # Create a predictor for new input shapes.
+    #
+    # The returned predictor shares the parameters with this predictor.
+    #
+    # @param input_shapes [Hash{String, Symbol => Array<Integer>}]
+    # @return [Predictor]
+    def reshape(input_shapes)
+      keys, shapes = normalize_input_shapes(input_shapes)
+      _reshape(keys, shapes).tap do |other|
+        other.send(:setup, @output_names, @ctx, @input_shapes.merge(Hash[keys.zip(shapes)]))
+      end
+    end
+
+    # Set the data of an input.
+    #
+    # @param name [String, Symbol]  The name of the input.
+    # @param data [String, Numo::NArray, Array<Numeric>]  A binary String of
+    #   native float32 values, a `Numo::NArray`, or an Array of numbers.
+    #   The number of the values must match the input shape.
+    # @return [Predictor] self
+    def set_input(name, data)
+      case data
+      when String
+        _set_input(name, data)
+      when Array
+        _set_input(name, data.flatten.pack('f*'))
+      else
+        if defined?(::Numo::NArray) && data.is_a?(::Numo::NArray)
+          require 'mxnet/narray_helper'
+          MXNet::NArrayHelper.predictor_set_input(self, name, data)
+        else
+          raise TypeError, "unsupported input data type (#{data.class})"
+        end
+      end
+      self
+    end
+
+    # Set the given inputs, and run the forward computation.
+    #
+    # The GVL is released during the computation.
+    #
+    # @param inputs [Hash{Symbol => String, Numo::NArray, Array<Numeric>}]
+    # @return [Predictor] self
+    def forward(**inputs)
+      inputs.each {|name, data| set_input(name, data) }
+      _forward
+    end
+
+    # NATIVE: output_shape(index)
+
+    # The number of the outputs.
+    def num_outputs
+      @output_names.length
+    end
+
+    # Copy the output at `index` to `out`.
+    #
+    # The copy waits for the forward computation to finish.  The GVL is
+    # released while waiting.
+    #
+    # @param index [Integer]  The index of the output.
+    # @param out [String, Numo::SFloat, nil]  The buffer to copy into.
+    #   A String is resized to fit the output, and a `Numo::SFloat` must have
+    #   the same size as the output.  A new binary String is returned when
+    #   `out` is nil.
+    # @return [String, Numo::SFloat] out
+    def output(index=0, out: nil)
+      case out
+      when nil
+        _get_output(index, String.new(encoding: Encoding::BINARY))
+      when String
+        _get_output(index, out)
+      else
+        if defined?(::Numo::NArray) && out.is_a?(::Numo::NArray)
+          require 'mxnet/narray_helper'
+          MXNet::NArrayHelper.predictor_get_output(self, index, out)
+        else
+          raise TypeError, "unsupported output buffer type (#{out.class})"
+        end
+      end
+    end
+
+    private
+
+    def setup(output_names, ctx, input_shapes)
+      @output_names = output_names
+      @ctx = ctx
+      @input_shapes = input_shapes
+    end
+
+    def normalize_input_shapes(input_shapes)
+      keys = []
+      shapes = []
+      input_shapes.each do |key, shape|
+        keys << key.to_s
+        shapes << Array(shape).map(&:to_i)
+      end
+      [keys, shapes]
+    end
+  end
+end
@@ -2,6 +2,47 @@ require 'mxnet/ndarray/random'
 
 module MXNet
   module Random
-    # native: self.seed
+    # NATIVE: self.seed
+
+    MASK64 = 0xFFFF_FFFF_FFFF_FFFF
+    private_constant :MASK64
+
+    # Derive the seed of a worker from the base seed.
+    #
+    # The seeds are mixed by SplitMix64, so that the random streams of the
+    # workers are not correlated, even for consecutive base seeds and
+    # worker ids.  The same base seed and worker id give the same seed.
+    #
+    # @param seed [Integer]  The base seed.
+    # @param worker_id [Integer]  The id of the worker, from 0.
+    # @return [Integer] The seed in the range of a C int.
+    def self.worker_seed(seed, worker_id)
+      state = (mix64(Integer(seed) & MASK64) + (Integer(worker_id) + 1) * 0x9E3779B97F4A7C15) & MASK64
+      mix64(state) & 0x7FFF_FFFF
+    end
+
+    # Seed the random number generators of libmxnet and Ruby in a worker
+    # with the seed derived by `worker_seed`.
+    #
+    # Call it at the start of each worker of the parallel data loading, so
+    # that the random augmentations are reproducible and independent.
+    #
+    # @param seed [Integer]  The base seed.
+    # @param worker_id [Integer]  The id of the worker, from 0.
+    # @param ctx [Context, :all]  The context whose generators are seeded.
+    # @return [Integer] The seed of the worker.
+    def self.seed_worker(seed, worker_id, ctx: :all)
+      derived = worker_seed(seed, worker_id)
+      self.seed(derived, ctx: ctx)
+      Kernel.srand(derived)
+      derived
+    end
+
+    def self.mix64(z)
+      z = ((z ^ (z >> 30)) * 0xBF58476D1CE4E5B9) & MASK64
+      z = ((z ^ (z >> 27)) * 0x94D049BB133111EB) & MASK64
+      z ^ (z >> 31)
+    end
+    private_class_method :mix64
   end
 end
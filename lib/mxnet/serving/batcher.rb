@@ -0,0 +1,219 @@
+require 'thread'
+
+module MXNet
+  module Serving
+    # Batcher collects the inference requests from many threads into
+    # batches, and runs one forward computation for each batch.
+    #
+    # A batch is closed when it has `max_batch_size` requests, or when
+    # `max_latency` seconds have passed since its first request arrived.
+    # The inputs are packed into a preallocated input array, and each
+    # caller receives its own slice of the outputs.
+    #
+    # Partial batches run on executors bound to the leading rows of the
+    # input array.  They are cached by the batch size and share the memory
+    # with the executor of the full batch.
+    #
+    #     batcher = MXNet::Serving::Batcher.new(symbol, arg_params, aux_params,
+    #                                           data_shape: [784],
+    #                                           max_batch_size: 32,
+    #                                           max_latency: 0.002)
+    #     # in each request thread
+    #     prob = batcher.predict(image)
+    #
+    class Batcher
+      DEFAULT_MAX_LATENCY = 0.005
+
+      Request = Struct.new(:input, :enqueued_at, :reply)
+
+      # @param symbol [MXNet::Symbol]  The network.
+      # @param arg_params [Hash{String => NDArray}]  The parameters.
+      # @param aux_params [Hash{String => NDArray}]  The auxiliary states.
+      # @param data_name [String, Symbol]  The name of the input.
+      # @param data_shape [Array<Integer>]  The shape of an input without the batch axis.
+      # @param max_batch_size [Integer]  The maximum number of requests in a batch.
+      # @param max_latency [Float]  The maximum seconds for which a request waits
+      #   for the other requests to join its batch.
+      # @param ctx [Context]  The device context.  The default is `Context.default`.
+      # @param dtype [Symbol]  The dtype of the input.
+      def initialize(symbol, arg_params, aux_params={},
+                     data_name: :data, data_shape:, max_batch_size:,
+                     max_latency: DEFAULT_MAX_LATENCY, ctx: nil, dtype: :float32)
+        raise ArgumentError, "max_batch_size must be positive" unless max_batch_size > 0
+        raise ArgumentError, "max_latency must not be negative" if max_latency < 0
+
+        @symbol = symbol
+        @data_name = data_name.to_s
+        @data_shape = data_shape.to_a
+        @max_batch_size = max_batch_size
+        @max_latency = max_latency
+        @ctx = ctx || Context.default
+        @dtype = dtype
+
+        @arg_params = {}
+        arg_params.each {|k, v| @arg_params[k.to_s] = v.as_in_context(@ctx) }
+        @aux_params = {}
+        aux_params.each {|k, v| @aux_params[k.to_s] = v.as_in_context(@ctx) }
+
+        @input = NDArray.zeros([max_batch_size, *@data_shape], @ctx, dtype)
+        @executors = {}
+        @executors[max_batch_size] = bind(max_batch_size, nil)
+
+        @queue = []
+        @mutex = Mutex.new
+        @cond = ConditionVariable.new
+        @closed = false
+
+        @queue_latency = LatencyStats.new
+        @compute_latency = LatencyStats.new
+        @batch_sizes = Hash.new(0)
+
+        @thread = Thread.new { run }
+      end
+
+      attr_reader :max_batch_size, :max_latency, :data_shape, :ctx
+
+      # The latencies of the requests from the arrival to the start of the
+      # computation of their batch.
+      attr_reader :queue_latency
+
+      # The latencies of the forward computations of the batches.
+      attr_reader :compute_latency
+
+      # Run the inference of a single input.
+      #
+      # This method blocks until the output is computed.
+      #
+      # @param input [NDArray, Numo::NArray, Array]  An input of the shape `data_shape`.
+      # @return [NDArray, Array<NDArray>]  The output, or the outputs when
+      #   the network has multiple outputs.
+      def predict(input)
+        input = NDArray.array(input, ctx: @ctx, dtype: @dtype) if input.is_a?(Array)
+        unless input.shape.to_a == @data_shape
+          raise ArgumentError, "input shape must be #{@data_shape}, but #{input.shape}"
+        end
+
+        request = Request.new(input, now, Queue.new)
+        @mutex.synchronize do
+          raise ClosedQueueError, "batcher is closed" if @closed
+          start_thread
+          @queue << request
+          @cond.signal
+        end
+
+        status, value = request.reply.pop
+        raise value if status == :error
+        value
+      end
+
+      # The statistics of the batcher.
+      #
+      # The latencies are in seconds.
+      def stats
+        {
+          queue: @queue_latency.to_h,
+          compute: @compute_latency.to_h,
+          batch_sizes: @mutex.synchronize { @batch_sizes.dup }
+        }
+      end
+
+      # Stop accepting requests, and wait for the queued requests.
+      def close
+        @mutex.synchronize do
+          @closed = true
+          start_thread
+          @cond.broadcast
+        end
+        @thread.join
+        self
+      end
+
+      def closed?
+        @mutex.synchronize { @closed }
+      end
+
+      private
+
+      # Start the thread of the batches unless it is running, such as in
+      # a child process forked after the batcher is created, where the
+      # thread does not exist.  Called with @mutex locked.
+      def start_thread
+        @thread = Thread.new { run } unless @thread.alive?
+      end
+
+      def now
+        Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      end
+
+      def bind(batch_size, shared_exec)
+        input = batch_size == @max_batch_size ? @input : @input[0...batch_size]
+        arg_shapes, _, _ = @symbol.infer_shape(@data_name.to_sym => input.shape)
+        args = {}
+        @symbol.list_arguments.each_with_index do |name, i|
+          args[name] =
+            if name == @data_name
+              input
+            elsif @arg_params.key?(name)
+              @arg_params[name]
+            else
+              # labels of the loss layers are not used for the inference
+              NDArray.zeros(arg_shapes[i], @ctx)
+            end
+        end
+        @symbol.bind(@ctx, args, grad_req: :null, aux_states: @aux_params,
+                     shared_exec: shared_exec)
+      end
+
+      def executor_for(batch_size)
+        @executors[batch_size] ||= bind(batch_size, @executors[@max_batch_size])
+      end
+
+      def next_batch
+        @mutex.synchronize do
+          @cond.wait(@mutex) while @queue.empty? && !@closed
+          return nil if @queue.empty?
+
+          deadline = @queue[0].enqueued_at + @max_latency
+          while @queue.length < @max_batch_size && !@closed
+            remaining = deadline - now
+            break if remaining <= 0
+            @cond.wait(@mutex, remaining)
+          end
+          batch = @queue.shift(@max_batch_size)
+          @batch_sizes[batch.length] += 1
+          batch
+        end
+      end
+
+      def run
+        while (batch = next_batch)
+          process(batch)
+        end
+      end
+
+      def process(batch)
+        started_at = now
+        batch.each {|request| @queue_latency.record(started_at - request.enqueued_at) }
+
+        batch.each_with_index do |request, i|
+          @input[i] = request.input
+        end
+        outputs = executor_for(batch.length).forward(is_train: false)
+        results = Array.new(batch.length) do |i|
+          outputs.map {|output| output[i].dup }
+        end
+        results.each {|result| result.each(&:wait_to_read) }
+        @compute_latency.record(now - started_at)
+
+        batch.zip(results) do |request, result|
+          request.reply.push([:ok, result.length == 1 ? result[0] : result])
+        end
+      rescue Exception => error
+        # The error is raised in the callers of the batch.  The thread keeps
+        # running for the other callers, even for the errors other than
+        # StandardError, such as NoMemoryError.
+        batch.each {|request| request.reply.push([:error, error]) }
+      end
+    end
+  end
+end
@@ -0,0 +1,59 @@
+require 'thread'
+
+module MXNet
+  module Serving
+    # Records the recent latency samples and reports their percentiles.
+    #
+    # Only the last `capacity` samples are kept, so the percentiles follow
+    # the current load of the server.
+    class LatencyStats
+      DEFAULT_CAPACITY = 10_000
+
+      def initialize(capacity: DEFAULT_CAPACITY)
+        raise ArgumentError, "capacity must be positive" unless capacity > 0
+        @capacity = capacity
+        @samples = []
+        @cursor = 0
+        @count = 0
+        @mutex = Mutex.new
+      end
+
+      # The total number of the recorded samples.
+      attr_reader :count
+
+      # Record a latency in seconds.
+      def record(seconds)
+        @mutex.synchronize do
+          if @samples.length < @capacity
+            @samples << seconds
+          else
+            @samples[@cursor] = seconds
+            @cursor = (@cursor + 1) % @capacity
+          end
+          @count += 1
+        end
+        self
+      end
+
+      # Returns the `q`-th percentile of the recent samples in seconds,
+      # or nil if no sample is recorded.
+      def percentile(q)
+        sorted = @mutex.synchronize { @samples.sort }
+        return nil if sorted.empty?
+        sorted[((sorted.length - 1) * q / 100.0).round]
+      end
+
+      def p50
+        percentile(50)
+      end
+
+      def p99
+        percentile(99)
+      end
+
+      def to_h
+        { count: count, p50: p50, p99: p99 }
+      end
+    end
+  end
+end
@@ -0,0 +1,87 @@
+module MXNet
+  # The memory of the arrays, allocated by the storage pools of libmxnet.
+  module Storage
+    # NATIVE: self.empty_cache(ctx)
+    # NATIVE: self.gpu_count
+    # NATIVE: self.gpu_memory_info(dev_id)
+
+    # Returns the memory usage of the context.
+    #
+    # libmxnet does not report the bytes held by its storage pools, so the
+    # usage is measured from outside of them: the resident set of the
+    # process for the CPU, and the memory of the device for a GPU.  With
+    # `measure_cache: true`, the cache of the pool is released by
+    # `empty_cache`, and the memory returned by it is reported as
+    # `:cached_bytes`.  The released memory has to be allocated again by
+    # the later operations, so do not measure it in a hot loop.
+    #
+    #     MXNet::Storage.stats(measure_cache: true)
+    #     # => {ctx: "cpu(0)", rss_bytes: ..., peak_rss_bytes: ...,
+    #     #     cached_bytes: ..., settings: {"MXNET_CPU_MEM_POOL_TYPE" => "Round"}}
+    #
+    # The keys for the CPU:
+    #
+    # rss_bytes::      The resident set of the process, which includes the
+    #                  memory of Ruby and of the pool.
+    # peak_rss_bytes:: The peak of the resident set.
+    #
+    # The keys for a GPU:
+    #
+    # free_bytes::  The free memory of the device.
+    # total_bytes:: The total memory of the device.
+    # used_bytes::  `total_bytes - free_bytes`, including the other
+    #               processes.
+    #
+    # `:settings` is the environment variables of the pool of the device,
+    # `MXNET_CPU_MEM_POOL_*` or `MXNET_GPU_MEM_POOL_*`, read by libmxnet at
+    # its first allocation.  The values absent from the environment take
+    # the defaults of libmxnet.
+    #
+    # The values unavailable on the platform are nil.
+    #
+    # @param ctx [Context]  The context, the CPU by default.
+    # @param measure_cache [true, false]  Whether to measure the cache by
+    #   releasing it.
+    # @return [Hash{Symbol => Object}]
+    def self.stats(ctx=nil, measure_cache: false)
+      ctx ||= MXNet.cpu
+      gpu = ctx.device_type == :gpu
+      stats = { ctx: ctx.to_s }
+      if measure_cache
+        NDArray.waitall
+        before = gpu ? gpu_memory_info(ctx.device_id)[0] : rss_bytes
+        empty_cache(ctx)
+        after = gpu ? gpu_memory_info(ctx.device_id)[0] : rss_bytes
+      end
+      if gpu
+        free, total = gpu_memory_info(ctx.device_id)
+        stats.update(free_bytes: free, total_bytes: total, used_bytes: total - free)
+        stats[:cached_bytes] = [after - before, 0].max if measure_cache
+      else
+        stats.update(rss_bytes: rss_bytes, peak_rss_bytes: peak_rss_bytes)
+        stats[:cached_bytes] = (before && after) ? [before - after, 0].max : nil if measure_cache
+      end
+      prefix = gpu ? 'MXNET_GPU_MEM_POOL_' : 'MXNET_CPU_MEM_POOL_'
+      stats[:settings] = ENV.select {|name, _| name.start_with?(prefix) }
+      stats
+    end
+
+    # The resident set of the process in bytes, or nil if unknown.
+    def self.rss_bytes
+      proc_status_kb('VmRSS')
+    end
+
+    # The peak resident set of the process in bytes, or nil if unknown.
+    def self.peak_rss_bytes
+      proc_status_kb('VmHWM')
+    end
+
+    def self.proc_status_kb(key)
+      value = File.read('/proc/self/status')[/^#{key}:\s*(\d+)\s*kB/, 1]
+      value && Integer(value) * 1024
+    rescue SystemCallError
+      nil
+    end
+    private_class_method :proc_status_kb
+  end
+end
@@ -6,6 +6,7 @@ module MXNet
 
     # NATIVE: self.load
     # NATIVE: self.load_json
+    # NATIVE: self.group
 
     # Returns a new symbol of given shape and type, filled with zeros.
     #
@@ -125,6 +126,7 @@ module MXNet
 
     # NATIVE: save
     # NATIVE: to_json
+    # NATIVE: []
 
     # Evaluates a symbol given argumens.
     #
@@ -0,0 +1,209 @@
+module MXNet
+  # Raised when a traced computation cannot be recorded into a symbol.
+  class TraceError < Error
+  end
+
+  # Traces the imperative NDArray code into a symbol.
+  #
+  # The block is called once with a proxy for each input.  The operations
+  # called through `NDArray::Ops`, `NDArray::Internal` and the other
+  # operation modules, including the arithmetic operators of NDArray,
+  # are recorded instead of being run when their inputs include a proxy,
+  # and the returned symbol has the same computation without Ruby.
+  #
+  #     params = {}
+  #     sym = MXNet.trace({data: [64, 784]}, params: params) do |x|
+  #       model.forward(x)
+  #     end
+  #     exe = sym.bind(ctx, params.merge(data: batch))
+  #
+  # The other NDArrays used in the block, such as the weights of the
+  # model, are captured as the variables of the symbol, and stored into
+  # `params` with their names.  The arrays named in `params` in advance
+  # keep their names.
+  #
+  # The shape and the dtype of a proxy are inferred from the input shapes,
+  # but its values are not available, so the block cannot branch on the
+  # values, or call the methods reading them, such as `to_a` and
+  # `as_scalar`, which raise `TraceError`.  An operation without a proxy
+  # in its inputs, such as `NDArray.zeros`, runs when it is called, and its
+  # result is captured as a constant.
+  #
+  # @param input_shapes [Hash{Symbol => Array<Integer>}]  The names and the
+  #   shapes of the inputs, in the order of the arguments of the block.
+  # @param params [Hash{Symbol => NDArray}]  Receives the captured arrays.
+  # @return [Symbol]  The output, or the group of the outputs if the block
+  #   returns an Array.
+  def self.trace(input_shapes, params: nil, &block)
+    Tracer.new(input_shapes, params: params).trace(&block)
+  end
+
+  class Tracer
+    # @param input_shapes [Hash{Symbol => Array<Integer>}]
+    # @param params [Hash{Symbol => NDArray}]
+    def initialize(input_shapes, params: nil)
+      @input_shapes = input_shapes.map {|name, shape| [name.to_sym, shape.to_a] }.to_h
+      @params = params || {}
+      @captured = {}.compare_by_identity
+      @params.each {|name, array| @captured[array] = name.to_sym }
+      @variables = {}.compare_by_identity
+      @active = false
+    end
+
+    # The captured arrays by their names.
+    attr_reader :params
+
+    # Run the block with the proxies of the inputs.
+    #
+    # @return [Symbol]
+    def trace
+      raise ArgumentError, "no block given" unless block_given?
+      raise TraceError, "the tracer is already running" if @active
+      begin
+        @active = true
+        inputs = @input_shapes.each_key.map {|name| Proxy.new(self, MXNet::Symbol.var(name)) }
+        output_symbol(yield(*inputs))
+      ensure
+        @active = false
+      end
+    end
+
+    # Called by `LibMXNet.imperative_invoke` for the operations taking the
+    # arrays without the handles, such as the proxies, and for all the
+    # operations while `NDArray.lazy` is active.
+    def self.record_op(handle, ndargs, keys, vals, out) # :nodoc:
+      tracers = [*ndargs, *(out.is_a?(Array) ? out : [out])].grep(Proxy).map(&:__tracer__).uniq
+      raise TraceError, "the arrays traced by different tracers are mixed" if tracers.length > 1
+      return tracers[0].record_op(handle, ndargs, keys, vals, out) unless tracers.empty?
+      NDArray::Lazy.record_op(handle, ndargs, keys, vals, out)
+    end
+
+    def record_op(handle, ndargs, keys, vals, out) # :nodoc:
+      raise TraceError, "a traced array is used after MXNet.trace" unless @active
+
+      args = ndargs.map {|array| symbol_of(array) }
+      name = Name::NameManager.current.get(nil, self.class.op_hint(handle))
+      sym = LibMXNet.symbol_creator(handle, args, nil, keys, vals, name)
+      num_outputs = sym.list_outputs.length
+
+      if out
+        outs = out.is_a?(Array) ? out : [out]
+        unless outs.length == num_outputs && outs.all? {|o| o.is_a?(Proxy) }
+          raise TraceError, "the output of a traced operation must be written into the traced arrays"
+        end
+        outs.each_with_index {|o, i| o.__rebind__(num_outputs == 1 ? sym : sym[i]) }
+        return out
+      end
+
+      return Proxy.new(self, sym) if num_outputs == 1
+      Array.new(num_outputs) {|i| Proxy.new(self, sym[i]) }
+    end
+
+    def infer_shape(sym) # :nodoc:
+      _, out_shapes, _ = sym.infer_shape_partial(**known_args(sym) {|array| array.shape })
+      shape = out_shapes && out_shapes[0]
+      raise TraceError, "the shape of #{sym.name} cannot be inferred" unless shape && !shape.include?(0)
+      shape
+    end
+
+    def infer_type(sym) # :nodoc:
+      _, out_types, _ = sym.infer_type(**known_args(sym) {|array| array.dtype })
+      out_types && out_types[0]
+    end
+
+    # The names of the operations by their handles.
+    def self.op_hint(handle) # :nodoc:
+      @op_hints ||= [NDArray::Ops, NDArray::Internal, NDArray::Contrib, NDArray::Linalg, NDArray::Sparse].each_with_object({}) do |mod, hints|
+        mod.methods(false).each do |func_name|
+          op_handle = OpInfo.lookup_handle(mod, func_name) rescue next
+          hints[op_handle] ||= func_name.to_s.downcase.to_sym
+        end
+      end
+      @op_hints.fetch(handle, :op)
+    end
+
+    private
+
+    def symbol_of(array)
+      return array.__symbol__ if array.is_a?(Proxy)
+      name = @captured[array] ||= :"captured#{@captured.length}"
+      @params[name] = array
+      @variables[array] ||= MXNet::Symbol.var(name)
+    end
+
+    # The known shapes or dtypes of the arguments of the symbol.
+    def known_args(sym)
+      known = {}
+      sym.list_arguments.each do |name|
+        if @input_shapes.key?(name)
+          known[name] = yield(InputInfo.new(@input_shapes[name], :float32))
+        elsif (array = @params[name])
+          known[name] = yield(array)
+        end
+      end
+      known
+    end
+
+    InputInfo = Struct.new(:shape, :dtype)
+    private_constant :InputInfo
+
+    def output_symbol(outputs)
+      case outputs
+      when Proxy
+        outputs.__symbol__
+      when Array
+        MXNet::Symbol.group(outputs.map {|output| output_symbol(output) })
+      else
+        raise TraceError, "the output of the traced block must be a traced array, but got #{outputs.class}"
+      end
+    end
+
+    # The placeholder of a traced array, which has no handle of libmxnet.
+    class Proxy < NDArray
+      def initialize(tracer, symbol)
+        @tracer = tracer
+        @symbol = symbol
+      end
+
+      def __tracer__
+        @tracer
+      end
+
+      def __symbol__
+        @symbol
+      end
+
+      # Replaces the symbol by the operation writing into this array.
+      def __rebind__(symbol)
+        @symbol = symbol
+      end
+
+      def shape
+        @tracer.infer_shape(@symbol)
+      end
+
+      def dtype
+        @tracer.infer_type(@symbol)
+      end
+
+      def context
+        Context.default
+      end
+
+      def reshape(shape)
+        Ops.Reshape(self, shape: shape)
+      end
+
+      def inspect
+        "#<#{self.class} #{@symbol.name}>"
+      end
+
+      private
+
+      # Called when the data of this array is needed.
+      def __materialize__
+        raise TraceError, "the values of the traced array #{@symbol.name} are not available in MXNet.trace"
+      end
+    end
+  end
+end
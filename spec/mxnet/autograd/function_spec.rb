@@ -0,0 +1,91 @@
+require 'spec_helper'
+require 'json'
+
+module MXNet
+  module AutogradFunctionSpec
+    class Sigmoid < Autograd::Function
+      def forward(x)
+        y = 1.0 / (1.0 + NDArray.exp(-x))
+        save_for_backward(y)
+        y
+      end
+
+      def backward(dy)
+        y, = saved_tensors
+        dy * y * (1.0 - y)
+      end
+    end
+
+    class Mul < Autograd::Function
+      def forward(a, b)
+        save_for_backward(a, b)
+        a * b
+      end
+
+      def backward(dy)
+        a, b = saved_tensors
+        [dy * b, dy * a]
+      end
+    end
+
+    class Wrong < Autograd::Function
+      def forward(a, b)
+        a + b
+      end
+
+      def backward(dy)
+        dy
+      end
+    end
+  end
+
+  ::RSpec.describe Autograd::Function do
+    let(:x) { NDArray.array([0, 0, 0]) }
+
+    specify do
+      x.attach_grad
+      y = Autograd.record { AutogradFunctionSpec::Sigmoid.new.(x) }
+      expect(y.to_a).to eq([0.5, 0.5, 0.5])
+      y.backward
+      expect(x.grad.to_a).to eq([0.25, 0.25, 0.25])
+    end
+
+    specify 'only the node of the function is recorded' do
+      x.attach_grad
+      y = Autograd.record { AutogradFunctionSpec::Sigmoid.new.(x) }
+      nodes = JSON.parse(Autograd.get_symbol(y).to_json)['nodes']
+      expect(nodes.count {|node| node['op'] != 'null' }).to eq(1)
+    end
+
+    specify 'multiple inputs' do
+      a = NDArray.array([1, 2])
+      b = NDArray.array([3, 4])
+      a.attach_grad
+      b.attach_grad
+      Autograd.record { AutogradFunctionSpec::Mul.new.(a, b) }.backward
+      expect(a.grad.to_a).to eq([3.0, 4.0])
+      expect(b.grad.to_a).to eq([1.0, 2.0])
+    end
+
+    specify 'without recording' do
+      y = AutogradFunctionSpec::Sigmoid.new.(x)
+      expect(y.to_a).to eq([0.5, 0.5, 0.5])
+    end
+
+    specify 'a function can be called only once' do
+      f = AutogradFunctionSpec::Sigmoid.new
+      f.(x)
+      expect { f.(x) }.to raise_error(ArgumentError)
+    end
+
+    specify 'the wrong number of gradients' do
+      a = NDArray.array([1, 2])
+      a.attach_grad
+      y = Autograd.record { AutogradFunctionSpec::Wrong.new.(a, a) }
+      expect {
+        y.backward
+        a.grad.wait_to_read
+      }.to raise_error(MXNet::Error).and output(/must return 2 gradients/).to_stderr
+    end
+  end
+end
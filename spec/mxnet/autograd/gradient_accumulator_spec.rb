@@ -0,0 +1,56 @@
+require 'spec_helper'
+
+module MXNet
+  ::RSpec.describe Autograd::GradientAccumulator do
+    let(:w) { NDArray.array([1, 1]) }
+    let(:updates) { [] }
+
+    def make_accumulator(**kwargs)
+      Autograd::GradientAccumulator.new([w], steps: 2, **kwargs) do |params, grads|
+        updates << grads[0].to_a
+      end
+    end
+
+    specify do
+      accumulator = make_accumulator
+      accumulator.step { w * NDArray.array([1, 2]) }
+      expect(updates).to eq([])
+      expect(accumulator.count).to eq(1)
+
+      accumulator.step { w * NDArray.array([3, 4]) }
+      expect(updates).to eq([[2.0, 3.0]])
+      expect(accumulator.count).to eq(0)
+      expect(w.grad.to_a).to eq([0.0, 0.0])
+    end
+
+    specify 'average: false' do
+      accumulator = make_accumulator(average: false)
+      accumulator.step { w * NDArray.array([1, 2]) }
+      accumulator.step { w * NDArray.array([3, 4]) }
+      expect(updates).to eq([[4.0, 6.0]])
+    end
+
+    describe '#flush' do
+      specify do
+        accumulator = make_accumulator(average: false)
+        accumulator.flush
+        expect(updates).to eq([])
+
+        accumulator.step { w * NDArray.array([1, 2]) }
+        accumulator.flush
+        expect(updates).to eq([[1.0, 2.0]])
+      end
+
+      specify 'fewer micro-batches than steps with average: true' do
+        accumulator = Autograd::GradientAccumulator.new([w], steps: 4) do |params, grads|
+          updates << grads[0].to_a
+        end
+        accumulator.step { w * NDArray.array([1, 2]) }
+        accumulator.step { w * NDArray.array([3, 4]) }
+        accumulator.flush
+        expect(updates).to eq([[2.0, 3.0]])
+        expect(w.grad.to_a).to eq([0.0, 0.0])
+      end
+    end
+  end
+end
@@ -5,6 +5,86 @@ RSpec.describe MXNet::Autograd do
     specify do
       expect { |b| MXNet::Autograd.record(&b) }.to yield_control
     end
+
+    specify do
+      expect(MXNet::Autograd.record { 42 }).to eq(42)
+    end
+
+    specify do
+      states = MXNet::Autograd.record do
+        [MXNet::Autograd.recording?, MXNet::Autograd.training?]
+      end
+      expect(states).to eq([true, true])
+      expect(MXNet::Autograd.recording?).to eq(false)
+      expect(MXNet::Autograd.training?).to eq(false)
+    end
+
+    specify 'nested scopes' do
+      states = MXNet::Autograd.record do
+        MXNet::Autograd.pause do
+          [MXNet::Autograd.recording?, MXNet::Autograd.training?]
+        end.tap do
+          expect(MXNet::Autograd.recording?).to eq(true)
+          expect(MXNet::Autograd.training?).to eq(true)
+        end
+      end
+      expect(states).to eq([false, false])
+    end
+
+    specify 'the states are restored on an exception' do
+      expect {
+        MXNet::Autograd.record { raise 'error' }
+      }.to raise_error(RuntimeError, 'error')
+      expect(MXNet::Autograd.recording?).to eq(false)
+      expect(MXNet::Autograd.training?).to eq(false)
+    end
+
+    specify do
+      expect { MXNet::Autograd.record }.to raise_error(LocalJumpError)
+    end
+  end
+
+  describe '.train_mode' do
+    specify do
+      expect(MXNet::Autograd.train_mode { MXNet::Autograd.training? }).to eq(true)
+      expect(MXNet::Autograd.train_mode { MXNet::Autograd.recording? }).to eq(false)
+      expect(MXNet::Autograd.training?).to eq(false)
+    end
+  end
+
+  describe '.predict_mode' do
+    specify do
+      MXNet::Autograd.record do
+        expect(MXNet::Autograd.predict_mode { MXNet::Autograd.training? }).to eq(false)
+        expect(MXNet::Autograd.training?).to eq(true)
+      end
+    end
+  end
+
+  describe MXNet::Autograd::Recorder do
+    specify do
+      recorder = MXNet::Autograd::Recorder.new
+      expect(recorder.recording?).to eq(true)
+      expect(recorder.train_mode?).to eq(true)
+      3.times do
+        states = recorder.record { [MXNet::Autograd.recording?, MXNet::Autograd.training?] }
+        expect(states).to eq([true, true])
+        expect(MXNet::Autograd.recording?).to eq(false)
+      end
+    end
+
+    specify do
+      recorder = MXNet::Autograd::Recorder.new(train_mode: false)
+      expect(recorder.record { MXNet::Autograd.training? }).to eq(false)
+    end
+
+    specify do
+      x = MXNet::NDArray.array([1, 2])
+      x.attach_grad
+      recorder = MXNet::Autograd::Recorder.new
+      recorder.record { x * x }.backward
+      expect(x.grad.to_a).to eq([2.0, 4.0])
+    end
   end
 
   describe '.backward' do
@@ -39,4 +119,104 @@ RSpec.describe MXNet::Autograd do
       expect((b.grad - MXNet::NDArray.zeros_like(b)).abs.max.as_scalar).not_to eq(0.0)
     end
   end
+
+  describe '.grad' do
+    let(:x) { MXNet::NDArray.array([1, 2, 3]) }
+    let(:w) { MXNet::NDArray.array([2, 2, 2]) }
+
+    before do
+      x.attach_grad
+      w.attach_grad
+    end
+
+    specify do
+      y = MXNet::Autograd.record { x * x * w }
+      dx = MXNet::Autograd.grad(y, x)
+      expect(dx).to be_a(MXNet::NDArray)
+      expect(dx.to_a).to eq([4.0, 8.0, 12.0])
+      # the attached gradient buffers are untouched
+      expect(x.grad.to_a).to eq([0.0, 0.0, 0.0])
+    end
+
+    specify do
+      y = MXNet::Autograd.record { x * x * w }
+      grads = MXNet::Autograd.grad([y], [x, w], head_grads: [MXNet::NDArray.array([1, 0, 1])])
+      expect(grads.map(&:to_a)).to eq([[4.0, 0.0, 12.0], [1.0, 0.0, 9.0]])
+    end
+
+    specify 'create_graph: true' do
+      MXNet::Autograd.record do
+        y = x * x * x
+        dx = MXNet::Autograd.grad(y, x, create_graph: true)
+        expect(dx.to_a).to eq([3.0, 12.0, 27.0])
+        dx
+      end.backward
+      expect(x.grad.to_a).to eq([6.0, 12.0, 18.0])
+    end
+  end
+
+  describe '.mark_variables' do
+    let(:w) { MXNet::NDArray.array([[1, 2], [3, 4]]) }
+    let(:b) { MXNet::NDArray.array([5, 6]) }
+    let(:x) { MXNet::NDArray.array([1, 1]) }
+
+    def compute_loss
+      MXNet::Autograd.record { MXNet::NDArray.dot(w, x) + b }
+    end
+
+    specify do
+      grads = MXNet::Autograd.mark_variables([w, b])
+      expect(grads.map(&:shape)).to eq([[2, 2], [2]])
+      compute_loss.backward
+      expect(w.grad.reshape([4]).to_a).to eq([1.0, 1.0, 1.0, 1.0])
+      expect(b.grad.to_a).to eq([1.0, 1.0])
+      expect(grads[1].to_a).to eq([1.0, 1.0])
+    end
+
+    specify 'flat: true' do
+      grads = MXNet::Autograd.mark_variables([w, b], flat: true)
+      expect(grads.map(&:shape)).to eq([[2, 2], [2]])
+      compute_loss.backward
+      expect(w.grad.reshape([4]).to_a).to eq([1.0, 1.0, 1.0, 1.0])
+      expect(b.grad.to_a).to eq([1.0, 1.0])
+    end
+
+    specify 'grad_reqs' do
+      grads = MXNet::Autograd.mark_variables([w, b], grad_reqs: [:write, :add])
+      compute_loss.backward
+      compute_loss.backward
+      expect(w.grad.reshape([4]).to_a).to eq([1.0, 1.0, 1.0, 1.0])
+      expect(grads[1].to_a).to eq([2.0, 2.0])
+    end
+
+    specify 'with the given grads' do
+      g = [MXNet::NDArray.zeros([2, 2]), MXNet::NDArray.zeros([2])]
+      expect(MXNet::Autograd.mark_variables([w, b], grads: g)).to equal(g)
+      compute_loss.backward
+      expect(g[1].to_a).to eq([1.0, 1.0])
+    end
+
+    specify do
+      expect {
+        MXNet::Autograd.mark_variables([w, b], grad_reqs: [:write, :unknown])
+      }.to raise_error(ArgumentError)
+    end
+  end
+
+  describe '.zero_grad' do
+    let(:w) { MXNet::NDArray.array([1, 2]) }
+    let(:b) { MXNet::NDArray.array([3]) }
+    let(:c) { MXNet::NDArray.array([4]) }
+
+    specify do
+      MXNet::Autograd.mark_variables([w, b], grad_reqs: :add)
+      MXNet::Autograd.record { w * b }.backward
+      expect(w.grad.to_a).to eq([3.0, 3.0])
+
+      expect(MXNet::Autograd.zero_grad([w, b, c])).to eq(nil)
+      expect(w.grad.to_a).to eq([0.0, 0.0])
+      expect(b.grad.to_a).to eq([0.0])
+      expect(c.grad).to eq(nil)
+    end
+  end
 end
@@ -0,0 +1,66 @@
+require 'spec_helper'
+require 'json'
+require 'mxnet/benchmark/op_perf'
+
+RSpec.describe MXNet::Benchmark::OpPerf do
+  let(:perf) do
+    MXNet::Benchmark::OpPerf.new(ops: [:relu, :add_n, :argmax, :Reshape, :tile],
+                                 shapes: [[4, 4]], warmup: 1, runs: 2,
+                                 params: { Reshape: { shape: [16] } })
+  end
+
+  describe '#run' do
+    it 'measures the operators with the generated inputs' do
+      results = perf.run.group_by(&:op)
+      relu = results[:relu][0]
+      expect(relu).to be_ok
+      expect(relu.shape).to eq([4, 4])
+      expect(relu.dtype).to eq(:float32)
+      expect(relu.forward).to be > 0
+      expect(relu.dispatch).to be > 0
+      expect(relu.raw_dispatch).to be > 0
+      expect(relu.backward).to be > 0
+    end
+
+    it 'gives the variable number of inputs' do
+      expect(perf.run.find {|r| r.op == :add_n }).to be_ok
+    end
+
+    it 'uses the given parameters' do
+      expect(perf.run.find {|r| r.op == :Reshape }).to be_ok
+    end
+
+    it 'reports the operators without the required parameters as skipped' do
+      result = perf.run.find {|r| r.op == :tile }
+      expect(result).not_to be_ok
+      expect(result.error).to match(/skipped.*reps/)
+    end
+
+    it 'yields each result' do
+      expect {|b| perf.run(&b) }.to yield_control.exactly(5).times
+    end
+  end
+
+  describe '#to_json' do
+    specify do
+      perf.run
+      json = JSON.parse(perf.to_json)
+      expect(json['metadata']['runs']).to eq(2)
+      relu = json['results'].find {|r| r['op'] == 'relu' }
+      expect(relu).to include('shape' => [4, 4], 'dtype' => 'float32', 'error' => nil)
+      expect(relu['forward_us']).to be > 0
+      expect(relu).to have_key('binding_overhead_us')
+      expect(relu).to have_key('kernel_us')
+    end
+  end
+
+  describe '#to_markdown' do
+    specify do
+      perf.run
+      lines = perf.to_markdown.lines
+      expect(lines[0]).to start_with('| op | shape | dtype |')
+      expect(lines.length).to eq(2 + 5)
+      expect(lines.grep(/\A\| relu \|/).length).to eq(1)
+    end
+  end
+end
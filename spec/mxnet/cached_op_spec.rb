@@ -0,0 +1,50 @@
+require 'spec_helper'
+
+module MXNet
+  ::RSpec.describe CachedOp do
+    let(:data) { MXNet::Symbol.var(:data) }
+    let(:net) { MXNet::Symbol.FullyConnected(data: data, num_hidden: 2, name: :fc) }
+    let(:x) { NDArray.array([[1, 2, 3]]) }
+    let(:weight) { NDArray.array([[1, 0, 0], [1, 1, 1]]) }
+    let(:bias) { NDArray.array([0, 1]) }
+
+    specify do
+      op = CachedOp.new(net)
+      expect(op.(x, weight, bias).to_a).to eq([[1.0, 7.0]])
+    end
+
+    specify 'with flags' do
+      op = CachedOp.new(net, static_alloc: true, static_shape: true)
+      2.times do
+        expect(op.(x, weight, bias).to_a).to eq([[1.0, 7.0]])
+      end
+    end
+
+    specify 'out:' do
+      op = CachedOp.new(net)
+      out = NDArray.zeros([1, 2])
+      expect(op.(x, weight, bias, out: out)).to equal(out)
+      expect(out.to_a).to eq([[1.0, 7.0]])
+    end
+
+    specify 'multiple outputs' do
+      op = CachedOp.new(MXNet::Symbol.split(data: data, num_outputs: 3, axis: 1))
+      outputs = op.(x)
+      expect(outputs).to be_an(Array)
+      expect(outputs.map(&:to_a)).to eq([[[1.0]], [[2.0]], [[3.0]]])
+    end
+
+    specify 'autograd' do
+      op = CachedOp.new(net)
+      weight.attach_grad
+      y = Autograd.record { op.(x, weight, bias) }
+      y.backward
+      expect(weight.grad.to_a).to eq([[1.0, 2.0, 3.0], [1.0, 2.0, 3.0]])
+    end
+
+    specify 'wrong number of inputs' do
+      op = CachedOp.new(net)
+      expect { op.(x) }.to raise_error(MXNet::Error)
+    end
+  end
+end
@@ -20,5 +20,41 @@ RSpec.describe MXNet::Context do
         expect(MXNet::Context.default).to eq(MXNet.gpu(0))
       end
     end
+
+    specify 'the default context is restored' do
+      initial_context = MXNet::Context.default
+      MXNet::Context.with(MXNet.cpu(1)) do
+        MXNet::Context.with(MXNet.cpu(2)) do
+          expect(MXNet::Context.default).to eq(MXNet.cpu(2))
+        end
+        expect(MXNet::Context.default).to eq(MXNet.cpu(1))
+      end
+      expect(MXNet::Context.default).to eq(initial_context)
+    end
+
+    specify 'the default context is thread-local' do
+      queue = Queue.new
+      MXNet::Context.with(MXNet.cpu(1)) do
+        Thread.new { queue << MXNet::Context.default }.join
+      end
+      expect(queue.pop).to eq(MXNet::Context.new(:cpu, 0))
+    end
+
+    specify 'parallel threads on different contexts' do
+      threads = Array.new(4) do |i|
+        Thread.new do
+          ctx = MXNet.cpu(i)
+          Array.new(50) do |j|
+            MXNet::Context.with(ctx) do
+              x = MXNet::NDArray.ones([2, 2]) * j
+              Thread.pass
+              [MXNet::Context.default == ctx, x.context == ctx, x.reshape([4]).to_a == [j.to_f] * 4]
+            end
+          end
+        end
+      end
+      expect(threads.flat_map(&:value).flatten).to all(eq(true))
+      expect(MXNet::Context.default).to eq(MXNet::Context.new(:cpu, 0))
+    end
   end
 end
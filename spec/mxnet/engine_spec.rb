@@ -0,0 +1,143 @@
+require 'spec_helper'
+require 'rbconfig'
+
+module MXNet
+  module EngineSpec
+    class Double < Operator::CustomOp
+      def forward(is_train, req, in_data, out_data, aux)
+        assign(out_data[0], req[0], in_data[0] * 2.0)
+      end
+    end
+
+    class DoubleProp < Operator::CustomOpProp
+      def create_operator(ctx, in_shapes, in_dtypes)
+        Double.new
+      end
+    end
+
+    Operator.register(:spec_engine_double, DoubleProp)
+  end
+
+  ::RSpec.describe Engine do
+    def run_in_children(num_children)
+      children = Array.new(num_children) do
+        reader, writer = IO.pipe
+        pid = Process.fork do
+          reader.close
+          status = 1
+          begin
+            Marshal.dump(yield, writer)
+            status = 0
+          ensure
+            writer.close
+            Process.exit!(status)
+          end
+        end
+        writer.close
+        [pid, reader]
+      end
+      children.map do |pid, reader|
+        result = reader.read
+        reader.close
+        _, status = Process.wait2(pid)
+        expect(status).to be_success
+        Marshal.load(result)
+      end
+    end
+
+    describe 'fork' do
+      let!(:weight) { NDArray::Random.normal(shape: [4, 3]) }
+      let!(:data) { NDArray::Random.normal(shape: [2, 4]) }
+
+      it 'runs the inference in the children with the parameters of the parent' do
+        expected = NDArray.dot(data, weight).to_a
+        results = run_in_children(2) { NDArray.dot(data, weight).to_a }
+        expect(results).to eq([expected, expected])
+      end
+
+      it 'runs the inference with the pending computations of the parent' do
+        output = NDArray.relu(NDArray.dot(data, weight))
+        results = run_in_children(2) { output.to_a }
+        expect(results).to eq([output.to_a, output.to_a])
+      end
+
+      it 'runs the custom operators in the children' do
+        data.wait_to_read
+        results = run_in_children(2) { NDArray.Custom(data, op_type: :spec_engine_double).to_a }
+        expected = (data * 2.0).to_a
+        expect(results).to eq([expected, expected])
+      end
+
+      it 'keeps the engine working in the parent' do
+        run_in_children(1) { nil }
+        expect((data * 2.0).to_a).to eq(NDArray.Custom(data, op_type: :spec_engine_double).to_a)
+      end
+    end
+
+    describe 'exit' do
+      it 'shuts down libmxnet with the live arrays and the pending computations' do
+        lib = File.expand_path('../../lib', __dir__)
+        code = <<~RUBY
+          class Double < MXNet::Operator::CustomOp
+            def forward(is_train, req, in_data, out_data, aux)
+              assign(out_data[0], req[0], in_data[0] * 2.0)
+            end
+          end
+
+          class DoubleProp < MXNet::Operator::CustomOpProp
+            def create_operator(ctx, in_shapes, in_dtypes)
+              Double.new
+            end
+          end
+
+          MXNet::Operator.register(:double, DoubleProp)
+          arrays = Array.new(1000) { MXNet::NDArray.ones([16]) }
+          pending = MXNet::NDArray.Custom(arrays[0], op_type: :double)
+          at_exit { print 'done' }
+        RUBY
+        output = IO.popen([RbConfig.ruby, '-I', lib, '-r', 'mxnet', '-e', code], &:read)
+        expect($?).to be_success
+        expect(output).to eq('done')
+      end
+
+      it 'keeps libmxnet running for the at_exit registered before requiring mxnet' do
+        lib = File.expand_path('../../lib', __dir__)
+        code = <<~RUBY
+          at_exit do
+            x = MXNet::NDArray.ones([2]) * 2
+            print x.to_a.inspect
+          end
+          require 'mxnet'
+          MXNet::NDArray.ones([2]).wait_to_read
+        RUBY
+        output = IO.popen([RbConfig.ruby, '-I', lib, '-e', code], &:read)
+        expect($?).to be_success
+        expect(output).to eq('[2.0, 2.0]')
+      end
+    end
+
+    describe '.at_fork' do
+      before do
+        skip 'Process._fork is not available' unless Process.respond_to?(:_fork)
+      end
+
+      it 'calls the blocks around fork' do
+        events = []
+        hooks = [
+          Engine.at_fork(:prepare) { events << :prepare },
+          Engine.at_fork(:parent) { events << :parent }
+        ]
+        child_events = run_in_children(1) { events }
+        expect(events).to eq([:prepare, :parent])
+        expect(child_events).to eq([[:prepare]])
+      ensure
+        hook_lists = Engine.instance_variable_get(:@fork_hooks)
+        hook_lists.each_value {|list| list.reject! {|hook| hooks&.include?(hook) } }
+      end
+
+      it 'raises ArgumentError for an unknown event' do
+        expect { Engine.at_fork(:unknown) {} }.to raise_error(ArgumentError)
+      end
+    end
+  end
+end
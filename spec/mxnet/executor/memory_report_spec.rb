@@ -0,0 +1,72 @@
+require 'spec_helper'
+
+module MXNet
+  ::RSpec.describe Executor::MemoryReport do
+    describe '.parse' do
+      let(:debug_str) { <<~DEBUG_STR }
+        Symbol Outputs:
+        \toutput[0]=fc2(0)
+        Variable:data
+        Variable:fc1_weight
+        Variable:fc1_bias
+        --------------------
+        Op:FullyConnected, Name=fc1
+        Inputs:
+        \targ[0]=data(0) version=0
+        \targ[1]=fc1_weight(0) version=0
+        \targ[2]=fc1_bias(0) version=0
+        Attrs:
+        \tnum_hidden=128
+        --------------------
+        Op:Activation, Name=relu1
+        Inputs:
+        \targ[0]=fc1(0)
+        Attrs:
+        \tact_type=relu
+        Total 3 MB allocated
+        Total 11 TempSpace resource requested
+      DEBUG_STR
+
+      specify do
+        nodes, allocated_bytes, unit_bytes = Executor::MemoryReport.parse(debug_str)
+        expect(allocated_bytes).to eq(3 << 20)
+        expect(unit_bytes).to eq(1 << 20)
+        expect(nodes.map(&:op)).to eq(%w[FullyConnected Activation])
+        expect(nodes.map(&:name)).to eq(%w[fc1 relu1])
+        expect(nodes[0].inputs).to eq(%w[data(0) fc1_weight(0) fc1_bias(0)])
+        expect(nodes[0].attrs).to eq('num_hidden' => '128')
+        expect(nodes[1].inputs).to eq(%w[fc1(0)])
+        expect(nodes[1].attrs).to eq('act_type' => 'relu')
+      end
+
+      specify 'without the memory plan' do
+        _, allocated_bytes, unit_bytes = Executor::MemoryReport.parse("Symbol Outputs:\n\toutput[0]=x(0)\nVariable:x\n")
+        expect(allocated_bytes).to be_nil
+        expect(unit_bytes).to be_nil
+      end
+    end
+
+    specify do
+      data = MXNet::Symbol.var(:data)
+      fc = MXNet::Symbol.FullyConnected(data: data, num_hidden: 256, name: :fc1)
+      net = MXNet::Symbol.relu(data: fc, name: :relu1)
+      args = {
+        data: NDArray.zeros([64, 128]),
+        fc1_weight: NDArray.zeros([256, 128]),
+        fc1_bias: NDArray.zeros([256])
+      }
+      exe = net.bind(MXNet.cpu, args)
+      report = exe.memory_report
+      expect(report.nodes.map(&:name)).to eq(%w[fc1 relu1])
+      expect(report.nodes.map(&:output_bytes)).to eq([64 * 256 * 4] * 2)
+      expect(report.output_bytes).to eq(2 * 64 * 256 * 4)
+      expect(report.arg_bytes).to eq((64 * 128 + 256 * 128 + 256) * 4)
+      expect(report.allocated_range).to cover(report.output_bytes)
+      # 128 KB of the outputs is below the resolution of the plan.
+      expect(report.shared_bytes).to be_nil
+      expect(report.reuse_ratio).to be_nil
+      expect(report.to_h).to include(:allocated_bytes, :allocated_range, :shared_bytes, :nodes)
+      expect(report.to_s).to include('fc1')
+    end
+  end
+end
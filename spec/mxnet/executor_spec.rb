@@ -0,0 +1,53 @@
+require 'spec_helper'
+
+module MXNet
+  ::RSpec.describe Executor do
+    let(:x) { MXNet::Symbol.var(:x) }
+    let(:y) { MXNet::Symbol.var(:y) }
+    let(:net) { MXNet::Symbol.relu(data: x + y, name: :relu) }
+    let(:exe) do
+      net.bind(MXNet.cpu, { x: NDArray.array([[1, -2]]), y: NDArray.array([[1, 1]]) })
+    end
+
+    describe '#set_monitor_callback' do
+      specify do
+        outputs = {}
+        exe.set_monitor_callback {|name, array| outputs[name] = array }
+        expect(exe).to be_monitor_enabled
+        exe.forward
+        expect(outputs.keys).to include('relu_output')
+        expect(outputs['relu_output'].to_a).to eq([[2.0, 0.0]])
+      end
+
+      specify 'monitor_enabled = false' do
+        names = []
+        exe.set_monitor_callback {|name, _| names << name }
+        exe.monitor_enabled = false
+        exe.forward
+        expect(names).to be_empty
+        exe.monitor_enabled = true
+        exe.forward
+        expect(names).not_to be_empty
+      end
+
+      specify 'without callback' do
+        expect { exe.set_monitor_callback }.to raise_error(ArgumentError)
+        expect(exe).not_to be_monitor_enabled
+        expect { exe.monitor_enabled = true }.to raise_error(MXNet::Error)
+      end
+    end
+
+    describe '#debug_str' do
+      specify do
+        expect(exe.debug_str).to include('Name=relu')
+      end
+    end
+
+    describe '#arg_names' do
+      specify do
+        expect(exe.arg_names).to eq([:x, :y])
+        expect(exe.arg_arrays.map(&:to_a)).to eq([[[1.0, -2.0]], [[1.0, 1.0]]])
+      end
+    end
+  end
+end
@@ -0,0 +1,50 @@
+require 'spec_helper'
+
+module MXNet
+  ::RSpec.describe Future do
+    let(:pipe) { IO.pipe }
+    let(:future) { Future.new(pipe[0]) { 42 } }
+
+    after do
+      pipe[1].close unless pipe[1].closed?
+    end
+
+    specify do
+      expect(future.ready?).to eq(false)
+      expect(future.wait(0.01)).to eq(nil)
+      pipe[1].write("\x01")
+      expect(future.value).to eq(42)
+      expect(future.ready?).to eq(true)
+    end
+
+    specify '#then' do
+      chained = future.then {|v| v + 1 }
+      Thread.new { sleep 0.01; pipe[1].write("\x01") }
+      expect(chained.value).to eq(43)
+    end
+
+    specify 'the error of the value is raised again' do
+      failed = Future.new(pipe[0]) { raise ArgumentError, 'failed' }
+      pipe[1].write("\x01")
+      expect { failed.value }.to raise_error(ArgumentError, 'failed')
+      expect { failed.value }.to raise_error(ArgumentError, 'failed')
+    end
+  end
+
+  ::RSpec.describe NDArray do
+    describe '#wait_async' do
+      specify do
+        x = NDArray.ones([2, 2]) * 2
+        future = x.wait_async
+        expect(future).to be_a(Future)
+        expect(future.value).to equal(x)
+        expect(future.ready?).to eq(true)
+      end
+
+      specify 'with a block' do
+        x = NDArray.ones([2]) * 2
+        expect(x.wait_async { x.to_a }.value).to eq([2.0, 2.0])
+      end
+    end
+  end
+end
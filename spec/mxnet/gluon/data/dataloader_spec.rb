@@ -0,0 +1,62 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+
+RSpec.describe MXNet::Gluon::Data::DataLoader do
+  let(:dataset) do
+    MXNet::Gluon::Data::SimpleDataset.new(
+      Array.new(10) {|i| [MXNet::NDArray.full([2, 3], i), MXNet::NDArray.full([1], i * 10)] }
+    )
+  end
+
+  def to_arrays(loader)
+    loader.map {|data, label| [data.to_a, label.to_a] }
+  end
+
+  describe '#each' do
+    it 'yields the stacked batches' do
+      loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 4)
+      expect(loader.length).to eq(3)
+      batches = loader.to_a
+      expect(batches.map {|data, _| data.shape }).to eq([[4, 2, 3], [4, 2, 3], [2, 2, 3]])
+      expect(batches[0][1].to_a).to eq([[0], [10], [20], [30]])
+    end
+
+    it 'raises ArgumentError for shuffle with sampler' do
+      sampler = MXNet::Gluon::Data::SequentialSampler.new(10)
+      expect {
+        MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 4, shuffle: true, sampler: sampler)
+      }.to raise_error(ArgumentError)
+    end
+
+    context 'with workers' do
+      it 'yields the same batches as without workers' do
+        loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 3, num_workers: 2)
+        expected = to_arrays(MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 3))
+        expect(to_arrays(loader)).to eq(expected)
+      end
+
+      it 'yields the batches on cpu_shared' do
+        loader = MXNet::Gluon::Data::DataLoader.new(dataset, batch_size: 5, num_workers: 2)
+        loader.each do |data, label|
+          expect(data.context).to eq(MXNet.cpu_shared)
+          expect(label.context).to eq(MXNet.cpu_shared)
+        end
+      end
+
+      it 'gives the same random seeds to the workers with the same seed' do
+        random_dataset = MXNet::Gluon::Data::SimpleDataset.new(Array.new(8) { 0 }).transform do |_|
+          MXNet::NDArray::Random.uniform(0, 1, shape: [2])
+        end
+        loader = MXNet::Gluon::Data::DataLoader.new(random_dataset, batch_size: 2, num_workers: 2, seed: 42)
+        other = MXNet::Gluon::Data::DataLoader.new(random_dataset, batch_size: 2, num_workers: 2, seed: 42)
+        expect(loader.map(&:to_a)).to eq(other.map(&:to_a))
+      end
+
+      it 'raises the error in the workers' do
+        failing = MXNet::Gluon::Data::SimpleDataset.new([1, 2, 3, 4]).transform {|_| raise 'broken sample' }
+        loader = MXNet::Gluon::Data::DataLoader.new(failing, batch_size: 2, num_workers: 2)
+        expect { loader.to_a }.to raise_error(RuntimeError, /broken sample/)
+      end
+    end
+  end
+end
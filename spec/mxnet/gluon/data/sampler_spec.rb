@@ -0,0 +1,53 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+
+RSpec.describe MXNet::Gluon::Data::SequentialSampler do
+  specify do
+    sampler = MXNet::Gluon::Data::SequentialSampler.new(4)
+    expect(sampler.length).to eq(4)
+    expect(sampler.to_a).to eq([0, 1, 2, 3])
+  end
+end
+
+RSpec.describe MXNet::Gluon::Data::RandomSampler do
+  specify do
+    sampler = MXNet::Gluon::Data::RandomSampler.new(10)
+    expect(sampler.length).to eq(10)
+    expect(sampler.to_a.sort).to eq((0...10).to_a)
+  end
+end
+
+RSpec.describe MXNet::Gluon::Data::BatchSampler do
+  let(:sampler) { MXNet::Gluon::Data::SequentialSampler.new(5) }
+
+  context 'with :keep' do
+    specify do
+      batch_sampler = MXNet::Gluon::Data::BatchSampler.new(sampler, 2, :keep)
+      expect(batch_sampler.length).to eq(3)
+      expect(batch_sampler.to_a).to eq([[0, 1], [2, 3], [4]])
+    end
+  end
+
+  context 'with :discard' do
+    specify do
+      batch_sampler = MXNet::Gluon::Data::BatchSampler.new(sampler, 2, :discard)
+      expect(batch_sampler.length).to eq(2)
+      expect(batch_sampler.to_a).to eq([[0, 1], [2, 3]])
+    end
+  end
+
+  context 'with :rollover' do
+    specify do
+      batch_sampler = MXNet::Gluon::Data::BatchSampler.new(sampler, 2, :rollover)
+      expect(batch_sampler.to_a).to eq([[0, 1], [2, 3]])
+      expect(batch_sampler.length).to eq(3)
+      expect(batch_sampler.to_a).to eq([[4, 0], [1, 2], [3, 4]])
+    end
+  end
+
+  it 'raises ArgumentError for an unknown last_batch' do
+    expect {
+      MXNet::Gluon::Data::BatchSampler.new(sampler, 2, :unknown)
+    }.to raise_error(ArgumentError)
+  end
+end
@@ -0,0 +1,46 @@
+require 'spec_helper'
+require 'mxnet/gluon'
+
+RSpec.describe MXNet::Gluon::Utils do
+  describe '.clip_global_norm' do
+    let(:arrays) do
+      [
+        MXNet::NDArray.array([3, 0, 0]),
+        MXNet::NDArray.array([[0, 4], [0, 0]])
+      ]
+    end
+
+    it 'rescales the arrays to the max norm and returns the total norm' do
+      norm = MXNet::Gluon::Utils.clip_global_norm(arrays, 1.0)
+      expect(norm).to be_a(Float)
+      expect(norm).to be_within(1e-5).of(5.0)
+      expect(arrays[0].to_a).to match([be_within(1e-5).of(0.6), 0, 0])
+      expect(arrays[1].to_a).to match([[0, be_within(1e-5).of(0.8)], [0, 0]])
+    end
+
+    it 'does not change the arrays whose norm is smaller than the max norm' do
+      MXNet::Gluon::Utils.clip_global_norm(arrays, 10.0)
+      expect(arrays[0].to_a).to eq([3, 0, 0])
+      expect(arrays[1].to_a).to eq([[0, 4], [0, 0]])
+    end
+
+    it 'returns the total norm as an NDArray without checking it' do
+      norm = MXNet::Gluon::Utils.clip_global_norm(arrays, 1.0, check_isfinite: false)
+      expect(norm).to be_a(MXNet::NDArray)
+      expect(norm.as_scalar).to be_within(1e-5).of(5.0)
+    end
+
+    it 'warns if the total norm is not finite' do
+      arrays[0][0] = Float::INFINITY
+      expect {
+        MXNet::Gluon::Utils.clip_global_norm(arrays, 1.0)
+      }.to output(/nan or inf/).to_stderr
+    end
+
+    it 'raises ArgumentError for no arrays' do
+      expect {
+        MXNet::Gluon::Utils.clip_global_norm([], 1.0)
+      }.to raise_error(ArgumentError)
+    end
+  end
+end
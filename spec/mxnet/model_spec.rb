@@ -0,0 +1,53 @@
+require 'spec_helper'
+
+module MXNet
+  ::RSpec.describe Model, :within_tmpdir do
+    let(:data) { MXNet::Symbol.var(:data) }
+    let(:net) { MXNet::Symbol.FullyConnected(data: data, num_hidden: 3, name: :fc1) }
+    let(:arg_params) do
+      {
+        'fc1_weight' => NDArray.ones([3, 4]),
+        'fc1_bias' => NDArray.zeros([3])
+      }
+    end
+    let(:aux_params) { {} }
+
+    describe '.save_checkpoint' do
+      specify do
+        fname = Model.save_checkpoint('model', 1, net, arg_params, aux_params, async: false)
+        expect(fname).to eq('model-0001.params')
+        expect(File.file?('model-symbol.json')).to eq(true)
+        expect(NDArray.load(fname).keys).to contain_exactly('arg:fc1_weight', 'arg:fc1_bias')
+      end
+
+      specify 'asynchronous save snapshots the arrays' do
+        Model.save_checkpoint('model', 2, net, arg_params, aux_params, async: true)
+        arg_params['fc1_weight'][0..-1] = 42
+        Model.wait_checkpoints
+        saved = NDArray.load('model-0002.params')
+        expect(saved['arg:fc1_weight'].reshape([12]).to_a).to eq([1.0] * 12)
+        expect(Dir.glob('model-0002.params.tmp*')).to be_empty
+      end
+    end
+
+    describe Model::CheckpointWriter do
+      specify 'a failed snapshot is not left pending' do
+        writer = Model::CheckpointWriter.new
+        expect { writer.push('model-0004.params', 'arg:fc1_weight' => 42) }.to raise_error(NoMethodError)
+        expect(writer.pending).to eq(0)
+        expect(writer.wait).to equal(writer)
+      end
+    end
+
+    describe '.load_checkpoint' do
+      specify do
+        Model.save_checkpoint('model', 3, net, arg_params, aux_params)
+        symbol, args, auxs = Model.load_checkpoint('model', 3)
+        expect(symbol.list_arguments).to eq(net.list_arguments)
+        expect(args.keys).to contain_exactly('fc1_weight', 'fc1_bias')
+        expect(args['fc1_weight'].reshape([12]).to_a).to eq([1.0] * 12)
+        expect(auxs).to eq({})
+      end
+    end
+  end
+end
@@ -0,0 +1,56 @@
+require 'spec_helper'
+
+module MXNet
+  ::RSpec.describe Monitor do
+    let(:x) { MXNet::Symbol.var(:x) }
+    let(:net) { MXNet::Symbol.relu(data: x * 2, name: :relu) }
+    let(:exe) { net.bind(MXNet.cpu, { x: NDArray.array([3, -4]) }) }
+
+    describe '.default_stat' do
+      specify do
+        nan = Float::NAN
+        stats = Monitor.default_stat(NDArray.array([[3, -4], [nan, 0]])).to_a
+        expect(stats[0]).to be_nan
+        expect(stats[3]).to eq(1.0)
+        stats = Monitor.default_stat(NDArray.array([[3, -4], [0, 0]])).to_a
+        expect(stats).to eq([5.0, -4.0, 3.0, 0.0])
+      end
+    end
+
+    specify 'every interval batches' do
+      mon = Monitor.new(2, pattern: /relu|x/)
+      mon.install(exe)
+      results = 3.times.map do
+        mon.tic
+        exe.forward
+        mon.toc
+      end
+      expect(results[1]).to eq([])
+      expect(results[0].map {|step, _, _| step }.uniq).to eq([0])
+      expect(results[2].map {|step, _, _| step }.uniq).to eq([2])
+      stats = results[0].map {|_, name, values| [name, values] }.to_h
+      expect(stats['relu_output']).to eq([6.0, 0.0, 6.0, 0.0])
+      expect(stats['x']).to eq([5.0, -4.0, 3.0, 0.0])
+      expect(exe).not_to be_monitor_enabled
+    end
+
+    specify 'stat_func and sort' do
+      mon = Monitor.new(1, stat_func: ->(a) { a.abs.max }, sort: true)
+      mon.install(exe)
+      mon.tic
+      exe.forward
+      results = mon.toc
+      expect(mon.stat_names).to be_nil
+      expect(results.map {|_, name, _| name }).to eq(results.map {|_, name, _| name }.sort)
+      expect(results.find {|_, name, _| name == 'x' }[2]).to eq([4.0])
+    end
+
+    specify '#toc_print' do
+      mon = Monitor.new(1, pattern: 'relu_output')
+      mon.install(exe)
+      mon.tic
+      exe.forward
+      expect { mon.toc_print }.to output(/Batch:\s+0 relu_output\s+norm=6.0\tmin=0.0\tmax=6.0\tnan_count=0.0/).to_stdout
+    end
+  end
+end
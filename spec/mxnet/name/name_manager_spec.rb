@@ -36,6 +36,25 @@ RSpec.describe MXNet::Name::NameManager do
       expect(MXNet::Name::NameManager.current).to equal(old_name_manager)
     end
   end
+
+  describe '.current' do
+    specify 'entered managers are thread-local' do
+      subject.enter do
+        other = Thread.new { MXNet::Name::NameManager.current }.value
+        expect(other).not_to equal(subject)
+      end
+    end
+
+    specify 'the default manager generates unique names across threads' do
+      threads = Array.new(4) do
+        Thread.new do
+          Array.new(200) { MXNet::Name::NameManager.current.get(nil, 'stress') }
+        end
+      end
+      names = threads.flat_map(&:value)
+      expect(names.uniq.length).to eq(names.length)
+    end
+  end
 end
 
 RSpec.describe MXNet::Name::Prefix do
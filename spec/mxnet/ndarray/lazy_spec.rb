@@ -0,0 +1,162 @@
+require 'spec_helper'
+
+module MXNet
+  ::RSpec.describe NDArray, '.lazy' do
+    let(:x) { NDArray.array([[-1, 2], [3, -4]]) }
+    let(:a) { NDArray.array([2, 3]) }
+    let(:b) { NDArray.array([1, 1]) }
+
+    def expression(x, a, b)
+      (x * a + b).relu.clip(0, 6)
+    end
+
+    before do
+      NDArray::Lazy.clear_cache
+    end
+
+    specify do
+      y = NDArray.lazy do
+        expression(x, a, b).tap do |z|
+          expect(z.__expression__).not_to be_nil
+        end
+      end
+      expect(y).to be_a(NDArray::LazyArray)
+      expect(y.__expression__).to be_nil
+      expect(y.to_a).to eq(expression(x, a, b).to_a)
+    end
+
+    specify 'a cached op with an output for a chain' do
+      allow(NDArray::Lazy).to receive(:compile).and_call_original
+      y = NDArray.lazy { expression(x, a, b) }
+      expect(y.to_a).to eq([[0.0, 6.0], [6.0, 0.0]])
+      expect(NDArray::Lazy).to have_received(:compile).once do |nodes, _, outputs|
+        expect(nodes.length).to eq(4)
+        expect(outputs).to eq([3])
+      end
+    end
+
+    specify 'reading a lazy array in the block' do
+      allow(NDArray::Lazy).to receive(:evaluate_all).and_call_original
+      y = NDArray.lazy do
+        z = expression(x, a, b)
+        expect(z.to_a).to eq([[0.0, 6.0], [6.0, 0.0]])
+        expect(z.__expression__).to be_nil
+        z
+      end
+      expect(y.to_a).to eq([[0.0, 6.0], [6.0, 0.0]])
+      expect(NDArray::Lazy).to have_received(:evaluate_all).once
+    end
+
+    specify 'lazy arrays in the value of the block' do
+      y, z = NDArray.lazy do
+        t = x * 2
+        [t, t + 1]
+      end
+      expect(y.__expression__).to be_nil
+      expect(z.__expression__).to be_nil
+      expect(y.to_a).to eq([[-2.0, 4.0], [6.0, -8.0]])
+      expect(z.to_a).to eq([[-1.0, 5.0], [7.0, -7.0]])
+    end
+
+    specify 'keeping intermediate arrays' do
+      t = nil
+      y = NDArray.lazy do
+        t = x * 2
+        t + 1
+      end
+      expect(y.__expression__).to be_nil
+      expect(t.to_a).to eq([[-2.0, 4.0], [6.0, -8.0]])
+      expect(y.to_a).to eq([[-1.0, 5.0], [7.0, -7.0]])
+    end
+
+    specify 'writing into an input after the block' do
+      y = NDArray.lazy { x * 2 }
+      NDArray.square(x, out: x)
+      expect(y.to_a).to eq([[-2.0, 4.0], [6.0, -8.0]])
+    end
+
+    specify 'writing into an input in the block' do
+      t = nil
+      z = nil
+      y = NDArray.lazy do
+        t = x * 2
+        z = t + 1
+        w = a * 2
+        x[0..-1] = 0
+        expect(t.__expression__).to be_nil
+        expect(z.__expression__).to be_nil
+        expect(w.__expression__).not_to be_nil
+        w
+      end
+      expect(t.to_a).to eq([[-2.0, 4.0], [6.0, -8.0]])
+      expect(z.to_a).to eq([[-1.0, 5.0], [7.0, -7.0]])
+      expect(y.to_a).to eq([4.0, 6.0])
+      expect(x.to_a).to eq([[0.0, 0.0], [0.0, 0.0]])
+    end
+
+    specify 'an error in the block' do
+      y = nil
+      expect {
+        NDArray.lazy do
+          y = x * 2
+          raise 'error'
+        end
+      }.to raise_error('error')
+      expect(y.to_a).to eq([[-2.0, 4.0], [6.0, -8.0]])
+      expect(NDArray.lazy { x + 1 }.to_a).to eq([[0.0, 3.0], [4.0, -3.0]])
+    end
+
+    specify 'reusing the cached op' do
+      2.times do
+        expect(NDArray.lazy { expression(x, a, b) }.to_a).to eq([[0.0, 6.0], [6.0, 0.0]])
+      end
+      expect(NDArray::Lazy.cache_size).to eq(1)
+
+      NDArray.lazy { expression(NDArray.ones([3, 2]), a, b) }.wait_to_read
+      expect(NDArray::Lazy.cache_size).to eq(2)
+    end
+
+    specify 'the same input twice' do
+      expect(NDArray.lazy { x * x + 1 }.to_a).to eq([[2.0, 5.0], [10.0, 17.0]])
+    end
+
+    specify 'a single operation' do
+      y = NDArray.lazy { x + 1 }
+      expect(y.shape).to eq([2, 2])
+      expect(y.to_a).to eq([[0.0, 3.0], [4.0, -3.0]])
+      expect(NDArray::Lazy.cache_size).to eq(0)
+    end
+
+    specify 'an operation which is not elementwise' do
+      y = NDArray.lazy { NDArray.sum(x * 2 + 1) }
+      expect(y).not_to be_a(NDArray::LazyArray)
+      expect(y.as_scalar).to eq(4.0)
+    end
+
+    specify 'using a lazy array out of the block' do
+      y = NDArray.lazy { x * 2 }
+      expect((y + 1).to_a).to eq([[-1.0, 5.0], [7.0, -7.0]])
+    end
+
+    specify 'operations of the other threads are not hooked' do
+      allow(Tracer).to receive(:record_op).and_call_original
+      y = NDArray.lazy { Thread.new { x * 2 }.value }
+      expect(y).not_to be_a(NDArray::LazyArray)
+      expect(Tracer).not_to have_received(:record_op)
+    end
+
+    specify 'writing into a lazy array' do
+      y = NDArray.lazy { x * 2 }
+      NDArray.square(x, out: y)
+      expect(y.to_a).to eq([[1.0, 4.0], [9.0, 16.0]])
+    end
+
+    specify 'not deferred while recording' do
+      x.attach_grad
+      y = Autograd.record { NDArray.lazy { x * 2 + 1 } }
+      expect(y).not_to be_a(NDArray::LazyArray)
+      y.backward
+      expect(x.grad.to_a).to eq([[2.0, 2.0], [2.0, 2.0]])
+    end
+  end
+end
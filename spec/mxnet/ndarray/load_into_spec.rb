@@ -0,0 +1,79 @@
+require 'spec_helper'
+
+module MXNet
+  ::RSpec.describe NDArray, '.load_into', :within_tmpdir do
+    let(:saved) do
+      {
+        'w' => NDArray.arange(0, 6).reshape([2, 3]),
+        'b' => NDArray.ones([3], nil, :float64)
+      }
+    end
+
+    before do
+      NDArray.save('params', saved)
+    end
+
+    specify do
+      w = NDArray.zeros([2, 3])
+      b = NDArray.zeros([3], nil, :float64)
+      loaded = NDArray.load_into('params', {w: w, b: b})
+      expect(loaded).to contain_exactly('w', 'b')
+      expect(w.reshape([6]).to_a).to eq([0.0, 1.0, 2.0, 3.0, 4.0, 5.0])
+      expect(b.to_a).to eq([1.0, 1.0, 1.0])
+    end
+
+    specify 'loading from a buffer' do
+      w = NDArray.zeros([2, 3])
+      b = NDArray.zeros([3], nil, :float64)
+      NDArray.load_into(File.binread('params'), {'w' => w, 'b' => b})
+      expect(w.reshape([6]).to_a).to eq([0.0, 1.0, 2.0, 3.0, 4.0, 5.0])
+    end
+
+    specify 'loading from a StringIO' do
+      w = NDArray.zeros([2, 3])
+      b = NDArray.zeros([3], nil, :float64)
+      NDArray.load_into(StringIO.new(File.binread('params')), {'w' => w, 'b' => b})
+      expect(w.reshape([6]).to_a).to eq([0.0, 1.0, 2.0, 3.0, 4.0, 5.0])
+      expect(b.to_a).to eq([1.0, 1.0, 1.0])
+    end
+
+    specify 'closing a broken file' do
+      File.binwrite('broken', "\0" * 16)
+      file = File.open('broken', 'rb')
+      allow(File).to receive(:open).with('broken', 'rb').and_return(file)
+      expect {
+        NDArray.load_into('broken', {})
+      }.to raise_error(MXNet::Error, /Invalid NDArray file format/)
+      expect(file).to be_closed
+    end
+
+    specify 'shape mismatch' do
+      w = NDArray.zeros([3, 2])
+      b = NDArray.zeros([3], nil, :float64)
+      expect {
+        NDArray.load_into('params', {'w' => w, 'b' => b})
+      }.to raise_error(ArgumentError, /Shape mismatch/)
+      expect(b.to_a).to eq([0.0, 0.0, 0.0])
+    end
+
+    specify 'dtype mismatch' do
+      w = NDArray.zeros([2, 3])
+      b = NDArray.zeros([3])
+      expect {
+        NDArray.load_into('params', {'w' => w, 'b' => b})
+      }.to raise_error(ArgumentError, /DType mismatch/)
+    end
+
+    specify 'missing and extra parameters' do
+      w = NDArray.zeros([2, 3])
+      c = NDArray.zeros([1])
+      expect {
+        NDArray.load_into('params', {'w' => w})
+      }.to raise_error(ArgumentError, /not in the targets/)
+      expect {
+        NDArray.load_into('params', {'w' => w, 'c' => c}, ignore_extra: true)
+      }.to raise_error(ArgumentError, /missing/)
+      expect(NDArray.load_into('params', {'w' => w, 'c' => c}, ignore_extra: true, allow_missing: true)).to eq(['w'])
+    end
+  end
+end
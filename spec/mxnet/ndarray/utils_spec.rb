@@ -43,6 +43,31 @@ RSpec.describe MXNet::NDArray do
         expect(loaded).to eq(stringify_hash_keys(data))
       end
     end
+
+    context 'with mmap: true' do
+      specify do
+        data = {
+          x: MXNet::NDArray.array([[1, 2], [3, 4]]),
+          y: MXNet::NDArray.array([[1, 2, 3], [4, 5, 6]], dtype: :float64),
+          z: MXNet::NDArray.array([1, 2, 3], dtype: :uint8)
+        }
+        MXNet::NDArray.save('dict', data)
+        loaded = MXNet::NDArray.load('dict', mmap: true)
+        expect(loaded).to be_an(Hash)
+        expect(loaded).to eq(stringify_hash_keys(data))
+        expect(loaded['y'].dtype).to eq(:float64)
+        expect(loaded['x'].context).to eq(MXNet.cpu)
+      end
+
+      specify 'writes to the arrays are not written back to the file' do
+        data = [MXNet::NDArray.array([1, 2, 3])]
+        MXNet::NDArray.save('list', data)
+        loaded = MXNet::NDArray.load('list', mmap: true)
+        loaded[0][0] = 10
+        expect(loaded[0].to_a).to eq([10.0, 2.0, 3.0])
+        expect(MXNet::NDArray.load('list')).to eq(data)
+      end
+    end
   end
 
   if Hash.instance_methods.include? :transform_keys
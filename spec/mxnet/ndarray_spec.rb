@@ -1488,5 +1488,20 @@ module MXNet
        expect { MXNet::NDArray.concat(x,y,dim: 1) }.to raise_exception(MXNet::Error, /Incompatible input shape/)
       end
     end
+
+    describe '.from_shared_mem' do
+      it 'shares the data of an array on cpu_shared' do
+        array = MXNet::NDArray.array([1, 2, 3], ctx: MXNet.cpu_shared)
+        shared = MXNet::NDArray.from_shared_mem(*array.to_shared_mem)
+        expect(shared.to_a).to eq([1, 2, 3])
+        expect(shared.context).to eq(MXNet.cpu_shared)
+        array[0] = 10
+        expect(shared.to_a).to eq([10, 2, 3])
+      end
+
+      it 'raises ArgumentError for an array not on cpu_shared' do
+        expect { MXNet::NDArray.zeros([1]).to_shared_mem }.to raise_error(ArgumentError)
+      end
+    end
   end
 end
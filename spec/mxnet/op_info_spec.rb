@@ -22,5 +22,20 @@ module MXNet
         }.to raise_error(TypeError)
       end
     end
+
+    describe '.lookup_handle' do
+      specify do
+        handle = OpInfo.lookup_handle(MXNet::NDArray::Ops, :zeros_like)
+        expect(handle).to be_an(Integer)
+        x = MXNet::NDArray.ones([2])
+        expect(LibMXNet.imperative_invoke(handle, [x], [], [], nil).to_a).to eq([0, 0])
+      end
+
+      specify do
+        expect {
+          OpInfo.lookup_handle(MXNet::NDArray::Ops, :invalid_op_name)
+        }.to raise_error(ArgumentError)
+      end
+    end
   end
 end
@@ -0,0 +1,125 @@
+require 'spec_helper'
+
+module MXNet
+  module OperatorSpec
+    class Sqr < Operator::CustomOp
+      def forward(is_train, req, in_data, out_data, aux)
+        assign(out_data[0], req[0], in_data[0] * in_data[0])
+      end
+
+      def backward(req, out_grad, in_data, out_data, in_grad, aux)
+        assign(in_grad[0], req[0], out_grad[0] * in_data[0] * 2.0)
+      end
+    end
+
+    class SqrProp < Operator::CustomOpProp
+      def create_operator(ctx, in_shapes, in_dtypes)
+        Sqr.new
+      end
+    end
+
+    class AddScaled < Operator::CustomOp
+      def initialize(scale)
+        @scale = scale
+      end
+
+      def forward(is_train, req, in_data, out_data, aux)
+        assign(out_data[0], req[0], in_data[0] + in_data[1] * @scale)
+      end
+    end
+
+    class AddScaledProp < Operator::CustomOpProp
+      def initialize(scale: '1')
+        super(need_top_grad: true)
+        @scale = Float(scale)
+      end
+
+      def list_arguments
+        ['lhs', 'rhs']
+      end
+
+      def create_operator(ctx, in_shapes, in_dtypes)
+        AddScaled.new(@scale)
+      end
+    end
+
+    class TrainingState < Operator::CustomOp
+      class << self
+        attr_accessor :training
+      end
+
+      def forward(is_train, req, in_data, out_data, aux)
+        TrainingState.training = [is_train, Autograd.training?, Autograd.recording?]
+        assign(out_data[0], req[0], in_data[0])
+      end
+    end
+
+    class TrainingStateProp < Operator::CustomOpProp
+      def create_operator(ctx, in_shapes, in_dtypes)
+        TrainingState.new
+      end
+    end
+
+    Operator.register(:spec_sqr, SqrProp)
+    Operator.register(:spec_training_state, TrainingStateProp)
+    Operator.register(:spec_add_scaled, AddScaledProp)
+  end
+
+  ::RSpec.describe Operator do
+    describe '.register' do
+      specify do
+        expect(Operator.lookup(:spec_sqr)).to eq(OperatorSpec::SqrProp)
+      end
+
+      specify do
+        expect { Operator.register(:spec_bad, Object) }.to raise_error(TypeError)
+      end
+    end
+
+    describe 'NDArray.Custom' do
+      let(:x) { NDArray.array([1, 2, 3]) }
+
+      specify do
+        y = NDArray.Custom(x, op_type: :spec_sqr)
+        expect(y.to_a).to eq([1.0, 4.0, 9.0])
+      end
+
+      specify 'with autograd' do
+        x.attach_grad
+        y = Autograd.record { NDArray.Custom(x, op_type: :spec_sqr) }
+        y.backward
+        expect(x.grad.to_a).to eq([2.0, 4.0, 6.0])
+      end
+
+      specify 'training state in forward' do
+        Autograd.record(true) { NDArray.Custom(x, op_type: :spec_training_state) }.wait_to_read
+        expect(OperatorSpec::TrainingState.training).to eq([true, true, false])
+        NDArray.Custom(x, op_type: :spec_training_state).wait_to_read
+        expect(OperatorSpec::TrainingState.training).to eq([false, false, false])
+      end
+
+      specify 'with arguments' do
+        y = NDArray.Custom(x, NDArray.array([4, 5, 6]), op_type: :spec_add_scaled, scale: 2)
+        expect(y.to_a).to eq([9.0, 12.0, 15.0])
+      end
+    end
+
+    describe 'Symbol.Custom' do
+      let(:data) { MXNet::Symbol.var(:data) }
+      let(:sym) { MXNet::Symbol.Custom(data: data, op_type: :spec_sqr, name: :sqr) }
+
+      specify do
+        arg_shapes, out_shapes, _ = sym.infer_shape(data: [2, 3])
+        expect(arg_shapes).to eq([[2, 3]])
+        expect(out_shapes).to eq([[2, 3]])
+      end
+
+      specify do
+        x = NDArray.array([[1, 2], [3, 4]])
+        exe = sym.bind(MXNet.cpu, { data: x })
+        exe.forward
+        expect(exe.outputs[0].reshape([4]).to_a).to eq([1.0, 4.0, 9.0, 16.0])
+      end
+    end
+  end
+end
@@ -0,0 +1,48 @@
+require 'spec_helper'
+
+module MXNet
+  ::RSpec.describe Predictor, :within_tmpdir do
+    let(:data) { MXNet::Symbol.var(:data) }
+    let(:net) { MXNet::Symbol.FullyConnected(data: data, num_hidden: 3, name: :fc1) }
+    let(:params) do
+      {
+        'arg:fc1_weight' => NDArray.array([[1, 0, 0, 0], [0, 1, 0, 0], [1, 1, 1, 1]]),
+        'arg:fc1_bias' => NDArray.array([0, 0, 1])
+      }
+    end
+    let(:predictor) do
+      NDArray.save('model.params', params)
+      Predictor.new(net.to_json, File.binread('model.params'), input_shapes: {data: [1, 4]})
+    end
+
+    specify do
+      expect(predictor.output_names).to eq(['fc1_output'])
+      expect(predictor.output_shape(0)).to eq([1, 3])
+      predictor.forward(data: [1, 2, 3, 4].pack('f*'))
+      expect(predictor.output.unpack('f*')).to eq([1.0, 2.0, 11.0])
+    end
+
+    specify 'reading the output into a given buffer' do
+      out = String.new
+      predictor.forward(data: [[1, 1, 1, 1]])
+      expect(predictor.output(0, out: out)).to equal(out)
+      expect(out.unpack('f*')).to eq([1.0, 1.0, 5.0])
+    end
+
+    specify 'wrong input size' do
+      expect {
+        predictor.set_input(:data, [1, 2, 3].pack('f*'))
+      }.to raise_error(MXNet::Error)
+    end
+
+    describe '#reshape' do
+      specify do
+        other = predictor.reshape(data: [2, 4])
+        expect(other.input_shapes).to eq('data' => [2, 4])
+        expect(other.output_shape(0)).to eq([2, 3])
+        other.forward(data: [[1, 2, 3, 4], [0, 0, 0, 0]])
+        expect(other.output.unpack('f*')).to eq([1.0, 2.0, 11.0, 0.0, 0.0, 1.0])
+      end
+    end
+  end
+end
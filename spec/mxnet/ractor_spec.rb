@@ -0,0 +1,45 @@
+require 'spec_helper'
+
+RSpec.describe 'MXNet in Ractors', if: defined?(Ractor) do
+  around do |example|
+    experimental = Warning[:experimental]
+    Warning[:experimental] = false
+    example.run
+  ensure
+    Warning[:experimental] = experimental
+  end
+
+  specify 'NDArray operations' do
+    r = Ractor.new do
+      x = MXNet::NDArray.ones([2, 2]) * 3
+      [x.context.to_s, x.reshape([4]).to_a]
+    end
+    expect(r.take).to eq(['cpu(0)', [3.0, 3.0, 3.0, 3.0]])
+  end
+
+  specify 'each Ractor has its own default name manager' do
+    ractors = Array.new(2) do
+      Ractor.new do
+        data = MXNet::Symbol.var(:data)
+        MXNet::Symbol.FullyConnected(data: data, num_hidden: 2).list_arguments
+      end
+    end
+    expect(ractors.map(&:take)).to all(eq(['data', 'fullyconnected0_weight', 'fullyconnected0_bias']))
+  end
+
+  specify 'running executors' do
+    ractors = Array.new(2) do |i|
+      Ractor.new(i) do |i|
+        data = MXNet::Symbol.var(:data)
+        net = MXNet::Symbol.FullyConnected(data: data, num_hidden: 1, no_bias: true, name: :fc)
+        args = {
+          'data' => MXNet::NDArray.ones([1, 2]) * i,
+          'fc_weight' => MXNet::NDArray.ones([1, 2])
+        }
+        executor = net.bind(MXNet.cpu, args, grad_req: :null)
+        executor.forward[0].reshape([1]).to_a
+      end
+    end
+    expect(ractors.map(&:take)).to eq([[0.0], [2.0]])
+  end
+end
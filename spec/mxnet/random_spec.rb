@@ -29,6 +29,75 @@ module MXNet
         NDArray::Random.uniform(0, 1, out: ary)
         expect(ary.to_a).to be_any {|x| x != 1.0 }
       end
+
+      it 'samples into out without allocating a new array' do
+        ary = NDArray.zeros([2, 3], dtype: :float64)
+        expect(NDArray::Random.normal(0, 1, out: ary)).to equal(ary)
+        expect(ary.shape).to eq([2, 3])
+        expect(ary.dtype).to eq(:float64)
+      end
+
+      it 'samples on the given context' do
+        ary = NDArray::Random.normal(0, 1, shape: [3], ctx: MXNet.cpu(0))
+        expect(ary.context).to eq(MXNet.cpu(0))
+      end
+    end
+
+    describe 'multinomial' do
+      specify do
+        prob = NDArray.array([[0, 1, 0], [0, 0, 1]])
+        sample = NDArray::Random.multinomial(prob, shape: [2])
+        expect(sample.shape).to eq([2, 2])
+        expect(sample.to_a).to eq([[1, 1], [2, 2]])
+      end
+    end
+  end
+
+  ::RSpec.describe Random do
+    describe '.seed' do
+      def sample
+        NDArray::Random.uniform(0, 1, shape: [5]).to_a
+      end
+
+      it 'makes the samples reproducible' do
+        Random.seed(42)
+        a = sample
+        Random.seed(42)
+        expect(sample).to eq(a)
+      end
+
+      it 'seeds the generators of the given context' do
+        Random.seed(42, ctx: MXNet.cpu)
+        a = sample
+        Random.seed(42, ctx: MXNet.cpu)
+        expect(sample).to eq(a)
+      end
+
+      it 'raises TypeError for an invalid context' do
+        expect { Random.seed(42, ctx: 'cpu') }.to raise_error(TypeError)
+      end
+    end
+
+    describe '.worker_seed' do
+      it 'returns the same seed for the same arguments' do
+        expect(Random.worker_seed(42, 3)).to eq(Random.worker_seed(42, 3))
+      end
+
+      it 'returns the different seeds for the workers and the base seeds' do
+        seeds = [0, 1, 2].product([0, 1, 2]).map {|s, w| Random.worker_seed(s, w) }
+        expect(seeds.uniq.length).to eq(seeds.length)
+        expect(seeds).to all(be_between(0, 2**31 - 1))
+      end
+    end
+
+    describe '.seed_worker' do
+      it 'seeds libmxnet and Ruby with the worker seed' do
+        seed = Random.seed_worker(42, 1)
+        expect(seed).to eq(Random.worker_seed(42, 1))
+        a = [NDArray::Random.uniform(0, 1, shape: [5]).to_a, Kernel.rand]
+        Random.seed_worker(42, 1)
+        expect([NDArray::Random.uniform(0, 1, shape: [5]).to_a, Kernel.rand]).to eq(a)
+      end
     end
   end
 end
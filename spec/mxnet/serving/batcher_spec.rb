@@ -0,0 +1,74 @@
+require 'spec_helper'
+
+module MXNet
+  module Serving
+    ::RSpec.describe Batcher do
+      let(:data) { MXNet::Symbol.var(:data) }
+      let(:net) { MXNet::Symbol.FullyConnected(data: data, num_hidden: 2, name: :fc1) }
+      let(:arg_params) do
+        {
+          'fc1_weight' => NDArray.array([[1, 0, 0], [1, 1, 1]]),
+          'fc1_bias' => NDArray.array([0, 1])
+        }
+      end
+      let(:max_latency) { 0.05 }
+      let(:batcher) do
+        Batcher.new(net, arg_params, data_shape: [3], max_batch_size: 4, max_latency: max_latency)
+      end
+
+      after do
+        batcher.close unless batcher.closed?
+      end
+
+      specify do
+        output = batcher.predict([1, 2, 3])
+        expect(output.shape).to eq([2])
+        expect(output.to_a).to eq([1.0, 7.0])
+      end
+
+      specify 'requests from multiple threads are batched' do
+        threads = Array.new(8) do |i|
+          Thread.new { batcher.predict(NDArray.array([i, 0, 0])).to_a }
+        end
+        expect(threads.map(&:value)).to eq(Array.new(8) {|i| [i.to_f, i + 1.0] })
+        stats = batcher.stats
+        expect(stats[:batch_sizes].keys.max).to be > 1
+        expect(stats[:batch_sizes].sum {|size, count| size * count }).to eq(8)
+        expect(stats[:queue][:count]).to eq(8)
+        expect(stats[:compute][:p99]).to be >= stats[:compute][:p50]
+      end
+
+      specify 'wrong input shape' do
+        expect { batcher.predict([1, 2]) }.to raise_error(ArgumentError)
+      end
+
+      specify 'errors other than StandardError' do
+        executor = batcher.instance_variable_get(:@executors)[4]
+        allow_any_instance_of(executor.class).to receive(:forward).and_raise(NoMemoryError)
+        expect { batcher.predict([1, 2, 3]) }.to raise_error(NoMemoryError)
+        allow_any_instance_of(executor.class).to receive(:forward).and_call_original
+        expect(batcher.predict([1, 2, 3]).to_a).to eq([1.0, 7.0])
+      end
+
+      specify 'restarting the dead thread' do
+        batcher.instance_variable_get(:@thread).kill.join
+        expect(batcher.predict([1, 2, 3]).to_a).to eq([1.0, 7.0])
+      end
+
+      specify 'closed batcher' do
+        batcher.close
+        expect { batcher.predict([1, 2, 3]) }.to raise_error(ClosedQueueError)
+      end
+    end
+
+    ::RSpec.describe LatencyStats do
+      specify do
+        stats = LatencyStats.new(capacity: 100)
+        (1..200).each {|i| stats.record(i) }
+        expect(stats.count).to eq(200)
+        expect(stats.p50).to eq(151)
+        expect(stats.p99).to eq(199)
+      end
+    end
+  end
+end
@@ -0,0 +1,33 @@
+require 'spec_helper'
+
+module MXNet
+  ::RSpec.describe Storage do
+    describe '.stats' do
+      specify do
+        stats = Storage.stats
+        expect(stats[:ctx]).to eq('cpu(0)')
+        expect(stats).to include(:rss_bytes, :peak_rss_bytes, :settings)
+        expect(stats).not_to include(:cached_bytes)
+      end
+
+      specify 'measure_cache: true' do
+        NDArray.ones([1024, 1024]).wait_to_read
+        stats = Storage.stats(measure_cache: true)
+        expect(stats).to include(:cached_bytes)
+      end
+
+      specify 'settings' do
+        ENV['MXNET_CPU_MEM_POOL_TYPE'] = 'Round'
+        expect(Storage.stats[:settings]).to include('MXNET_CPU_MEM_POOL_TYPE' => 'Round')
+      ensure
+        ENV.delete('MXNET_CPU_MEM_POOL_TYPE')
+      end
+    end
+
+    describe '.gpu_count' do
+      specify do
+        expect(Storage.gpu_count).to be >= 0
+      end
+    end
+  end
+end
@@ -81,6 +81,36 @@ module MXNet
       pending
     end
 
+    describe '.group' do
+      specify do
+        x = MXNet::Symbol.var(:x)
+        y = MXNet::Symbol.var(:y)
+        expect(MXNet::Symbol.group([x, x + y]).list_outputs.length).to eq(2)
+      end
+    end
+
+    describe 'an operation with a variable number of inputs' do
+      specify do
+        x = MXNet::Symbol.var(:x)
+        y = MXNet::Symbol.var(:y)
+        z = MXNet::Symbol.add_n(x, y, num_args: 2)
+        expect(z.list_arguments).to eq([:x, :y])
+      end
+    end
+
+    describe '#[]' do
+      let(:data) { MXNet::Symbol.var(:data) }
+      let(:outputs) { MXNet::Symbol.split(data: data, num_outputs: 3, name: :split) }
+
+      specify do
+        expect(outputs[1].list_outputs).to eq([:split_output1])
+        expect(outputs[-1].list_outputs).to eq([:split_output2])
+        expect(outputs[:split_output0].list_outputs).to eq([:split_output0])
+        expect { outputs[3] }.to raise_error(IndexError)
+        expect { outputs[:foo] }.to raise_error(ArgumentError)
+      end
+    end
+
     describe '#attributes' do
       specify do
         data = MXNet::Symbol.var(:data, attr: { mood: 'angry' })
@@ -112,6 +142,14 @@ module MXNet
       end
     end
 
+    describe '#get_internals' do
+      specify do
+        data = MXNet::Symbol.var(:data)
+        fc = MXNet::Symbol.FullyConnected(data: data, num_hidden: 2, name: :fc)
+        expect(fc.get_internals.list_outputs).to eq([:data, :fc_weight, :fc_bias, :fc_output])
+      end
+    end
+
     describe '#simple_bind' do
       pending
     end
@@ -144,6 +182,14 @@ module MXNet
       end
     end
 
+    describe '#list_inputs' do
+      specify do
+        data = MXNet::Symbol.var(:data)
+        net = MXNet::Symbol.BatchNorm(data: data, name: :bn)
+        expect(net.list_inputs).to eq([:data, :bn_gamma, :bn_beta, :bn_moving_mean, :bn_moving_var])
+      end
+    end
+
     describe '#list_outputs' do
       specify do
         x = MXNet::Symbol.var(:x)
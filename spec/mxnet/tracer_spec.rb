@@ -0,0 +1,74 @@
+require 'spec_helper'
+
+module MXNet
+  ::RSpec.describe Tracer do
+    let(:weight) { NDArray.array([[1, 0, 0], [1, 1, 1]]) }
+    let(:bias) { NDArray.array([0, 1]) }
+    let(:x) { NDArray.array([[1, 2, 3], [-1, -2, -3]]) }
+
+    def forward(x)
+      h = NDArray.FullyConnected(x, weight, bias, num_hidden: 2)
+      NDArray.relu(h) * 2 + 1
+    end
+
+    describe 'MXNet.trace' do
+      specify do
+        params = {weight: weight}
+        sym = MXNet.trace({data: [2, 3]}, params: params) {|data| forward(data) }
+        expect(sym).to be_a(MXNet::Symbol)
+        expect(sym.list_arguments).to eq([:data, :weight, :captured1])
+        expect(params.keys).to eq([:weight, :captured1])
+        expect(params[:captured1]).to equal(bias)
+
+        exe = sym.bind(MXNet.cpu, params.merge(data: x))
+        exe.forward
+        expect(exe.outputs[0].to_a).to eq(forward(x).to_a)
+      end
+
+      specify 'shape and dtype of the proxies' do
+        shapes = []
+        MXNet.trace(data: [2, 3]) do |data|
+          y = data.reshape([3, 2])
+          shapes << data.shape << y.shape << y.dtype
+          y
+        end
+        expect(shapes).to eq([[2, 3], [3, 2], :float32])
+      end
+
+      specify 'multiple outputs' do
+        sym = MXNet.trace(data: [2, 3]) {|data| [data + 1, data * 2] }
+        expect(sym.list_outputs.length).to eq(2)
+        outputs = sym.eval(data: x)
+        expect(outputs.map(&:to_a)).to eq([(x + 1).to_a, (x * 2).to_a])
+      end
+
+      specify 'writing into a proxy' do
+        sym = MXNet.trace(data: [2, 3]) do |data|
+          y = data + 1
+          NDArray.square(y, out: y)
+          y
+        end
+        expect(sym.eval(data: x)[0].to_a).to eq(NDArray.square(x + 1).to_a)
+      end
+
+      specify 'reading the values' do
+        expect {
+          MXNet.trace(data: [2, 3]) {|data| (data + 1).to_a }
+        }.to raise_error(TraceError, /not available/)
+      end
+
+      specify 'using a proxy after tracing' do
+        leaked = nil
+        MXNet.trace(data: [2, 3]) {|data| leaked = data + 1 }
+        expect { leaked + 1 }.to raise_error(TraceError, /after MXNet.trace/)
+      end
+
+      specify 'writing a proxy into a concrete array' do
+        out = NDArray.zeros([2, 3])
+        expect {
+          MXNet.trace(data: [2, 3]) {|data| NDArray.square(data, out: out) }
+        }.to raise_error(TraceError)
+      end
+    end
+  end
+end